@@ -0,0 +1,132 @@
+#!/bin/bash
+
+# Check that Rangeshifter outputs under optional engine settings are equivalent to those
+# of the reference code path (i.e. without the settings)
+#
+# Usage: bash check_equivalence.bash [-n replicates] [-p project] [-a alpha] [-t tolerance]
+#          build_folder "Setting Value" [...]
+# e.g.   bash run_on_gha/check_equivalence.bash build "OutputFormat 1" "OutputShards 1"
+#        bash run_on_gha/check_equivalence.bash -n 20 build "KernelSampler 1"
+#
+# The project (by default rs_test_project) is copied to a temporary folder and run twice,
+# with and without the settings, which are added to its Control file.
+# Without -n, the range, population and occupancy outputs must be identical, as they are
+# for settings which preserve the order of random numbers. With -n, every simulation is
+# run for that no. of replicates, and the outputs are compared statistically
+# (see RangeShifter_compare).
+# Outputs written as shards, in binary format or compressed are first restored to the
+# text files which would otherwise have been written.
+
+usage() {
+	echo "Usage: bash check_equivalence.bash [-n replicates] [-p project] [-a alpha] [-t tolerance] build_folder \"Setting Value\" [...]"
+	exit 1
+}
+
+nreps=0
+project=$(dirname "$0")/rs_test_project
+alpha=0.01
+tol=0.05
+while getopts "n:p:a:t:" opt; do
+	case $opt in
+		n) nreps=$OPTARG ;;
+		p) project=$OPTARG ;;
+		a) alpha=$OPTARG ;;
+		t) tol=$OPTARG ;;
+		*) usage ;;
+	esac
+done
+shift $((OPTIND - 1))
+if [ $# -lt 2 ]; then usage; fi
+build=$(cd "$1" && pwd)
+shift
+
+workdir=$(mktemp -d)
+trap 'rm -rf "$workdir"' EXIT
+
+# Set up the reference and alternative projects
+for run in ref alt; do
+	mkdir -p $workdir/$run/Outputs $workdir/$run/Output_Maps
+	cp -r "$project/Inputs" $workdir/$run/
+done
+printf '%s\n' "$@" > $workdir/settings.txt
+awk -v settings=$workdir/settings.txt '{ print } /^InitialisationFile/ { while ((getline s < settings) > 0) print s }' \
+	"$project/Inputs/CONTROL.txt" > $workdir/alt/Inputs/CONTROL.txt
+
+# Set the no. of replicates of every simulation, and write occupancy outputs
+if [ $nreps -gt 0 ]; then
+	parfile=$(awk '$1 == "ParameterFile" { sub(/\r$/, "", $2); print $2 }' "$project/Inputs/CONTROL.txt")
+	for run in ref alt; do
+		awk -v n=$nreps 'BEGIN { FS = OFS = "\t" }
+			NR == 1 { for (i = 1; i <= NF; i++) { if ($i == "Replicates") r = i; if ($i == "OutIntOcc") o = i } }
+			NR > 1 && NF > 1 { $r = n; if ($o + 0 <= 0) $o = 1 }
+			{ print }' "$project/Inputs/$parfile" > $workdir/$run/Inputs/$parfile
+	done
+fi
+
+for run in ref alt; do
+	if ! "$build/RangeShifter" $workdir/$run/ > $workdir/$run.log 2>&1
+	then
+		echo "RangeShifter failed for the $run run:"
+		tail -20 $workdir/$run.log
+		exit 1
+	fi
+	cd $workdir/$run/Outputs
+	if [ -z "$(ls *_Range* 2> /dev/null)" ]
+	then
+		echo "No outputs from the $run run - see BatchLog.txt:"
+		grep "\*\*\*" BatchLog.txt
+		exit 1
+	fi
+	if [ $run == alt ]
+	then
+		for setting in "$@"; do
+			if ! grep -q "^Engine setting ${setting%%[[:space:]]*} " BatchLog.txt
+			then
+				echo "Setting $setting was not read - see BatchLog.txt"
+				exit 1
+			fi
+		done
+	fi
+	# restore the text files
+	for f in *.gz; do [ -e "$f" ] && gunzip -f "$f"; done
+	for f in *.zst; do [ -e "$f" ] && zstd -q -d --rm "$f"; done
+	for f in *_Shards.txt; do
+		[ -e "$f" ] || continue
+		sed -i -E 's/\.(gz|zst)(\t|$)/\2/g' "$f" # as decompressed
+		"$build/RangeShifter_merge" "$f" > /dev/null
+	done
+	for f in *_Pop.rsb; do
+		case "$f" in *_Rep[0-9]*) continue ;; esac
+		[ -e "$f" ] && "$build/RangeShifter_convert" "$f" > /dev/null
+	done
+	cd - > /dev/null
+done
+
+echo "Settings: $*"
+pairs=()
+for filename in $workdir/ref/Outputs/*_Range.txt $workdir/ref/Outputs/*_Pop.txt $workdir/ref/Outputs/*_Occupancy.txt $workdir/ref/Outputs/*_Occupancy_Stats.txt; do
+	[ -e "$filename" ] || continue
+	case "$filename" in *_Rep[0-9]*) continue ;; esac
+	pairs+=("$filename" "$workdir/alt/Outputs/${filename##*/}")
+done
+if [ ${#pairs[@]} -eq 0 ]; then
+	echo "No range, population or occupancy outputs to compare"
+	exit 1
+fi
+for ((i = 1; i < ${#pairs[@]}; i += 2)); do
+	if [ ! -e "${pairs[$i]}" ]; then
+		echo "${pairs[$i]##*/} was not written under the settings"
+		exit 1
+	fi
+done
+
+if [ $nreps -gt 0 ]
+then
+	"$build/RangeShifter_compare" -stats -reps $nreps -alpha $alpha -tol $tol "${pairs[@]}" | sed "s|$workdir/alt/Outputs/||g; s|$workdir/ref/Outputs/|reference |g"
+else
+	"$build/RangeShifter_compare" "${pairs[@]}" | sed "s|$workdir/alt/Outputs/||g; s|$workdir/ref/Outputs/|reference |g"
+fi
+if [ ${PIPESTATUS[0]} -ne 0 ]
+then
+	exit 1 # check fails
+fi
@@ -0,0 +1,104 @@
+/*----------------------------------------------------------------------------
+ *	
+ *	Copyright (C) 2020 Greta Bocedi, Stephen C.F. Palmer, Justin M.J. Travis, Anne-Kathleen Malchow, Damaris Zurell 
+ *	
+ *	This file is part of RangeShifter.
+ *	
+ *	RangeShifter is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *	
+ *	RangeShifter is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *	GNU General Public License for more details.
+ *	
+ *	You should have received a copy of the GNU General Public License
+ *	along with RangeShifter. If not, see <https://www.gnu.org/licenses/>.
+ *	
+ --------------------------------------------------------------------------*/
+ 
+ 
+//---------------------------------------------------------------------------
+
+#include "BatchInput.h"
+
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+//---------------------------------------------------------------------------
+
+// Batch input files read in the batch, by file name
+static map <string, batchTable> batchTables;
+
+// Build the index of the first record of each simulation
+static void indexTable(batchTable& t) {
+	const char* text = t.text.c_str();
+	size_t len = t.text.size();
+	size_t pos = t.text.find('\n'); // skip the header line
+	int prevsim = -98765;
+	while (pos != string::npos && pos < len) {
+		pos++;
+		size_t start = pos;
+		while (pos < len && (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\r')) pos++;
+		char* end;
+		long sim = strtol(text + pos, &end, 10);
+		if (end != text + pos && (int)sim != prevsim) {
+			if (t.sims.find((int)sim) == t.sims.end()) t.sims[(int)sim] = start;
+			prevsim = (int)sim;
+		}
+		pos = t.text.find('\n', pos);
+	}
+	t.indexed = true;
+}
+
+//---------------------------------------------------------------------------
+
+batchFile::batchFile(void) : std::istream(&buf) {
+	table = 0;
+}
+
+batchFile::~batchFile(void) { }
+
+void batchFile::open(const char* name) {
+	if (table != 0) { setstate(ios::failbit); return; } // as an ifstream which is open
+	map <string, batchTable>::iterator it = batchTables.find(name);
+	if (it == batchTables.end()) {
+		ifstream in(name);
+		if (!in.is_open()) { setstate(ios::failbit); return; }
+		ostringstream contents;
+		contents << in.rdbuf();
+		batchTable& t = batchTables[name];
+		t.text = contents.str();
+		t.indexed = false;
+		it = batchTables.find(name);
+	}
+	table = &it->second;
+	char* text = &table->text[0];
+	buf.set(text, text, text + table->text.size());
+	clear();
+}
+
+void batchFile::close(void) {
+	if (table == 0) { setstate(ios::failbit); return; }
+	table = 0;
+	buf.set(0, 0, 0);
+}
+
+bool batchFile::seekSimulation(const int sim) {
+	if (table == 0) return false;
+	if (!table->indexed) indexTable(*table);
+	map <int, size_t>::iterator it = table->sims.find(sim);
+	if (it == table->sims.end()) return false;
+	char* text = &table->text[0];
+	buf.set(text, text + it->second, text + table->text.size());
+	clear();
+	return true;
+}
+
+void batchFile::clearCache(void) {
+	batchTables.clear();
+}
+
+//---------------------------------------------------------------------------
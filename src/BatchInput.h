@@ -0,0 +1,95 @@
+/*----------------------------------------------------------------------------
+ *	
+ *	Copyright (C) 2020 Greta Bocedi, Stephen C.F. Palmer, Justin M.J. Travis, Anne-Kathleen Malchow, Damaris Zurell 
+ *	
+ *	This file is part of RangeShifter.
+ *	
+ *	RangeShifter is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *	
+ *	RangeShifter is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *	GNU General Public License for more details.
+ *	
+ *	You should have received a copy of the GNU General Public License
+ *	along with RangeShifter. If not, see <https://www.gnu.org/licenses/>.
+ *	
+ --------------------------------------------------------------------------*/
+ 
+ 
+/*------------------------------------------------------------------------------
+
+RangeShifter v2.0 BatchInput
+
+Implements the batchFile class
+
+Holds the batch input files which have a record (or several) for each simulation
+(the ParameterFile, StageStructFile, EmigrationFile, TransferFile,
+SettlementFile, GeneticsFile and InitialisationFile) in memory, so that each is
+read from disk only once in a batch, rather than when it is parsed and again for
+each landscape, and so that the records of any simulation may be found directly.
+
+A batchFile is an input stream, used as the ifstream which it replaces, whose
+contents are read on its first opening into a table shared by every batchFile
+opened for the same file. The table is indexed, when first needed, by the
+position of the first record of each simulation (the simulation number being the
+first value of each record), so that seekSimulation() may position the stream at
+any simulation, whatever the order in which the simulations were read. The tables
+are kept until clearCache() is called at the end of the batch.
+
+For full details of RangeShifter, please see:
+Bocedi G., Palmer S.C.F., Peer G., Heikkinen R.K., Matsinos Y.G., Watts K.
+and Travis J.M.J. (2014). RangeShifter: a platform for modelling spatial
+eco-evolutionary dynamics and species responses to environmental changes.
+Methods in Ecology and Evolution, 5, 388-396. doi: 10.1111/2041-210X.12162
+
+------------------------------------------------------------------------------*/
+
+#ifndef BatchInputH
+#define BatchInputH
+
+#include <istream>
+#include <streambuf>
+#include <string>
+#include <map>
+using namespace std;
+
+// A batch input file held in memory
+struct batchTable {
+	string text;							// contents of the file
+	bool indexed;							// has the index of simulations been built?
+	map <int, size_t> sims;		// position of the first record of each simulation
+};
+
+// A stream buffer reading directly from a batchTable
+class batchBuf : public std::streambuf {
+public:
+	void set(char* begin, char* pos, char* end) { setg(begin, pos, end); }
+};
+
+//---------------------------------------------------------------------------
+
+class batchFile : public std::istream {
+public:
+	batchFile(void);
+	~batchFile(void);
+	void open( // Open a file, reading it into memory unless it has already been read
+		const char*	// file name
+	);
+	bool is_open(void) { return table != 0; }
+	void close(void);
+	bool seekSimulation( // Position the stream at the first record of a simulation
+		const int		// simulation number
+	);
+	static void clearCache(void); // Release the contents of all files
+
+private:
+	batchBuf buf;
+	batchTable* table;
+};
+
+//---------------------------------------------------------------------------
+#endif
@@ -23,15 +23,21 @@
  //---------------------------------------------------------------------------
 
 #include "BatchMode.h"
+#include "Preflight.h"
+#include "BatchInput.h"
+
+#include <set>
 //---------------------------------------------------------------------------
 
 ifstream controlfile;
 // Note - all batch files are prefixed 'b' here for reasons concerned with RS v1.0
-ifstream bParamFile, bLandFile, bDynLandFile;
-ifstream bSpDistFile, bStageStructFile, bTransMatrix;
+// Files with records for each simulation are held in memory (see BatchInput)
+batchFile bParamFile, bStageStructFile;
+batchFile bEmigrationFile, bTransferFile, bSettlementFile, bGeneticsFile, bInitFile;
+ifstream bLandFile, bDynLandFile;
+ifstream bSpDistFile, bTransMatrix;
 ifstream bStageWeightsFile;
-ifstream bEmigrationFile, bTransferFile, bSettlementFile;
-ifstream bGeneticsFile, bArchFile, bInitFile, bInitIndsFile;
+ifstream bArchFile, bInitIndsFile;
 
 ofstream batchlog;
 
@@ -39,9 +45,10 @@ ofstream rsLog; // performance log for recording simulation times, etc.
 
 // NOTE: THE STREAMS USED TO READ THE DATA AT RUN TIME COULD TAKE THE SAME NAMES AS
 // USED DURING PARSING (ABOVE)
-ifstream parameters;
-ifstream ssfile, tmfile, fdfile, ddfile, sdfile;
-ifstream emigFile, transFile, settFile, genFile, archFile, initFile, initIndsFile;
+batchFile parameters, ssfile;
+batchFile emigFile, transFile, settFile, genFile, initFile;
+ifstream tmfile, fdfile, ddfile, sdfile;
+ifstream archFile, initIndsFile;
 ifstream landfile, dynlandfile;
 
 // global variables passed between parsing functions...
@@ -554,6 +561,144 @@ batchfiles ParseControlFile(string ctrlfile, string indir, string outdir)
 	}
 	else controlFormatError = true; // wrong control file format
 
+	// Check optional engine settings, which may follow the input files
+	// the first unrecognised name marks the start of any comment lines
+	simEngine eng = paramsSim->getEngine();
+	int inint;
+	bool engineSetting = !controlFormatError;
+	while (engineSetting) {
+		paramname = "";
+		controlfile >> paramname;
+		if (paramname == "KernelSampler") {
+			inint = -98765;
+			controlfile >> inint;
+			if (inint < 0 || inint > 2) {
+				BatchError(filetype, -999, 2, paramname); b.ok = false;
+			}
+			else eng.kernSampler = inint;
+		}
+		else if (paramname == "OutputBuffer") {
+			inint = -98765;
+			controlfile >> inint;
+			if (inint < 0) {
+				BatchError(filetype, -999, 19, paramname); b.ok = false;
+			}
+			else eng.outBuffer = inint;
+		}
+		else if (paramname == "OutputFlushInterval") {
+			inint = -98765;
+			controlfile >> inint;
+			if (inint < 0) {
+				BatchError(filetype, -999, 19, paramname); b.ok = false;
+			}
+			else eng.outFlush = inint;
+		}
+		else if (paramname == "OutputFormat") {
+			inint = -98765;
+			controlfile >> inint;
+			if (inint < 0 || inint > 1) {
+				BatchError(filetype, -999, 1, paramname); b.ok = false;
+			}
+			else eng.outFormat = inint;
+		}
+		else if (paramname == "OutputShards") {
+			inint = -98765;
+			controlfile >> inint;
+			if (inint < 0 || inint > 1) {
+				BatchError(filetype, -999, 1, paramname); b.ok = false;
+			}
+			else eng.outShards = inint;
+		}
+		else if (paramname == "Profile") {
+			inint = -98765;
+			controlfile >> inint;
+			if (inint < 0 || inint > 1) {
+				BatchError(filetype, -999, 1, paramname); b.ok = false;
+			}
+			else eng.profile = inint;
+		}
+		else if (paramname == "MemoryReport") {
+			inint = -98765;
+			controlfile >> inint;
+			if (inint < 0 || inint > 1) {
+				BatchError(filetype, -999, 1, paramname); b.ok = false;
+			}
+			else eng.memReport = inint;
+		}
+		else if (paramname == "Preflight") {
+			inint = -98765;
+			controlfile >> inint;
+			if (inint < 0 || inint > 2) {
+				BatchError(filetype, -999, 2, paramname); b.ok = false;
+			}
+			else eng.preflight = inint;
+		}
+		else if (paramname == "MemoryLimit") {
+			inint = -98765;
+			controlfile >> inint;
+			if (inint < 0) {
+				BatchError(filetype, -999, 19, paramname); b.ok = false;
+			}
+			else eng.memLimit = inint;
+		}
+		else if (paramname == "StatusInterval") {
+			inint = -98765;
+			controlfile >> inint;
+			if (inint < 0) {
+				BatchError(filetype, -999, 19, paramname); b.ok = false;
+			}
+			else eng.statusInt = inint;
+		}
+		else if (paramname == "DispersalStats") {
+			inint = -98765;
+			controlfile >> inint;
+			if (inint < 0) {
+				BatchError(filetype, -999, 19, paramname); b.ok = false;
+			}
+			else eng.dispStats = inint;
+		}
+		else if (paramname == "Threads") {
+			inint = -98765;
+			controlfile >> inint;
+			if (inint < 0) {
+				BatchError(filetype, -999, 19, paramname); b.ok = false;
+			}
+			else eng.threads = inint;
+		}
+		else if (paramname.substr(0, 8) == "Compress") {
+			short* codec = 0;
+			if (paramname == "CompressPop") codec = &eng.compPop;
+			if (paramname == "CompressInds") codec = &eng.compInds;
+			if (paramname == "CompressGenetics") codec = &eng.compGenetics;
+			if (paramname == "CompressRange") codec = &eng.compRange;
+			if (paramname == "CompressConnect") codec = &eng.compConnect;
+			if (paramname == "CompressTraits") codec = &eng.compTraits;
+			if (codec == 0) engineSetting = false;
+			else {
+				inint = -98765;
+				controlfile >> inint;
+				if (inint < 0 || inint > 2) {
+					BatchError(filetype, -999, 2, paramname); b.ok = false;
+				}
+				else {
+					if (outFile::codecAvailable(inint)) *codec = inint;
+					else {
+						BatchError(filetype, -999, 0, paramname);
+						batchlog << paramname << " " << inint
+							<< " is not available, as RangeShifter was built without "
+							<< (inint == 1 ? "zlib" : "zstd") << endl;
+						b.ok = false;
+					}
+				}
+			}
+		}
+		else engineSetting = false;
+		if (engineSetting) {
+			batchlog << endl << "Engine setting " << paramname << " " << inint << endl;
+		}
+	}
+	paramsSim->setEngine(eng);
+
 	if (controlFormatError) {
 		CtrlFormatError();
 		b.ok = false;
@@ -663,8 +808,11 @@ int ParseParameterFile(void)
 		prevsimul = firstsimul = inint; nSimuls++;
 	}
 	while (inint != -98765) {
+		preflightSim ps;
+		ps.simul = prevsimul; ps.outputs = 0;
 		bParamFile >> replicates; if (replicates <= 0) { BatchError(filetype, line, 11, "Replicates"); errors++; }
 		bParamFile >> years; if (years <= 0) { BatchError(filetype, line, 11, "Years"); errors++; }
+		ps.reps = replicates; ps.years = years;
 		bParamFile >> absorb;
 		if (absorb < 0 || absorb > 1) { BatchError(filetype, line, 1, "Absorbing"); errors++; }
 		bParamFile >> gradient;
@@ -788,6 +936,7 @@ int ParseParameterFile(void)
 		sum_K = 0.0; min_K = 9999999.0; max_K = 0.0;
 		for (i = 0; i < maxNhab; i++) {
 			bParamFile >> infloat;
+			ps.K.push_back(infloat);
 			if (infloat < 0.0) {
 				Kheader = "K" + Int2Str(i + 1);
 				BatchError(filetype, line, 19, Kheader); errors++;
@@ -827,7 +976,9 @@ int ParseParameterFile(void)
 		if (inint < 0) { BatchError(filetype, line, 19, "OutStartConn"); errors++; }
 		bParamFile >> inint;
 		if (inint < 0) { BatchError(filetype, line, 19, "OutIntRange"); errors++; }
+		if (inint > 0) ps.outputs++;
 		bParamFile >> inint;
+		if (inint > 0) ps.outputs += 2; // occupancy and its statistics
 		if (inint < 0) { BatchError(filetype, line, 19, "OutIntOcc"); errors++; }
 		else {
 			if (landtype == 9) {
@@ -845,19 +996,26 @@ int ParseParameterFile(void)
 		}
 		bParamFile >> inint;
 		if (inint < 0) { BatchError(filetype, line, 19, "OutIntPop"); errors++; }
+		if (inint > 0) ps.outputs++;
 		bParamFile >> inint;
 		if (inint < 0) { BatchError(filetype, line, 19, "OutIntInd"); errors++; }
+		if (inint > 0) ps.outputs++;
 		bParamFile >> inint;
 		if (inint < 0) { BatchError(filetype, line, 19, "OutIntGenetic"); errors++; }
+		if (inint > 0) ps.outputs++;
 		bParamFile >> inint;
 		if (inint < 0 || inint > 2) { BatchError(filetype, line, 2, "OutGenType"); errors++; }
 		bParamFile >> inint;
-		if (inint < 0 || inint > 1) { BatchError(filetype, line, 1, "OutGenCrossTab"); errors++; }
+		if (inint < 0 || inint > 3) { BatchError(filetype, line, 3, "OutGenCrossTab"); errors++; }
 		bParamFile >> inint;
 		if (inint < 0) { BatchError(filetype, line, 19, "OutIntTraitCell"); errors++; }
+		if (inint > 0) ps.outputs++;
 		bParamFile >> inint;
 		if (inint < 0) { BatchError(filetype, line, 19, "OutIntTraitRow"); errors++; }
+		if (inint > 0) ps.outputs++;
 		bParamFile >> inint;
+		ps.connect = (patchmodel == 1 && inint > 0);
+		if (ps.connect) ps.outputs++;
 		if (inint < 0) { BatchError(filetype, line, 19, "OutIntConn"); errors++; }
 		else {
 			if (patchmodel != 1 && inint > 0) {
@@ -882,6 +1040,7 @@ int ParseParameterFile(void)
 			BatchError(filetype, line, 1, "DrawLoadedSp");
 			errors++;
 		}
+		preflight.addSimulation(ps);
 		line++;
 		// read next simulation number
 		inint = -98765;
@@ -938,6 +1097,9 @@ int ParseLandFile(int landtype, string indir)
 		inint = -98765;
 		bLandFile >> inint;
 		while (inint != -98765) {
+			preflightLand pl;
+			pl.landNum = inint; pl.costs = pl.dynamic = pl.continuous = false;
+			pl.minHab = pl.maxHab = pl.pSuit = 0.0;
 			if (inint < 1) {
 				BatchError(filetype, line, 11, "LandNum"); errors++;
 			}
@@ -967,6 +1129,7 @@ int ParseLandFile(int landtype, string indir)
 			bLandFile >> intext;
 			fname = indir + intext;
 			landraster = CheckRasterFile(fname);
+			pl.landFile = fname; pl.ncols = landraster.ncols; pl.nrows = landraster.nrows;
 			if (landraster.ok) {
 				if (landraster.cellsize == resolution)
 					batchlog << ftype << " headers OK: " << fname << endl;
@@ -997,6 +1160,7 @@ int ParseLandFile(int landtype, string indir)
 				if (patchmodel) {
 					fname = indir + intext;
 					patchraster = CheckRasterFile(fname);
+					pl.patchFile = fname;
 					if (patchraster.ok) {
 						if (patchraster.cellsize == resolution) {
 							if (patchraster.ncols == landraster.ncols
@@ -1043,6 +1207,7 @@ int ParseLandFile(int landtype, string indir)
 				if (transfer == 1) { // SMS
 					fname = indir + name_costfile;
 					costraster = CheckRasterFile(fname);
+					pl.costs = true;
 					if (costraster.ok) {
 						if (costraster.cellsize == resolution) {
 							if (costraster.ncols == landraster.ncols
@@ -1082,6 +1247,7 @@ int ParseLandFile(int landtype, string indir)
 			ftype = "DynLandFile";
 			bLandFile >> intext;
 			if (intext != "NULL") { // landscape is dynamic
+				pl.dynamic = true;
 				fname = indir + intext;
 				batchlog << "Checking " << ftype << " " << fname << endl;
 				bDynLandFile.open(fname.c_str());
@@ -1164,6 +1330,7 @@ int ParseLandFile(int landtype, string indir)
 				}
 			}
 
+			if (landraster.ok) preflight.addLandscape(pl);
 			totlines++; line++;
 			// read first field on next line
 			inint = -98765;
@@ -1201,6 +1368,8 @@ int ParseLandFile(int landtype, string indir)
 					}
 				}
 				landlist.push_back(inint);
+				preflightLand pl;
+				pl.landNum = inint; pl.costs = pl.dynamic = false;
 				bLandFile >> fractal;
 				if (fractal < 0 || fractal > 1) {
 					BatchError(filetype, line, 1, "Fractal"); errors++;
@@ -1210,6 +1379,7 @@ int ParseLandFile(int landtype, string indir)
 					BatchError(filetype, line, 1, "Type"); errors++;
 				}
 				bLandFile >> Xdim >> Ydim;
+				pl.ncols = Xdim; pl.nrows = Ydim;
 				if (fractal == 1) {
 					if (Xdim < 3) {
 						BatchError(filetype, line, 13, "Xdim"); errors++;
@@ -1238,6 +1408,7 @@ int ParseLandFile(int landtype, string indir)
 					}
 				}
 				bLandFile >> minhab >> maxhab;
+				pl.continuous = (type == 1); pl.minHab = minhab; pl.maxHab = maxhab;
 				if (type == 1) { // continuous landscape
 					if (minhab <= 0.0 || minhab >= 100.0) {
 						BatchError(filetype, line, 100, "MinHab"); errors++;
@@ -1254,12 +1425,14 @@ int ParseLandFile(int landtype, string indir)
 				if (infloat < 0.0 || infloat > 1.0) {
 					BatchError(filetype, line, 20, "Psuit"); errors++;
 				}
+				pl.pSuit = infloat;
 				bLandFile >> infloat;
 				if (fractal == 1) {
 					if (infloat <= 0.0 || infloat >= 1.0) {
 						BatchError(filetype, line, 20, "H"); errors++;
 					}
 				}
+				preflight.addLandscape(pl);
 				totlines++; line++;
 				// read first field on next line
 				inint = -98765;
@@ -1475,13 +1648,13 @@ int ParseDynamicFile(string indir, string costfile) {
 int ParseStageFile(string indir)
 {
 	string header, filename, fname, ftype2;
-	int inint, i, err, fecdensdep, fecstagewts, devdensdep, devstagewts, survdensdep, survstagewts;
+	int inint, err, fecdensdep, fecstagewts, devdensdep, devstagewts, survdensdep, survstagewts;
 	float infloat;
 	int errors = 0;
 	int simuls = 0;
 	int prevsimul;
 	bool checkfile;
-	vector <string> transfiles, wtsfiles;
+	set <string> transfiles, wtsfiles;
 	string filetype = "StageStructFile";
 
 	// Parse header line;
@@ -1532,11 +1705,7 @@ int ParseStageFile(string indir)
 		// transition matrix file - compulsory
 		ftype2 = "TransMatrixFile";
 		checkfile = true;
-		for (i = 0; i < (int)transfiles.size(); i++) {
-			if (filename == transfiles[i]) { // file has already been checked
-				checkfile = false;
-			}
-		}
+		if (transfiles.count(filename)) checkfile = false; // file has already been checked
 		if (checkfile) {
 			if (filename == "NULL") {
 				batchlog << "*** " << ftype2 << " is compulsory for stage-structured model" << endl;
@@ -1558,7 +1727,7 @@ int ParseStageFile(string indir)
 				bTransMatrix.clear();
 			}
 		}
-		transfiles.push_back(filename);
+		transfiles.insert(filename);
 
 		bStageStructFile >> inint;
 		if (inint < 0 || inint > 2) { BatchError(filetype, line, 2, "SurvSched"); errors++; }
@@ -1594,9 +1763,7 @@ int ParseStageFile(string indir)
 		}
 		else {
 			checkfile = true;
-			for (i = 0; i < (int)wtsfiles.size(); i++) {
-				if (filename == wtsfiles[i]) checkfile = false; // file has already been checked
-			}
+			if (wtsfiles.count(filename)) checkfile = false; // file has already been checked
 			if (checkfile) {
 				fname = indir + filename;
 				batchlog << "Checking " << ftype2 << " " << fname << endl;
@@ -1612,7 +1779,7 @@ int ParseStageFile(string indir)
 				if (bStageWeightsFile.is_open()) bStageWeightsFile.close();
 				bStageWeightsFile.clear();
 			}
-			wtsfiles.push_back(filename);
+			wtsfiles.insert(filename);
 		}
 
 		bStageStructFile >> devdensdep;
@@ -1649,9 +1816,7 @@ int ParseStageFile(string indir)
 		}
 		else {
 			checkfile = true;
-			for (i = 0; i < (int)wtsfiles.size(); i++) {
-				if (filename == wtsfiles[i]) checkfile = false; // file has already been checked
-			}
+			if (wtsfiles.count(filename)) checkfile = false; // file has already been checked
 			if (checkfile) {
 				fname = indir + filename;
 				batchlog << "Checking " << ftype2 << " " << fname << endl;
@@ -1667,7 +1832,7 @@ int ParseStageFile(string indir)
 				if (bStageWeightsFile.is_open()) bStageWeightsFile.close();
 				bStageWeightsFile.clear();
 			}
-			wtsfiles.push_back(filename);
+			wtsfiles.insert(filename);
 		}
 
 		bStageStructFile >> survdensdep;
@@ -1704,9 +1869,7 @@ int ParseStageFile(string indir)
 		}
 		else {
 			checkfile = true;
-			for (i = 0; i < (int)wtsfiles.size(); i++) {
-				if (filename == wtsfiles[i]) checkfile = false; // file has already been checked
-			}
+			if (wtsfiles.count(filename)) checkfile = false; // file has already been checked
 			if (checkfile) {
 				fname = indir + filename;
 				batchlog << "Checking " << ftype2 << " " << fname << endl;
@@ -1722,7 +1885,7 @@ int ParseStageFile(string indir)
 				if (bStageWeightsFile.is_open()) bStageWeightsFile.close();
 				bStageWeightsFile.clear();
 			}
-			wtsfiles.push_back(filename);
+			wtsfiles.insert(filename);
 		}
 
 		// read next simulation
@@ -1992,6 +2155,7 @@ int ParseEmigFile(void)
 		if (current.newsimul) simuls++;
 		errors += current.errors;
 		prev = current;
+		if (indvar == 1) preflight.addIndVar(simul, filetype, sexdep);
 		// validate density dependency
 		if (densdep < 0 || densdep > 1) {
 			BatchError(filetype, line, 1, "DensDep"); errors++;
@@ -2297,6 +2461,7 @@ int ParseTransferFile(string indir)
 			if (current.newsimul) simuls++;
 			errors += current.errors;
 			prev = current;
+			if (indvar == 1) preflight.addIndVar(simul, filetype, sexdep);
 			// validate kernel type
 			if (kerneltype < 0 || kerneltype > 1) {
 				BatchError(filetype, line, 1, "KernelType"); errors++;
@@ -2404,6 +2569,7 @@ int ParseTransferFile(string indir)
 			if (current.newsimul) simuls++;
 			errors += current.errors;
 			prev = current;
+			if (indvar == 1) preflight.addIndVar(simul, filetype, 0);
 			// validate SMS movement parameters
 			if (pr < 1) {
 				BatchError(filetype, line, 11, "PR"); errors++;
@@ -2570,6 +2736,7 @@ int ParseTransferFile(string indir)
 			if (current.newsimul) simuls++;
 			errors += current.errors;
 			prev = current;
+			if (indvar == 1) preflight.addIndVar(simul, filetype, 0);
 
 			if (indvar) { // individual variability
 				if (StepLMean <= 0.0) {
@@ -2756,6 +2923,7 @@ int ParseSettleFile(void)
 			if (current.newsimul) simuls++;
 			errors += current.errors;
 			prev = current;
+			if (indvar == 1) preflight.addIndVar(simul, filetype, sexdep);
 			if (densdep < 0 || densdep > 1) {
 				BatchError(filetype, line, 1, "DensDep"); errors++;
 			}
@@ -2863,14 +3031,14 @@ int ParseSettleFile(void)
 int ParseGeneticsFile(string indir)
 {
 	string header, colheader;
-	int i, simul, err;
+	int simul, err;
 	int arch, nLoci;
 	string filename, ftype, fname;
 	float probMutn, probCross, alleleSD, mutationSD;
 	bool checkfile;
 	int errors = 0;
 	int simuls = 0;
-	vector <string> archfiles;
+	set <string> archfiles;
 	string filetype = "GeneticsFile";
 
 	// Parse header line;
@@ -2932,9 +3100,7 @@ int ParseGeneticsFile(string indir)
 			}
 			else { // check architecture file
 				checkfile = true;
-				for (i = 0; i < (int)archfiles.size(); i++) {
-					if (filename == archfiles[i]) checkfile = false; // file has already been checked
-				}
+				if (archfiles.count(filename)) checkfile = false; // file has already been checked
 				if (checkfile) {
 					fname = indir + filename;
 					batchlog << "Checking " << ftype << " " << fname << endl;
@@ -2950,7 +3116,7 @@ int ParseGeneticsFile(string indir)
 					if (bArchFile.is_open()) bArchFile.close();
 					bArchFile.clear();
 				}
-				archfiles.push_back(filename);
+				archfiles.insert(filename);
 			}
 		}
 
@@ -2971,6 +3137,7 @@ int ParseGeneticsFile(string indir)
 		if (mutationSD <= 0.0) {
 			BatchError(filetype, line, 10, "MutationSD"); errors++;
 		}
+		preflight.addGenetics(simul, arch, nLoci, filename);
 
 		// read next simulation
 		line++;
@@ -3023,10 +3190,11 @@ int ParseArchFile(void)
 	bArchFile >> paramname;
 	if (paramname != "NLoci") formatError = true;
 	int locerrors = 0;
+	int totloci = 0;
 	for (int i = 0; i < nchromosomes; i++) {
 		nloci = -999;
 		bArchFile >> nloci;
-		if (nloci < 1) locerrors++; else chromsize[i] = nloci;
+		if (nloci < 1) locerrors++; else { chromsize[i] = nloci; totloci += nloci; }
 	}
 	if (locerrors) {
 		BatchError(filetype, -999, 11, "NLoci");
@@ -3098,6 +3266,7 @@ int ParseArchFile(void)
 
 	if (chromsize != 0) delete[] chromsize;
 
+	if (errors == 0) preflight.setArchitecture(nchromosomes, totloci);
 	return errors;
 
 }
@@ -3156,7 +3325,7 @@ int ParseInitFile(string indir)
 	simCheck current, prev;
 	bool checkfile;
 	string filename, ftype2, fname;
-	vector <string> indsfiles;
+	set <string> indsfiles;
 	ftype2 = "InitIndsFile";
 	simul = -98765;
 	prev.simul = -999;
@@ -3272,11 +3441,7 @@ int ParseInitFile(string indir)
 		else {
 			if (seedtype == 2) {
 				checkfile = true;
-				for (i = 0; i < (int)indsfiles.size(); i++) {
-					if (filename == indsfiles[i]) { // file has already been checked
-						checkfile = false;
-					}
-				}
+				if (indsfiles.count(filename)) checkfile = false; // file has already been checked
 				if (checkfile) {
 					fname = indir + filename;
 					batchlog << "Checking " << ftype2 << " " << fname << endl;
@@ -3291,7 +3456,7 @@ int ParseInitFile(string indir)
 					}
 					if (bInitIndsFile.is_open()) bInitIndsFile.close();
 					bInitIndsFile.clear();
-					indsfiles.push_back(filename);
+					indsfiles.insert(filename);
 				}
 			}
 			else {
@@ -4084,6 +4249,7 @@ int ReadParameters(int option, Landscape* pLandscape)
 	if (sim.outIntInd > 0)       sim.outInds = true; else sim.outInds = false;
 	if (sim.outIntGenetic > 0)   sim.outGenetics = true; else sim.outGenetics = false;
 	if (jjjj == 1)   						 sim.outGenXtab = true; else sim.outGenXtab = false;
+	sim.outGenForm = jjjj;
 	if (sim.outIntRange > 0)     sim.outRange = true; else sim.outRange = false;
 	if (sim.outIntTraitCell > 0) sim.outTraitsCells = true; else sim.outTraitsCells = false;
 	if (sim.outIntTraitRow > 0)  sim.outTraitsRows = true; else sim.outTraitsRows = false;
@@ -5641,9 +5807,14 @@ void RunBatch(int nSimuls, int nLandscapes)
 #endif
 	rsLog << "RANDOM SEED," << RS_random_seed << ",,," << endl;
 
+	simEngine eng = paramsSim->getEngine();
+	runStatus.start(paramsSim->getDir(2) + "Batch" + Int2Str(sim.batchNum) + "_Status.json",
+		eng.statusInt, sim.batchNum, nSimuls, nLandscapes);
+
 	// Open landscape batch file and read header record
 	if (ReadLandFile(0)) {
 		cout << endl << "Error opening landFile - aborting batch run" << endl;
+		runStatus.finish(false);
 		return;
 	}
 
@@ -5664,6 +5835,7 @@ void RunBatch(int nSimuls, int nLandscapes)
 			cout << endl << msg << endl;
 			MemoLine(msg.c_str());
 			ReadLandFile(9); // close the landscape file
+			runStatus.finish(false);
 			return;
 		}
 
@@ -5783,6 +5955,7 @@ void RunBatch(int nSimuls, int nLandscapes)
 			// Open all other batch files and read header records
 			if (ReadParameters(0, pLandscape)) {
 				cout << endl << "Error opening ParameterFile - aborting batch run" << endl;
+				runStatus.finish(false);
 				return;
 			}
 			if (stagestruct) {
@@ -5808,6 +5981,14 @@ void RunBatch(int nSimuls, int nLandscapes)
 					rsLog << msgsim << sim.simulation << msgerr << read_error << msgabt << endl;
 					params_ok = false;
 				}
+				// read the records of the same simulation from the other files
+				// (if it is not found, they are read in sequence)
+				if (stagestruct) ssfile.seekSimulation(sim.simulation);
+				emigFile.seekSimulation(sim.simulation);
+				transFile.seekSimulation(sim.simulation);
+				settFile.seekSimulation(sim.simulation);
+				if (geneticsFile != "NULL") genFile.seekSimulation(sim.simulation);
+				initFile.seekSimulation(sim.simulation);
 				if (stagestruct) {
 					ReadStageStructure(1);
 				}
@@ -5874,11 +6055,19 @@ void RunBatch(int nSimuls, int nLandscapes)
 					// for batch processing, include landscape number in parameter file name
 					OutParameters(pLandscape);
 
+					runStatus.startSim(i, j, sim.simulation, land_nr, sim.reps, sim.years);
 					RunModel(pLandscape, i);
 
 					t01 = (int)time(0);
 					rsLog << msgsim << sim.simulation << "," << sim.reps
 						<< "," << sim.years << "," << t01 - t00 << endl;
+					int write_errors = outFile::writeErrors();
+					if (write_errors > 0) {
+						cout << endl << "***** Error: " << write_errors
+							<< " output file(s) of simulation " << sim.simulation
+							<< " not written in full" << endl;
+						rsLog << msgsim << sim.simulation << ",ERROR,OUTPUT FILES NOT WRITTEN IN FULL," << endl;
+					}
 				} // end of if (params_ok)
 				else {
 					cout << endl << "Error in reading parameter file(s)" << endl;
@@ -5904,6 +6093,8 @@ void RunBatch(int nSimuls, int nLandscapes)
 	} // end of nLandscapes loop
 
 	ReadLandFile(9); // close the landFile
+	batchFile::clearCache();
+	runStatus.finish(true);
 
 	// Write performance data to log file
 	t1 = (int)time(0);
@@ -50,6 +50,7 @@ using namespace std;
 #include "./RScore/Species.h"
 #include "./RScore/SubCommunity.h"
 #include "./BatchMode.h"
+#include "./Preflight.h"
 
 #if RANDOMCHECK
 #include "./RScore/RandomCheck.h"
@@ -247,6 +248,8 @@ if (b.ok) {
 	sim.batchMode = true;
 	sim.batchNum = b.batchNum;  
 	paramsSim->setSim(sim);
+	// estimate the resources needed, and refuse a batch which would not fit
+	if (!preflight.estimate(b, outdir)) b.ok = false;
 }
 else {
 	cout << endl << "Error in parsing batch input files - see BatchLog file for details" << endl;
@@ -0,0 +1,351 @@
+/*----------------------------------------------------------------------------
+ *	
+ *	Copyright (C) 2020 Greta Bocedi, Stephen C.F. Palmer, Justin M.J. Travis, Anne-Kathleen Malchow, Damaris Zurell 
+ *	
+ *	This file is part of RangeShifter.
+ *	
+ *	RangeShifter is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *	
+ *	RangeShifter is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *	GNU General Public License for more details.
+ *	
+ *	You should have received a copy of the GNU General Public License
+ *	along with RangeShifter. If not, see <https://www.gnu.org/licenses/>.
+ *	
+ --------------------------------------------------------------------------*/
+ 
+ 
+//---------------------------------------------------------------------------
+
+#include "Preflight.h"
+#include "BatchMode.h"
+
+#include <set>
+#include <sstream>
+#include <iomanip>
+#include <iostream>
+#if LINUX_CLUSTER
+#include <unistd.h>
+#endif
+//---------------------------------------------------------------------------
+
+Preflight preflight;
+
+// Costs of the model (ns), calibrated from the profiles of the test scenarios
+static const double costDemog = 1500.0;		// reproduction, emigration and survival, per individual per year
+static const double costKernel = 1500.0;	// transfer by dispersal kernel, per individual per year
+static const double costSMS = 100000.0;		// transfer by SMS, per individual per year
+static const double costCRW = 40000.0;		// transfer by CRW, per individual per year
+static const double costLocus = 20.0;			// inheritance, per locus per individual per year
+static const double costCell = 4000.0;		// setting up the landscape, per cell per replicate
+
+// Proportion of the memory available above which a warning is given
+static const double memWarning = 0.8;
+
+static double megabytes(const long long bytes) { return (double)bytes / (1024.0 * 1024.0); }
+
+//---------------------------------------------------------------------------
+
+Preflight::Preflight(void) {
+	lastArch.chromosomes = lastArch.loci = 0;
+	dataCells = nPatches = inPatches = qualCells = 0;
+	quality = patchQuality = 0.0;
+}
+
+Preflight::~Preflight(void) { }
+
+void Preflight::addLandscape(preflightLand l) {
+	lands.push_back(l);
+}
+
+void Preflight::addSimulation(preflightSim s) {
+	s.emigVar = s.trfrVar = s.settVar = 0;
+	s.arch = -1; s.nLoci = 1; // default genetics, unless set from the GeneticsFile
+	sims.push_back(s);
+}
+
+// Simulations are numbered sequentially in every file, so a simulation is found
+// from its offset from the first
+void Preflight::addIndVar(const int simul, const string filetype, const int sexdep) {
+	if (sims.size() == 0) return;
+	int i = simul - sims[0].simul;
+	if (i < 0 || i >= (int)sims.size() || sims[i].simul != simul) return;
+	short v = sexdep ? 2 : 1;
+	if (filetype == "EmigrationFile" && v > sims[i].emigVar) sims[i].emigVar = v;
+	if (filetype == "TransferFile" && v > sims[i].trfrVar) sims[i].trfrVar = v;
+	if (filetype == "SettlementFile" && v > sims[i].settVar) sims[i].settVar = v;
+}
+
+void Preflight::setArchitecture(const int nchromosomes, const int nloci) {
+	lastArch.chromosomes = nchromosomes; lastArch.loci = nloci;
+}
+
+// An architecture file is parsed only the first time it is named, immediately before
+// the line naming it is described
+void Preflight::addGenetics(const int simul, const int arch, const int nloci,
+	const string archfile)
+{
+	if (arch == 1 && archs.find(archfile) == archs.end()) archs[archfile] = lastArch;
+	if (sims.size() == 0) return;
+	int i = simul - sims[0].simul;
+	if (i < 0 || i >= (int)sims.size() || sims[i].simul != simul) return;
+	sims[i].arch = arch; sims[i].nLoci = nloci; sims[i].archFile = archfile;
+}
+
+//---------------------------------------------------------------------------
+
+// Read the habitat raster (and patch raster) of a real landscape
+void Preflight::scanLandscape(preflightLand& l, batchfiles& b) {
+	dataCells = nPatches = inPatches = qualCells = 0;
+	quality = patchQuality = 0.0;
+	habCells.clear(); patchCells.clear();
+	if (b.landtype == 9) return; // artificial landscape
+
+	string header;
+	double nodata, patchnodata, dummy;
+	ifstream landras, patchras;
+	landras.open(l.landFile.c_str());
+	if (!landras.is_open()) return;
+	for (int i = 0; i < 5; i++) landras >> header >> dummy;
+	landras >> header >> nodata;
+	bool patches = (b.patchmodel && l.patchFile != "");
+	if (patches) {
+		patchras.open(l.patchFile.c_str());
+		if (patchras.is_open()) {
+			for (int i = 0; i < 5; i++) patchras >> header >> dummy;
+			patchras >> header >> patchnodata;
+		}
+		else patches = false;
+	}
+
+	map <int, long long> codes, patchcodes;
+	set <int> patchnums;
+	double h, p = 0.0;
+	long long ncells = (long long)l.ncols * (long long)l.nrows;
+	for (long long i = 0; i < ncells; i++) {
+		if (!(landras >> h)) break;
+		if (patches && !(patchras >> p)) patches = false;
+		if (h == nodata) continue;
+		dataCells++;
+		bool inpatch = (patches && p > 0.0 && p != patchnodata);
+		if (inpatch) { patchnums.insert((int)p); inPatches++; }
+		if (b.landtype == 0) { // habitat codes
+			codes[(int)h]++;
+			if (inpatch) patchcodes[(int)h]++;
+		}
+		else { // habitat quality
+			quality += h;
+			if (h > 0.0) qualCells++;
+			if (inpatch) patchQuality += h;
+		}
+	}
+	// habitats are indexed in order of their codes, as in the Landscape
+	for (map <int, long long>::iterator it = codes.begin(); it != codes.end(); ++it) {
+		habCells.push_back(it->second);
+		patchCells.push_back(patchcodes[it->first]);
+	}
+	nPatches = (long long)patchnums.size();
+	landras.close();
+	if (patchras.is_open()) patchras.close();
+}
+
+preflightEstimate Preflight::estimateSim(preflightLand& l, preflightSim& s,
+	batchfiles& b)
+{
+	preflightEstimate e;
+	clearMemory(e.mem);
+	simEngine eng = paramsSim->getEngine();
+	double cellha = (double)b.resolution * (double)b.resolution / 10000.0;
+	float k0 = s.K.size() > 0 ? s.K[0] : 0.0f;
+
+	// cells, suitable cells and individuals at carrying capacity
+	long long cells, suitable;
+	if (b.landtype == 9) { // artificial landscape
+		cells = (long long)l.ncols * (long long)l.nrows;
+		double habitat = l.pSuit * (double)cells;
+		double q = l.continuous ? (l.minHab + l.maxHab) / 200.0 : 1.0;
+		suitable = (long long)habitat;
+		e.inds = habitat * q * k0 * cellha;
+	}
+	else {
+		cells = dataCells;
+		if (b.landtype == 0) { // habitat codes
+			suitable = 0; e.inds = 0.0;
+			for (int i = 0; i < (int)habCells.size(); i++) {
+				float k = i < (int)s.K.size() ? s.K[i] : 0.0f;
+				if (k <= 0.0) continue;
+				suitable += habCells[i];
+				e.inds += (double)(b.patchmodel ? patchCells[i] : habCells[i]) * k * cellha;
+			}
+		}
+		else { // habitat quality
+			suitable = qualCells;
+			e.inds = (b.patchmodel ? patchQuality : quality) / 100.0 * k0 * cellha;
+		}
+	}
+	// every cell of a cell-based model which is suitable is a patch
+	long long npatches = (b.patchmodel ? nPatches : suitable) + 1;
+	long long peak = (long long)(2.0 * e.inds);
+
+	// traits and genome
+	int traits = 0;
+	if (s.emigVar) traits += 3 * s.emigVar;
+	if (s.trfrVar) traits += (b.transfer == 1 ? 4 : (b.transfer == 2 ? 2 : 3)) * s.trfrVar;
+	if (s.settVar) traits += 3 * s.settVar;
+	long long chromosomes = 0, loci = 0;
+	if (traits > 0) {
+		if (s.arch == 1 && archs.find(s.archFile) != archs.end()) {
+			chromosomes = archs[s.archFile].chromosomes; loci = archs[s.archFile].loci;
+		}
+		else { chromosomes = traits; loci = (long long)traits * s.nLoci; }
+	}
+
+	// SMS effective costs are held only for cells which have been visited, so are omitted
+	long long b0;
+	e.mem.objects[MEMCELLS] = cells;
+	b0 = sizeof(Cell) + sizeof(short) + sizeof(float);
+	if (b.transfer == 1) b0 += sizeof(smscosts);
+	e.mem.bytes[MEMCELLS] = (long long)l.nrows * (sizeof(Cell**) + (long long)l.ncols * sizeof(Cell*))
+		+ cells * b0;
+	e.mem.objects[MEMPATCHES] = npatches;
+	// in a cell-based model, the matrix patch holds all unsuitable cells
+	e.mem.bytes[MEMPATCHES] = npatches * (sizeof(Patch) + sizeof(Patch*) + sizeof(int)
+		+ sizeof(patchPopn)) + (b.patchmodel ? inPatches : cells) * sizeof(Cell*);
+	e.mem.objects[MEMPOPNS] = 2 * (npatches - 1);
+	e.mem.bytes[MEMPOPNS] = (npatches - 1) * (sizeof(SubCommunity) + sizeof(Population))
+		+ peak * sizeof(Individual*);
+	e.mem.objects[MEMINDS] = peak;
+	b0 = sizeof(Individual);
+	if (s.emigVar) b0 += sizeof(emigTraits);
+	if (s.trfrVar && b.transfer == 0) b0 += sizeof(trfrKernTraits);
+	if (s.settVar) b0 += sizeof(settleTraits);
+	if (b.transfer > 0) b0 += sizeof(pathData) + (b.transfer == 1 ? sizeof(smsdata) : sizeof(crwParams));
+	e.mem.bytes[MEMINDS] = peak * b0;
+	if (chromosomes > 0) {
+		e.mem.objects[MEMGENOMES] = peak * (1 + chromosomes);
+		e.mem.bytes[MEMGENOMES] = peak * (sizeof(Genome)
+			+ chromosomes * (sizeof(Chromosome*) + sizeof(Chromosome)) + loci * sizeof(locus));
+	}
+	if (s.connect) {
+		e.mem.objects[MEMMATRICES]++;
+		e.mem.bytes[MEMMATRICES] += npatches * (sizeof(int*) + npatches * sizeof(int));
+	}
+	if (l.dynamic) { // patch and cost change matrices
+		long long chgbytes = (long long)l.nrows * (sizeof(int**)
+			+ (long long)l.ncols * (sizeof(int*) + 3 * sizeof(int)));
+		int nchg = (b.patchmodel ? 1 : 0) + (l.costs ? 1 : 0);
+		e.mem.objects[MEMMATRICES] += nchg;
+		e.mem.bytes[MEMMATRICES] += nchg * chgbytes;
+	}
+	e.mem.objects[MEMOUTPUT] = s.outputs;
+	e.mem.bytes[MEMOUTPUT] = (long long)s.outputs * eng.outBuffer * 1024;
+	e.total = 0;
+	for (int i = 0; i < NMEMSUBSYSTEMS; i++) e.total += e.mem.bytes[i];
+
+	// time
+	double cost = costDemog + (double)loci * costLocus;
+	if (b.transfer == 0) cost += costKernel;
+	if (b.transfer == 1) cost += costSMS;
+	if (b.transfer == 2) cost += costCRW;
+	e.yearSecs = e.inds * cost * 1.0e-9;
+	e.simSecs = (double)s.reps * ((double)s.years * e.yearSecs + (double)cells * costCell * 1.0e-9);
+
+	return e;
+}
+
+// Memory available to the batch: the MemoryLimit setting, or else the smaller of the
+// physical memory and any limit of the control group (e.g. as set by a job scheduler)
+long long Preflight::memoryLimit(void) {
+	simEngine eng = paramsSim->getEngine();
+	if (eng.memLimit > 0) return (long long)eng.memLimit * 1024 * 1024;
+	long long limit = 0;
+#if LINUX_CLUSTER
+	long pages = sysconf(_SC_PHYS_PAGES);
+	long pagesize = sysconf(_SC_PAGE_SIZE);
+	if (pages > 0 && pagesize > 0) limit = (long long)pages * pagesize;
+	const char* cgroups[2] = {
+		"/sys/fs/cgroup/memory.max", "/sys/fs/cgroup/memory/memory.limit_in_bytes"
+	};
+	for (int i = 0; i < 2; i++) {
+		ifstream cg(cgroups[i]);
+		long long cglimit = 0;
+		if (cg >> cglimit) { // "max" if there is no limit
+			if (cglimit > 0 && (limit == 0 || cglimit < limit)) limit = cglimit;
+			break;
+		}
+	}
+#endif
+	return limit;
+}
+
+bool Preflight::estimate(batchfiles& b, const string outdir) {
+	simEngine eng = paramsSim->getEngine();
+	if (eng.preflight == 0) return true;
+
+	ostringstream detail, summary;
+	detail << fixed << setprecision(1);
+	summary << fixed << setprecision(1);
+	detail << endl << "Pre-flight estimate of resources" << endl
+		<< "Landscape,Simulation,Cells,Patches,Individuals,PeakMemoryMB,SecsPerYear,Secs" << endl;
+
+	preflightEstimate e, largest;
+	int largestLand = 0, largestSim = 0;
+	largest.total = 0;
+	double batchSecs = 0.0;
+	for (int j = 0; j < (int)lands.size(); j++) {
+		scanLandscape(lands[j], b);
+		for (int i = 0; i < (int)sims.size(); i++) {
+			e = estimateSim(lands[j], sims[i], b);
+			detail << lands[j].landNum << "," << sims[i].simul << ","
+				<< e.mem.objects[MEMCELLS] << "," << e.mem.objects[MEMPATCHES] - 1 << ","
+				<< (long long)e.inds << "," << megabytes(e.total) << ","
+				<< setprecision(3) << e.yearSecs << "," << setprecision(1) << e.simSecs << endl;
+			batchSecs += e.simSecs;
+			if (e.total > largest.total) {
+				largest = e; largestLand = lands[j].landNum; largestSim = sims[i].simul;
+			}
+		}
+	}
+
+	long long limit = memoryLimit();
+	summary << endl << "Pre-flight estimate: peak memory " << megabytes(largest.total)
+		<< " MB (Simulation " << largestSim << " on Landscape " << largestLand << ":";
+	for (int i = 0; i < NMEMSUBSYSTEMS; i++) {
+		summary << (i ? ", " : " ") << memoryName(i) << " " << megabytes(largest.mem.bytes[i]);
+	}
+	summary << " MB)" << endl
+		<< "Pre-flight estimate: time " << batchSecs << " s for the batch" << endl;
+	if (limit > 0) summary << "Memory available " << megabytes(limit) << " MB" << endl;
+	else summary << "Memory available is unknown - set MemoryLimit to check it" << endl;
+
+	bool run = true;
+	if (limit > 0 && largest.total > limit) {
+		summary << "*** Estimated peak memory exceeds the memory available";
+		if (eng.preflight == 1) { summary << " - batch NOT run"; run = false; }
+		summary << endl;
+	}
+	else {
+		if (limit > 0 && (double)largest.total > memWarning * (double)limit)
+			summary << "*** Warning: estimated peak memory exceeds "
+			<< (int)(memWarning * 100.0) << "% of the memory available" << endl;
+	}
+	if (eng.preflight == 2) {
+		summary << "Pre-flight estimate only (Preflight 2) - batch not run" << endl;
+		run = false;
+	}
+
+	cout << summary.str();
+	ofstream log((outdir + "BatchLog.txt").c_str(), ios::app);
+	if (log.is_open()) {
+		log << detail.str() << summary.str();
+		log.close();
+	}
+	return run;
+}
+
+//---------------------------------------------------------------------------
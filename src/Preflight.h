@@ -0,0 +1,166 @@
+/*----------------------------------------------------------------------------
+ *	
+ *	Copyright (C) 2020 Greta Bocedi, Stephen C.F. Palmer, Justin M.J. Travis, Anne-Kathleen Malchow, Damaris Zurell 
+ *	
+ *	This file is part of RangeShifter.
+ *	
+ *	RangeShifter is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *	
+ *	RangeShifter is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *	GNU General Public License for more details.
+ *	
+ *	You should have received a copy of the GNU General Public License
+ *	along with RangeShifter. If not, see <https://www.gnu.org/licenses/>.
+ *	
+ --------------------------------------------------------------------------*/
+ 
+ 
+/*------------------------------------------------------------------------------
+
+RangeShifter v2.0 Preflight
+
+Implements the Preflight class
+
+Estimates, before a batch is run, the memory and time which each of its
+simulations will need on each of its landscapes, so that a batch which will not
+fit on the node can be refused at once rather than failing after hours in a queue.
+
+The batch input files are described to the Preflight as they are parsed: the size
+and files of each landscape, and the replicates, years, carrying capacities,
+outputs, traits varying between individuals and genome of each simulation. The
+rasters of each real landscape are then read once (the habitat, and in a
+patch-based model the patch raster) to count the cells of each habitat and the
+patches, from which the expected no. of individuals at carrying capacity is found.
+
+Memory is estimated for the same subsystems as are accounted by MemoryAccount,
+from the sizes of the objects of the model; the peak no. of individuals is taken
+as twice that at carrying capacity, i.e. adults and a cohort of juveniles. Time is
+estimated from costs per individual per year and per cell per replicate, which were
+calibrated from the profiles (see Profiler) of the test scenarios in the default
+build; it is no more than a guide to the order of magnitude.
+
+For full details of RangeShifter, please see:
+Bocedi G., Palmer S.C.F., Peer G., Heikkinen R.K., Matsinos Y.G., Watts K.
+and Travis J.M.J. (2014). RangeShifter: a platform for modelling spatial
+eco-evolutionary dynamics and species responses to environmental changes.
+Methods in Ecology and Evolution, 5, 388-396. doi: 10.1111/2041-210X.12162
+
+------------------------------------------------------------------------------*/
+
+#ifndef PreflightH
+#define PreflightH
+
+#include <vector>
+#include <string>
+#include <map>
+using namespace std;
+
+#include "./RScore/MemoryAccount.h"
+
+struct batchfiles;
+
+struct preflightLand {
+	int landNum;
+	int ncols, nrows;
+	string landFile, patchFile;	// full names of the rasters ("" if none)
+	bool costs;					// has an SMS cost map?
+	bool dynamic;				// has landscape changes?
+	bool continuous;		// artificial landscape of habitat quality?
+	float minHab, maxHab, pSuit;	// artificial landscape parameters
+};
+
+struct preflightSim {
+	int simul;
+	int reps, years;
+	vector <float> K;		// carrying capacity of each habitat (inds/ha)
+	int outputs;				// no. of output files written
+	bool connect;				// connectivity matrix written?
+	// emigration, transfer and settlement traits varying between individuals:
+	// 0 = none, 1 = as for all individuals, 2 = sex-dependent
+	short emigVar, trfrVar, settVar;
+	int arch;						// genetic architecture: 0 = one chromosome per trait, 1 = from file
+	int nLoci;					// no. of loci per trait (architecture 0)
+	string archFile;		// architecture file (architecture 1)
+};
+
+struct archSize { int chromosomes, loci; };
+
+struct preflightEstimate {
+	memUsage mem;
+	long long total;		// peak memory (bytes)
+	double inds;				// expected no. of individuals at carrying capacity
+	double yearSecs;		// time per year (s)
+	double simSecs;			// time for all replicates (s)
+};
+
+//---------------------------------------------------------------------------
+
+class Preflight {
+public:
+	Preflight(void);
+	~Preflight(void);
+	void addLandscape( // Describe a landscape from the LandFile
+		preflightLand
+	);
+	void addSimulation( // Describe a simulation from the ParameterFile
+		preflightSim
+	);
+	void addIndVar( // Record traits varying between individuals from a dispersal file
+		const int,		// simulation
+		const string,	// type of dispersal file
+		const int			// sex-dependent?
+	);
+	void setArchitecture( // Record the size of the architecture file just parsed
+		const int,		// no. of chromosomes
+		const int			// total no. of loci
+	);
+	void addGenetics( // Describe the genome of a simulation from the GeneticsFile
+		const int,		// simulation
+		const int,		// architecture
+		const int,		// no. of loci per trait
+		const string	// architecture file
+	);
+	bool estimate( // Estimate and report the resources needed by the batch; returns
+								 // false if the batch should not be run
+		batchfiles&,
+		const string	// output directory
+	);
+
+private:
+	void scanLandscape( // Count the cells of each habitat and the patches of a landscape
+		preflightLand&,
+		batchfiles&
+	);
+	preflightEstimate estimateSim( // Estimate the resources for a simulation on a landscape
+		preflightLand&,
+		preflightSim&,
+		batchfiles&
+	);
+	long long memoryLimit(void); // memory available to the batch (bytes), 0 if unknown
+
+	vector <preflightLand> lands;
+	vector <preflightSim> sims;
+	map <string, archSize> archs;
+	archSize lastArch;
+	// results of scanning the current landscape
+	long long dataCells;				// cells which are not no-data
+	long long nPatches;					// patches (patch-based model)
+	long long inPatches;				// cells in patches (patch-based model)
+	vector <long long> habCells;		// cells of each habitat (in order of habitat code)
+	vector <long long> patchCells;	// cells of each habitat in patches (patch-based model)
+	double quality, patchQuality;		// sum of habitat quality (%) of all cells and of cells in patches
+	long long qualCells;				// cells of non-zero habitat quality
+
+};
+
+extern Preflight preflight;
+
+extern paramSim *paramsSim;
+
+//---------------------------------------------------------------------------
+#endif
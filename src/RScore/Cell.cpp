@@ -201,6 +201,16 @@ void Cell::resetVisits(void) { visits = 0; }
 void Cell::incrVisits(void) { visits++; }
 unsigned long int Cell::getVisits(void) { return visits; }
 
+void Cell::memory(memUsage& m) {
+m.objects[MEMCELLS]++;
+m.bytes[MEMCELLS] += sizeof(Cell) + habIxx.capacity() * sizeof(short)
+	+ habitats.capacity() * sizeof(float);
+if (smsData != 0) {
+	m.bytes[MEMCELLS] += sizeof(smscosts);
+	if (smsData->effcosts != 0) m.bytes[MEMCELLS] += sizeof(array3x3f);
+}
+}
+
 //---------------------------------------------------------------------------
 
 // Initial species distribution cell functions
@@ -49,6 +49,7 @@ Last updated: 14 January 2021 by Steve Palmer
 using namespace std;
 
 #include "Parameters.h"
+#include "MemoryAccount.h"
 
 //---------------------------------------------------------------------------
 
@@ -120,6 +121,9 @@ public:
 	void resetVisits(void);
 	void incrVisits(void);
 	unsigned long int getVisits(void);
+	void memory( // Add the memory held by the cell to a census
+		memUsage&
+	);
 
 private:
 	int x,y;			// cell co-ordinates
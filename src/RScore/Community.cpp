@@ -27,15 +27,16 @@
 //---------------------------------------------------------------------------
 
 
-ofstream outrange;
-ofstream outoccup, outsuit;
-ofstream outtraitsrows;
+outFile outrange;
+outFile outoccup, outsuit;
+outFile outtraitsrows;
 
 //---------------------------------------------------------------------------
 
 Community::Community(Landscape* pLand) {
 	pLandscape = pLand;
 	indIx = 0;
+	occRows = occCols = 0; occBytes = 1;
 }
 
 Community::~Community(void) {
@@ -394,6 +395,7 @@ void Community::resetPopns(void) {
 }
 
 void Community::localExtinction(int option) {
+	profScope prof(PROFEXTINCTION);
 	int nsubcomms = (int)subComms.size();
 	for (int i = 0; i < nsubcomms; i++) { // all sub-communities
 		if (subComms[i]->getNum() > 0) { // except in matrix
@@ -403,6 +405,7 @@ void Community::localExtinction(int option) {
 }
 
 void Community::patchChanges(void) {
+	profScope prof(PROFLANDCHANGE);
 	int nsubcomms = (int)subComms.size();
 	for (int i = 0; i < nsubcomms; i++) { // all sub-communities
 		if (subComms[i]->getNum() > 0) { // except in matrix
@@ -413,6 +416,7 @@ void Community::patchChanges(void) {
 
 void Community::reproduction(int yr)
 {
+	profScope prof(PROFREPRODUCTION);
 	float eps = 0.0; // epsilon for environmental stochasticity
 	landParams land = pLandscape->getLandParams();
 	envStochParams env = paramsStoch->getStoch();
@@ -437,6 +441,7 @@ void Community::reproduction(int yr)
 
 void Community::emigration(void)
 {
+	profScope prof(PROFEMIGRATION);
 	int nsubcomms = (int)subComms.size();
 #if RSDEBUG
 	DEBUGLOG << "Community::emigration(): this=" << this
@@ -466,9 +471,11 @@ void Community::dispersal(short landIx)
 	int nsubcomms = (int)subComms.size();
 	// initiate dispersal - all emigrants leave their natal community and join matrix community
 	SubCommunity* matrix = subComms[0]; // matrix community is always the first
+	profScope initScope(PROFDISPINIT);
 	for (int i = 0; i < nsubcomms; i++) { // all populations
 		subComms[i]->initiateDispersal(matrix);
 	}
+	initScope.stop();
 #if RSDEBUG
 	t1 = time(0);
 	DEBUGLOG << "Community::dispersal(): this=" << this
@@ -479,6 +486,7 @@ void Community::dispersal(short landIx)
 	// (even if not physically in the matrix)
 	int ndispersers = 0;
 	do {
+		profScope transferScope(PROFTRANSFER);
 		for (int i = 0; i < nsubcomms; i++) { // all populations
 			subComms[i]->resetPossSettlers();
 		}
@@ -487,8 +495,14 @@ void Community::dispersal(short landIx)
 #else
 		ndispersers = matrix->transfer(pLandscape, landIx);
 #endif // SEASONAL || RS_RCPP
+		transferScope.stop();
+		profScope settleScope(PROFSETTLEMENT);
 		matrix->completeDispersal(pLandscape, sim.outConnect);
 	} while (ndispersers > 0);
+	if (dispStats.active()) {
+		profScope statsScope(PROFOUTDISPSTATS);
+		matrix->recordDispersal();
+	}
 
 #if RSDEBUG
 	DEBUGLOG << "Community::dispersal(): matrix=" << matrix << endl;
@@ -500,6 +514,7 @@ void Community::dispersal(short landIx)
 
 void Community::survival(short part, short option0, short option1)
 {
+	profScope prof(PROFSURVIVAL);
 	int nsubcomms = (int)subComms.size();
 	for (int i = 0; i < nsubcomms; i++) { // all communities (including in matrix)
 		subComms[i]->survival(part, option0, option1);
@@ -507,6 +522,7 @@ void Community::survival(short part, short option0, short option1)
 }
 
 void Community::ageIncrement(void) {
+	profScope prof(PROFSURVIVAL);
 	int nsubcomms = (int)subComms.size();
 	for (int i = 0; i < nsubcomms; i++) { // all communities (including in matrix)
 		subComms[i]->ageIncrement();
@@ -525,6 +541,11 @@ int Community::totalInds(void) {
 	return total;
 }
 
+int Community::matrixInds(void) {
+	if (subComms.empty()) return 0;
+	return subComms[0]->getPopStats().nInds;
+}
+
 // Find the population of a given species in a given patch
 Population* Community::findPop(Species* pSp, Patch* pPch) {
 	Population* pPop = 0;
@@ -538,44 +559,75 @@ Population* Community::findPop(Species* pSp, Patch* pPch) {
 
 //---------------------------------------------------------------------------
 void Community::createOccupancy(int nrows, int reps) {
-	int nsubcomms = (int)subComms.size();
-	for (int i = 0; i < nsubcomms; i++) {
-		subComms[i]->createOccupancy(nrows);
-	}
+	occRows = nrows;
+	occCols = (int)subComms.size();
+	if (reps < 256) occBytes = 1;
+	else if (reps < 65536) occBytes = 2;
+	else occBytes = 4;
+	occupancy.assign((size_t)occRows * occCols * occBytes, 0);
 	// Initialise array for occupancy of suitable cells/patches
-	occSuit = new float* [nrows];
-	for (int i = 0; i < nrows; i++)
-	{
-		occSuit[i] = new float[reps];
-		for (int ii = 0; ii < reps; ii++) occSuit[i][ii] = 0.0;
-	}
+	occSuit.assign((size_t)nrows * reps, 0.0);
 }
 
+// Count the occupied sub-communities, and the proportion of suitable patches
+// which are occupied, in a row of the occupancy matrix
 void Community::updateOccupancy(int row, int rep)
 {
+	profScope prof(PROFOUTOCCUPANCY);
 #if RSDEBUG
 	DEBUGLOG << "Community::updateOccupancy(): row=" << row << endl;
 #endif
-	int nsubcomms = (int)subComms.size();
-	for (int i = 0; i < nsubcomms; i++) {
-		subComms[i]->updateOccupancy(row);
+	if (occupancy.empty()) return;
+	simParams sim = paramsSim->getSim();
+	int suitable = 0, occupied = 0;
+	size_t ix = (size_t)row * occCols;
+	for (int i = 0; i < occCols; i++) {
+		Patch* pPatch = subComms[i]->getPatch();
+		bool matrix = pPatch == 0 || pPatch->getPatchNum() == 0;
+		if (!matrix && pPatch->getK() > 0.0) suitable++;
+		if (subComms[i]->occupied()) {
+			addOccupancy(ix + i);
+			if (!matrix) occupied++;
+		}
 	}
+	occSuit[(size_t)row * sim.reps + rep] = (float)occupied / (float)suitable;
 
-	commStats s = getStats();
-	occSuit[row][rep] = (float)s.occupied / (float)s.suitable;
+}
 
+void Community::deleteOccupancy(void) {
+	occupancy.clear(); occupancy.shrink_to_fit();
+	occSuit.clear(); occSuit.shrink_to_fit();
+	occRows = occCols = 0;
 }
 
-void Community::deleteOccupancy(int nrows) {
+void Community::memory(memUsage& m) {
+	m.bytes[MEMPOPNS] += subComms.capacity() * sizeof(SubCommunity*);
 	int nsubcomms = (int)subComms.size();
-	for (int i = 0; i < nsubcomms; i++) {
-		subComms[i]->deleteOccupancy();
+	for (int i = 0; i < nsubcomms; i++) subComms[i]->memory(m);
+	if (occupancy.capacity() > 0) {
+		m.objects[MEMOUTPUT]++;
+		m.bytes[MEMOUTPUT] += occupancy.capacity() + occSuit.capacity() * sizeof(float);
 	}
+}
 
-	for (int i = 0; i < nrows; i++)
-		delete[] occSuit[i];
-	delete[] occSuit;
+void Community::addOccupancy(size_t ix) {
+	unsigned char* p = &occupancy[ix * occBytes];
+	if (occBytes == 1) { (*p)++; return; }
+	if (occBytes == 2) {
+		unsigned short n; memcpy(&n, p, 2); n++; memcpy(p, &n, 2);
+	}
+	else {
+		unsigned int n; memcpy(&n, p, 4); n++; memcpy(p, &n, 4);
+	}
+}
 
+int Community::getOccupancy(size_t ix) {
+	const unsigned char* p = &occupancy[ix * occBytes];
+	if (occBytes == 1) return *p;
+	if (occBytes == 2) {
+		unsigned short n; memcpy(&n, p, 2); return n;
+	}
+	unsigned int n; memcpy(&n, p, 4); return (int)n;
 }
 
 //---------------------------------------------------------------------------
@@ -624,6 +676,7 @@ bool Community::outPopHeaders(Species* pSpecies, int option) {
 // Write records to population file
 void Community::outPop(int rep, int yr, int gen)
 {
+	profScope prof(PROFOUTPOP);
 	// generate output for each sub-community (patch) in the community
 	int nsubcomms = (int)subComms.size();
 	for (int i = 0; i < nsubcomms; i++) { // all sub-communities
@@ -635,6 +688,7 @@ void Community::outPop(int rep, int yr, int gen)
 
 // Write records to individuals file
 void Community::outInds(int rep, int yr, int gen, int landNr) {
+	profScope prof(PROFOUTINDS);
 
 	if (landNr >= 0) { // open the file
 		subComms[0]->outInds(pLandscape, rep, yr, gen, landNr);
@@ -653,22 +707,35 @@ void Community::outInds(int rep, int yr, int gen, int landNr) {
 
 // Write records to genetics file
 void Community::outGenetics(int rep, int yr, int gen, int landNr) {
-	//landParams ppLand = pLandscape->getLandParams();
+	profScope prof(PROFOUTGENETICS);
+	landParams ppLand = pLandscape->getLandParams();
 	if (landNr >= 0) { // open the file
-		subComms[0]->outGenetics(rep, yr, gen, landNr);
+		subComms[0]->outGenetics(rep, yr, gen, landNr, ppLand.patchModel);
 		return;
 	}
 	if (landNr == -999) { // close the file
-		subComms[0]->outGenetics(rep, yr, gen, landNr);
+		subComms[0]->outGenetics(rep, yr, gen, landNr, ppLand.patchModel);
 		return;
 	}
 	// generate output for each sub-community (patch) in the community
 	int nsubcomms = (int)subComms.size();
 	for (int i = 0; i < nsubcomms; i++) { // all sub-communities
-		subComms[i]->outGenetics(rep, yr, gen, landNr);
+		subComms[i]->outGenetics(rep, yr, gen, landNr, ppLand.patchModel);
 	}
 }
 
+// Open dispersal statistics files and write header records
+bool Community::outDispStatsHeaders(Species* pSpecies, int landNr) {
+	simEngine eng = paramsSim->getEngine();
+	return dispStats.outHeaders(pLandscape, pSpecies, landNr, eng.dispStats);
+}
+
+// Write dispersal statistics of the year (if due)
+void Community::outDispStats(int rep, int yr) {
+	profScope prof(PROFOUTDISPSTATS);
+	dispStats.outStats(rep, yr);
+}
+
 // Open range file and write header record
 bool Community::outRangeHeaders(Species* pSpecies, int landNr)
 {
@@ -714,7 +781,7 @@ bool Community::outRangeHeaders(Species* pSpecies, int landNr)
 	else {
 		name = paramsSim->getDir(2) + "Sim" + Int2Str(sim.simulation) + "_Range.txt";
 	}
-	outrange.open(name.c_str());
+	outrange.open(name.c_str(), false, paramsSim->getEngine().compRange, true);
 	outrange << "Rep\tYear\tRepSeason";
 	if (env.stoch && !env.local) outrange << "\tEpsilon";
 
@@ -798,6 +865,7 @@ bool Community::outRangeHeaders(Species* pSpecies, int landNr)
 // Write record to range file
 void Community::outRange(Species* pSpecies, int rep, int yr, int gen)
 {
+	profScope prof(PROFOUTRANGE);
 #if RSDEBUG
 	DEBUGLOG << "Community::outRange(): rep=" << rep
 		<< " yr=" << yr << " gen=" << gen << endl;
@@ -860,47 +928,14 @@ void Community::outRange(Species* pSpecies, int rep, int yr, int gen)
 	if (emig.indVar || trfr.indVar || sett.indVar) { // output trait means
 		traitsums ts;
 		traitsums scts; // sub-community traits
-		traitCanvas tcanv;
+		std::vector <traitsums> poptraits;
 		int ngenes, popsize;
 
-		tcanv.pcanvas[0] = NULL;
-
-		for (int i = 0; i < NSEXES; i++) {
-			ts.ninds[i] = 0;
-			ts.sumD0[i] = ts.ssqD0[i] = 0.0;
-			ts.sumAlpha[i] = ts.ssqAlpha[i] = 0.0; ts.sumBeta[i] = ts.ssqBeta[i] = 0.0;
-			ts.sumDist1[i] = ts.ssqDist1[i] = 0.0; ts.sumDist2[i] = ts.ssqDist2[i] = 0.0;
-			ts.sumProp1[i] = ts.ssqProp1[i] = 0.0;
-			ts.sumDP[i] = ts.ssqDP[i] = 0.0;
-			ts.sumGB[i] = ts.ssqGB[i] = 0.0;
-			ts.sumAlphaDB[i] = ts.ssqAlphaDB[i] = 0.0;
-			ts.sumBetaDB[i] = ts.ssqBetaDB[i] = 0.0;
-			ts.sumStepL[i] = ts.ssqStepL[i] = 0.0; ts.sumRho[i] = ts.ssqRho[i] = 0.0;
-			ts.sumS0[i] = ts.ssqS0[i] = 0.0;
-			ts.sumAlphaS[i] = ts.ssqAlphaS[i] = 0.0; ts.sumBetaS[i] = ts.ssqBetaS[i] = 0.0;
-		}
-
+		clearTraits(ts);
 		int nsubcomms = (int)subComms.size();
 		for (int i = 0; i < nsubcomms; i++) { // all sub-communities (incl. matrix)
-			scts = subComms[i]->outTraits(tcanv, pLandscape, rep, yr, gen, true);
-			for (int j = 0; j < NSEXES; j++) {
-				ts.ninds[j] += scts.ninds[j];
-				ts.sumD0[j] += scts.sumD0[j];     ts.ssqD0[j] += scts.ssqD0[j];
-				ts.sumAlpha[j] += scts.sumAlpha[j];  ts.ssqAlpha[j] += scts.ssqAlpha[j];
-				ts.sumBeta[j] += scts.sumBeta[j];   ts.ssqBeta[j] += scts.ssqBeta[j];
-				ts.sumDist1[j] += scts.sumDist1[j];  ts.ssqDist1[j] += scts.ssqDist1[j];
-				ts.sumDist2[j] += scts.sumDist2[j];  ts.ssqDist2[j] += scts.ssqDist2[j];
-				ts.sumProp1[j] += scts.sumProp1[j];  ts.ssqProp1[j] += scts.ssqProp1[j];
-				ts.sumDP[j] += scts.sumDP[j];     ts.ssqDP[j] += scts.ssqDP[j];
-				ts.sumGB[j] += scts.sumGB[j];     ts.ssqGB[j] += scts.ssqGB[j];
-				ts.sumAlphaDB[j] += scts.sumAlphaDB[j]; ts.ssqAlphaDB[j] += scts.ssqAlphaDB[j];
-				ts.sumBetaDB[j] += scts.sumBetaDB[j];  ts.ssqBetaDB[j] += scts.ssqBetaDB[j];
-				ts.sumStepL[j] += scts.sumStepL[j];  ts.ssqStepL[j] += scts.ssqStepL[j];
-				ts.sumRho[j] += scts.sumRho[j];    ts.ssqRho[j] += scts.ssqRho[j];
-				ts.sumS0[j] += scts.sumS0[j];     ts.ssqS0[j] += scts.ssqS0[j];
-				ts.sumAlphaS[j] += scts.sumAlphaS[j]; ts.ssqAlphaS[j] += scts.ssqAlphaS[j];
-				ts.sumBetaS[j] += scts.sumBetaS[j];  ts.ssqBetaS[j] += scts.ssqBetaS[j];
-			}
+			subComms[i]->getTraits(poptraits, scts);
+			addTraits(ts, scts);
 		}
 
 		if (emig.indVar) {
@@ -1164,7 +1199,7 @@ void Community::outOccupancy(void) {
 	simParams sim = paramsSim->getSim();
 	locn loc;
 
-	int nsubcomms = (int)subComms.size();
+	int nsubcomms = occCols;
 	for (int i = 1; i < nsubcomms; i++) { // all except matrix sub-community
 		if (ppLand.patchModel) {
 			outoccup << subComms[i]->getPatch()->getPatchNum();
@@ -1173,9 +1208,9 @@ void Community::outOccupancy(void) {
 			loc = subComms[i]->getLocn();
 			outoccup << loc.x << "\t" << loc.y;
 		}
-		for (int row = 0; row <= (sim.years / sim.outIntOcc); row++)
+		for (int row = 0; row < occRows; row++)
 		{
-			outoccup << "\t" << (double)subComms[i]->getOccupancy(row) / (double)sim.reps;
+			outoccup << "\t" << (double)getOccupancy((size_t)row * occCols + i) / (double)sim.reps;
 		}
 		outoccup << endl;
 	}
@@ -1187,8 +1222,8 @@ void Community::outOccSuit(bool view) {
 	for (int i = 0; i < (sim.years / sim.outIntOcc) + 1; i++) {
 		sum = ss = 0.0;
 		for (int rep = 0; rep < sim.reps; rep++) {
-			sum += occSuit[i][rep];
-			ss += occSuit[i][rep] * occSuit[i][rep];
+			sum += occSuit[(size_t)i * sim.reps + rep];
+			ss += occSuit[(size_t)i * sim.reps + rep] * occSuit[(size_t)i * sim.reps + rep];
 		}
 		mean = sum / (double)sim.reps;
 		sd = (ss - (sum * sum / (double)sim.reps)) / (double)(sim.reps - 1);
@@ -1215,61 +1250,31 @@ order of y
 void Community::outTraits(traitCanvas tcanv, Species* pSpecies,
 	int rep, int yr, int gen)
 {
+	profScope prof(PROFOUTTRAITS);
 	simParams sim = paramsSim->getSim();
 	simView v = paramsSim->getViews();
 	landParams land = pLandscape->getLandParams();
-	traitsums* ts = 0;
-	traitsums sctraits;
-	if (sim.outTraitsRows && yr >= sim.outStartTraitRow && yr % sim.outIntTraitRow == 0) {
-		// create array of traits means, etc., one for each row
-		ts = new traitsums[land.dimY];
-		for (int y = 0; y < land.dimY; y++) {
-			for (int i = 0; i < NSEXES; i++) {
-				ts[y].ninds[i] = 0;
-				ts[y].sumD0[i] = ts[y].ssqD0[i] = 0.0;
-				ts[y].sumAlpha[i] = ts[y].ssqAlpha[i] = 0.0;
-				ts[y].sumBeta[i] = ts[y].ssqBeta[i] = 0.0;
-				ts[y].sumDist1[i] = ts[y].ssqDist1[i] = 0.0;
-				ts[y].sumDist2[i] = ts[y].ssqDist2[i] = 0.0;
-				ts[y].sumProp1[i] = ts[y].ssqProp1[i] = 0.0;
-				ts[y].sumStepL[i] = ts[y].ssqStepL[i] = 0.0;
-				ts[y].sumRho[i] = ts[y].ssqRho[i] = 0.0;
-				ts[y].sumS0[i] = ts[y].ssqS0[i] = 0.0;
-				ts[y].sumAlphaS[i] = ts[y].ssqAlphaS[i] = 0.0;
-				ts[y].sumBetaS[i] = ts[y].ssqBetaS[i] = 0.0;
-			}
-		}
-	}
+	bool rows = sim.outTraitsRows && yr >= sim.outStartTraitRow && yr % sim.outIntTraitRow == 0;
 	if (v.viewTraits
 		|| ((sim.outTraitsCells && yr >= sim.outStartTraitCell && yr % sim.outIntTraitCell == 0) ||
-			(sim.outTraitsRows && yr >= sim.outStartTraitRow && yr % sim.outIntTraitRow == 0)))
+			rows))
 	{
-		// generate output for each sub-community (patch) in the community
+		// sum trait genes of each sub-community (patch) in the community,
+		// and if required of each row of the landscape, in parallel
 		int nsubcomms = (int)subComms.size();
+		std::vector < std::vector <traitsums> > poptraits(nsubcomms);
+		std::vector <traitsums> ts; // traits sums, one for each row
+		if (rows) {
+			ts.resize(land.dimY);
+			for (int y = 0; y < land.dimY; y++) clearTraits(ts[y]);
+		}
+		sumTraits(poptraits, ts);
+
+		// generate output for each sub-community in turn
 		for (int i = 1; i < nsubcomms; i++) { // // all except matrix sub-community
-			sctraits = subComms[i]->outTraits(tcanv, pLandscape, rep, yr, gen, false);
-			locn loc = subComms[i]->getLocn();
-			int y = loc.y;
-			if (sim.outTraitsRows && yr >= sim.outStartTraitRow && yr % sim.outIntTraitRow == 0)
-			{
-				for (int s = 0; s < NSEXES; s++) {
-					ts[y].ninds[s] += sctraits.ninds[s];
-					ts[y].sumD0[s] += sctraits.sumD0[s];     ts[y].ssqD0[s] += sctraits.ssqD0[s];
-					ts[y].sumAlpha[s] += sctraits.sumAlpha[s];  ts[y].ssqAlpha[s] += sctraits.ssqAlpha[s];
-					ts[y].sumBeta[s] += sctraits.sumBeta[s];   ts[y].ssqBeta[s] += sctraits.ssqBeta[s];
-					ts[y].sumDist1[s] += sctraits.sumDist1[s];  ts[y].ssqDist1[s] += sctraits.ssqDist1[s];
-					ts[y].sumDist2[s] += sctraits.sumDist2[s];  ts[y].ssqDist2[s] += sctraits.ssqDist2[s];
-					ts[y].sumProp1[s] += sctraits.sumProp1[s];  ts[y].ssqProp1[s] += sctraits.ssqProp1[s];
-					ts[y].sumStepL[s] += sctraits.sumStepL[s];  ts[y].ssqStepL[s] += sctraits.ssqStepL[s];
-					ts[y].sumRho[s] += sctraits.sumRho[s];    ts[y].ssqRho[s] += sctraits.ssqRho[s];
-					ts[y].sumS0[s] += sctraits.sumS0[s];     ts[y].ssqS0[s] += sctraits.ssqS0[s];
-					ts[y].sumAlphaS[s] += sctraits.sumAlphaS[s]; ts[y].ssqAlphaS[s] += sctraits.ssqAlphaS[s];
-					ts[y].sumBetaS[s] += sctraits.sumBetaS[s];  ts[y].ssqBetaS[s] += sctraits.ssqBetaS[s];
-				}
-			}
+			subComms[i]->outTraits(tcanv, pLandscape, rep, yr, gen, poptraits[i]);
 		}
-		if (nsubcomms > 0 && sim.outTraitsRows
-			&& yr >= sim.outStartTraitRow && yr % sim.outIntTraitRow == 0) {
+		if (nsubcomms > 0 && rows) {
 			for (int y = 0; y < land.dimY; y++) {
 				if ((ts[y].ninds[0] + ts[y].ninds[1]) > 0) {
 					writeTraitsRows(pSpecies, rep, yr, gen, y, ts[y]);
@@ -1277,7 +1282,66 @@ void Community::outTraits(traitCanvas tcanv, Species* pSpecies,
 			}
 		}
 	}
-	if (ts != 0) { delete[] ts; ts = 0; }
+}
+
+// Sum trait genes of each sub-community (except the matrix), and if row sums are
+// required (rowsums not empty), add the sums of each sub-community to its row.
+// The sub-communities are divided between threads in blocks of whole rows, each
+// thread accumulating partial sums for its own rows, which are merged at the end;
+// as each row is summed by one thread in the original order, the results are the
+// same for any no. of threads.
+void Community::sumTraits(std::vector < std::vector <traitsums> >& poptraits,
+	std::vector <traitsums>& rowsums)
+{
+	struct rowPartial { int y; traitsums ts; };
+	int nsubcomms = (int)subComms.size();
+	bool rows = !rowsums.empty();
+	simEngine eng = paramsSim->getEngine();
+	int nthreads = eng.threads;
+	if (nthreads == 0) nthreads = (int)std::thread::hardware_concurrency();
+	// at least minSubComms per thread, so that small landscapes are not slowed down
+	const int minSubComms = 256;
+	if (nthreads > (nsubcomms - 1) / minSubComms) nthreads = (nsubcomms - 1) / minSubComms;
+	if (nthreads < 1) nthreads = 1;
+
+	// divide the sub-communities into blocks, extending each block to the end of a row
+	std::vector <int> first(nthreads + 1);
+	first[0] = 1; first[nthreads] = nsubcomms;
+	for (int t = 1; t < nthreads; t++) {
+		int i = 1 + (int)((long long)(nsubcomms - 1) * t / nthreads);
+		if (i < first[t - 1]) i = first[t - 1];
+		while (rows && i > 1 && i < nsubcomms
+			&& subComms[i]->getLocn().y == subComms[i - 1]->getLocn().y) i++;
+		first[t] = i;
+	}
+
+	std::vector < std::vector <rowPartial> > partials(nthreads);
+	auto sumBlock = [&](int t) {
+		traitsums scts;
+		for (int i = first[t]; i < first[t + 1]; i++) {
+			subComms[i]->getTraits(poptraits[i], scts);
+			if (rows) {
+				int y = subComms[i]->getLocn().y;
+				if (partials[t].empty() || partials[t].back().y != y) {
+					partials[t].push_back(rowPartial());
+					partials[t].back().y = y;
+					clearTraits(partials[t].back().ts);
+				}
+				addTraits(partials[t].back().ts, scts);
+			}
+		}
+	};
+	std::vector <std::thread> workers;
+	for (int t = 1; t < nthreads; t++) workers.push_back(std::thread(sumBlock, t));
+	sumBlock(0);
+	for (int t = 0; t < (int)workers.size(); t++) workers[t].join();
+
+	if (rows) {
+		for (int t = 0; t < nthreads; t++) {
+			for (int j = 0; j < (int)partials[t].size(); j++)
+				addTraits(rowsums[partials[t][j].y], partials[t][j].ts);
+		}
+	}
 }
 
 // Write records to trait rows file
@@ -1453,7 +1517,7 @@ bool Community::outTraitsRowsHeaders(Species* pSpecies, int landNr) {
 	else {
 		name = DirOut + "Sim" + Int2Str(sim.simulation) + "_TraitsXrow.txt";
 	}
-	outtraitsrows.open(name.c_str());
+	outtraitsrows.open(name.c_str(), false, paramsSim->getEngine().compTraits, true);
 
 	outtraitsrows << "Rep\tYear\tRepSeason\ty";
 	if ((emig.indVar && emig.sexDep) || (trfr.indVar && trfr.sexDep))
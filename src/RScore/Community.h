@@ -32,7 +32,10 @@ and is thus the highest-level entity accessed for most processing concerned with
 simulated populations.
 
 Optionally, the Community maintains a record of the occupancy of suitable cells
-or patches during the course of simulation of multiple replicates.
+or patches during the course of simulation of multiple replicates, as a single
+matrix of the no. of replicates in which each sub-community was occupied in each
+row (i.e. year / interval), of which each count takes only as many bytes as the
+no. of replicates requires.
 
 For full details of RangeShifter, please see:
 Bocedi G., Palmer S.C.F., Peer G., Heikkinen R.K., Matsinos Y.G., Watts K.
@@ -51,6 +54,7 @@ Last updated: 25 June 2021 by Anne-Kathleen Malchow
 
 #include <vector>
 #include <algorithm>
+#include <thread>
 using namespace std;
 
 #include "SubCommunity.h"
@@ -58,6 +62,7 @@ using namespace std;
 #include "Patch.h"
 #include "Cell.h"
 #include "Species.h"
+#include "Profiler.h"
 
 //---------------------------------------------------------------------------
 struct commStats {
@@ -106,6 +111,7 @@ public:
 	);
 	void ageIncrement(void);
 	int totalInds(void);
+	int matrixInds(void); // no. of individuals in the matrix, i.e. dispersers in transit
 	Population* findPop( // Find the population of a given species in a given patch
 		Species*, // pointer to Species
 		Patch*		// pointer to Patch
@@ -119,9 +125,7 @@ public:
 		int,	// row = (no. of years / interval)
 		int		// replicate
 	);
-	void deleteOccupancy(
-		int		// no. of rows (as above)
-	);
+	void deleteOccupancy(void);
 
 	bool outRangeHeaders( // Open range file and write header record
 		Species*,	// pointer to Species
@@ -157,6 +161,14 @@ public:
 		int		// Landscape number (>= 0 to open the file, -999 to close the file
 					//									 -1 to write data records)
 	);
+	bool outDispStatsHeaders( // Open dispersal statistics files and write header records
+		Species*,	// pointer to Species
+		int				// Landscape number (-999 to close the files)
+	);
+	void outDispStats( // Write dispersal statistics of the year (if due)
+		int,	// replicate
+		int		// year
+	);
 	// Open occupancy file, write header record and set up occupancy array
 	bool outOccupancyHeaders(
 		int		// option: -999 to close the file
@@ -188,6 +200,10 @@ public:
 		int,				// year
 		int					// generation
 	);
+	void sumTraits( // Sum trait genes of sub-communities and optionally of rows, in parallel
+		std::vector < std::vector <traitsums> >&,	// sums for each population of each sub-community
+		std::vector <traitsums>&	// sums for each row (Y cell co-ordinate), or empty if not required
+	);
 	void writeTraitsRows( // Write records to trait rows file
 		Species*,	// pointer to Species
 		int,			// replicate
@@ -206,11 +222,25 @@ public:
 #if RS_RCPP && !R_CMD
     Rcpp::IntegerMatrix addYearToPopList(int,int);
 #endif
+	void memory( // Add the memory held by the sub-communities and occupancy counts to a census
+		memUsage&
+	);
 
 private:
+	void addOccupancy( // Count a sub-community as occupied in a row of the occupancy matrix
+		size_t	// index = row * no. of sub-communities + sub-community
+	);
+	int getOccupancy( // No. of replicates in which a sub-community was occupied in a row
+		size_t	// index (as above)
+	);
+
 	Landscape *pLandscape;
 	int indIx;				// index used to apply initial individuals
-	float **occSuit;	// occupancy of suitable cells / patches
+	int occRows;			// no. of rows = (no. of years / interval) + 1
+	int occCols;			// no. of sub-communities (incl. the matrix)
+	short occBytes;		// bytes per count: 1, 2 or 4, the least which holds the no. of replicates
+	std::vector <unsigned char> occupancy;	// counts by row and sub-community
+	std::vector <float> occSuit;	// occupancy of suitable cells / patches by row and replicate
 	std::vector <SubCommunity*> subComms;
 
 };
@@ -0,0 +1,213 @@
+/*----------------------------------------------------------------------------
+ *	
+ *	Copyright (C) 2020 Greta Bocedi, Stephen C.F. Palmer, Justin M.J. Travis, Anne-Kathleen Malchow, Damaris Zurell 
+ *	
+ *	This file is part of RangeShifter.
+ *	
+ *	RangeShifter is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *	
+ *	RangeShifter is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *	GNU General Public License for more details.
+ *	
+ *	You should have received a copy of the GNU General Public License
+ *	along with RangeShifter. If not, see <https://www.gnu.org/licenses/>.
+ *	
+ --------------------------------------------------------------------------*/
+ 
+ 
+//---------------------------------------------------------------------------
+
+#include "DispersalStats.h"
+//---------------------------------------------------------------------------
+
+DispersalStats dispStats;
+
+outTable outDispStats;
+outTable outDispHist;
+
+//---------------------------------------------------------------------------
+
+DispersalStats::DispersalStats(void) {
+	interval = 0; resol = 1.0;
+	patchModel = moveModel = stageStruct = sexual = false;
+	spNum = 0;
+}
+
+DispersalStats::~DispersalStats(void) { }
+
+bool DispersalStats::outHeaders(Landscape* pLandscape, Species* pSpecies, const int landNr,
+	const int intvl)
+{
+	if (landNr == -999) { // close files
+		if (outDispStats.is_open()) outDispStats.close();
+		if (outDispHist.is_open()) outDispHist.close();
+		interval = 0;
+		accums.clear();
+		return true;
+	}
+
+	string name;
+	simParams sim = paramsSim->getSim();
+	landParams ppLand = pLandscape->getLandParams();
+	demogrParams dem = pSpecies->getDemogr();
+	trfrRules trfr = pSpecies->getTrfr();
+
+	interval = intvl;
+	resol = (float)ppLand.resol;
+	patchModel = ppLand.patchModel;
+	moveModel = trfr.moveModel;
+	stageStruct = dem.stageStruct;
+	sexual = dem.repType != 0;
+	spNum = pSpecies->getSpNum();
+	accums.clear();
+
+	if (sim.batchMode) {
+		name = paramsSim->getDir(2)
+			+ "Batch" + Int2Str(sim.batchNum) + "_"
+			+ "Sim" + Int2Str(sim.simulation) + "_Land" + Int2Str(landNr);
+	}
+	else {
+		name = paramsSim->getDir(2) + "Sim" + Int2Str(sim.simulation);
+	}
+
+	// column types must match the types of the values written by outStats()
+	outDispStats.open(name + "_DispStats", false, OUTNOCOMP, true);
+	outDispStats.column("Rep", 'i'); outDispStats.column("Year", 'i');
+	outDispStats.column("Species", 'h');
+	if (stageStruct) outDispStats.column("Stage", 'h');
+	if (sexual) outDispStats.column("Sex", 'h');
+	outDispStats.column("Status", 'h'); outDispStats.column("NInds", 'i');
+	outDispStats.column("NDist", 'i');
+	outDispStats.column("DistMean", 'd'); outDispStats.column("DistSD", 'd');
+	outDispStats.column("DistMin", 'd'); outDispStats.column("DistMax", 'd');
+	if (moveModel) {
+		outDispStats.column("StepsMean", 'd'); outDispStats.column("StepsSD", 'd');
+		outDispStats.column("StepsMin", 'd'); outDispStats.column("StepsMax", 'd');
+	}
+	if (patchModel) {
+		outDispStats.column("NPatchDist", 'i');
+		outDispStats.column("PatchDistMean", 'd'); outDispStats.column("PatchDistSD", 'd');
+		outDispStats.column("PatchDistMin", 'd'); outDispStats.column("PatchDistMax", 'd');
+	}
+	outDispStats.endHeader();
+
+	outDispHist.open(name + "_DispHist", false, OUTNOCOMP, true);
+	outDispHist.column("Rep", 'i'); outDispHist.column("Year", 'i');
+	outDispHist.column("Species", 'h');
+	if (stageStruct) outDispHist.column("Stage", 'h');
+	if (sexual) outDispHist.column("Sex", 'h');
+	outDispHist.column("Status", 'h');
+	outDispHist.column("DistFrom", 'f'); outDispHist.column("DistTo", 'f');
+	outDispHist.column("NInds", 'i');
+	outDispHist.endHeader();
+
+	return outDispStats.is_open() && outDispHist.is_open();
+}
+
+bool DispersalStats::active(void) { return interval > 0; }
+
+void DispersalStats::add(dispMoments& m, const double x) {
+	if (m.n == 0) m.min = m.max = x;
+	else {
+		if (x < m.min) m.min = x;
+		if (x > m.max) m.max = x;
+	}
+	m.n++;
+	double delta = x - m.mean;
+	m.mean += delta / (double)m.n;
+	m.m2 += delta * (x - m.mean);
+}
+
+void DispersalStats::record(Individual* pInd) {
+	indStats ind = pInd->getStats();
+	int key = (ind.stage * NSEXES + ind.sex) * 10 + ind.status;
+	std::map <int, dispAccum>::iterator it = accums.find(key);
+	if (it == accums.end()) {
+		dispAccum a;
+		a.ninds = 0;
+		a.dist.n = a.steps.n = a.patchDist.n = 0;
+		a.dist.mean = a.dist.m2 = a.steps.mean = a.steps.m2 = 0.0;
+		a.patchDist.mean = a.patchDist.m2 = 0.0;
+		a.dist.min = a.dist.max = a.steps.min = a.steps.max = 0.0;
+		a.patchDist.min = a.patchDist.max = 0.0;
+		it = accums.insert(std::make_pair(key, a)).first;
+	}
+	dispAccum& a = it->second;
+	a.ninds++;
+
+	Cell* pNatalCell = pInd->getLocn(0);
+	Cell* pCell = pInd->getLocn(1);
+	if (pNatalCell != 0 && pCell != 0) { // not beyond the boundary or in a no-data cell
+		locn natalloc = pNatalCell->getLocn();
+		locn loc = pCell->getLocn();
+		double dx = (double)(natalloc.x - loc.x), dy = (double)(natalloc.y - loc.y);
+		double d = sqrt(dx * dx + dy * dy);
+		add(a.dist, resol * d);
+		int bin = (int)d;
+		if (bin >= (int)a.hist.size()) a.hist.resize(bin + 1, 0);
+		a.hist[bin]++;
+		if (patchModel && (ind.status == 4 || ind.status == 5)) {
+			Patch* pNatalPatch = pInd->getNatalPatch();
+			intptr patch = pCell->getPatch();
+			if (pNatalPatch != 0 && patch != 0) {
+				patchLimits p0 = pNatalPatch->getLimits();
+				patchLimits p1 = ((Patch*)patch)->getLimits();
+				dx = 0.5 * (double)(p0.xMin + p0.xMax - p1.xMin - p1.xMax);
+				dy = 0.5 * (double)(p0.yMin + p0.yMax - p1.yMin - p1.yMax);
+				add(a.patchDist, resol * sqrt(dx * dx + dy * dy));
+			}
+		}
+	}
+	if (moveModel) {
+		pathSteps steps = pInd->getSteps();
+		add(a.steps, (double)steps.total);
+	}
+}
+
+// Mean, SD (zero unless there are at least two values), minimum and maximum
+void DispersalStats::writeMoments(const dispMoments& m) {
+	double sd;
+	if (m.n > 1) sd = m.m2 / (double)m.n; else sd = 0.0;
+	if (sd > 0.0) sd = sqrt(sd); else sd = 0.0;
+	outDispStats << m.mean << sd << m.min << m.max;
+}
+
+void DispersalStats::outStats(const int rep, const int yr) {
+	if (interval <= 0) return;
+	if (yr % interval == 0) {
+		std::map <int, dispAccum>::iterator it;
+		for (it = accums.begin(); it != accums.end(); it++) {
+			short status = (short)(it->first % 10);
+			short sex = (short)((it->first / 10) % NSEXES);
+			short stage = (short)(it->first / 10 / NSEXES);
+			const dispAccum& a = it->second;
+			outDispStats << rep << yr << spNum;
+			if (stageStruct) outDispStats << stage;
+			if (sexual) outDispStats << sex;
+			outDispStats << status << a.ninds << a.dist.n;
+			writeMoments(a.dist);
+			if (moveModel) writeMoments(a.steps);
+			if (patchModel) {
+				outDispStats << a.patchDist.n;
+				writeMoments(a.patchDist);
+			}
+			outDispStats.endRow();
+			for (int i = 0; i < (int)a.hist.size(); i++) {
+				if (a.hist[i] == 0) continue;
+				outDispHist << rep << yr << spNum;
+				if (stageStruct) outDispHist << stage;
+				if (sexual) outDispHist << sex;
+				outDispHist << status << resol * (float)i << resol * (float)(i + 1) << a.hist[i];
+				outDispHist.endRow();
+			}
+		}
+	}
+	accums.clear();
+}
+
+//---------------------------------------------------------------------------
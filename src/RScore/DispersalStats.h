@@ -0,0 +1,120 @@
+/*----------------------------------------------------------------------------
+ *	
+ *	Copyright (C) 2020 Greta Bocedi, Stephen C.F. Palmer, Justin M.J. Travis, Anne-Kathleen Malchow, Damaris Zurell 
+ *	
+ *	This file is part of RangeShifter.
+ *	
+ *	RangeShifter is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *	
+ *	RangeShifter is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *	GNU General Public License for more details.
+ *	
+ *	You should have received a copy of the GNU General Public License
+ *	along with RangeShifter. If not, see <https://www.gnu.org/licenses/>.
+ *	
+ --------------------------------------------------------------------------*/
+ 
+ 
+/*------------------------------------------------------------------------------
+
+RangeShifter v2.0 DispersalStats
+
+Implements the DispersalStats class
+
+Summary statistics of dispersal, accumulated while the simulation runs, as a compact
+alternative to writing every individual to the individuals file in order to derive
+them. The outcome of each dispersal event is recorded for every individual which
+settles (in SubCommunity::completeDispersal()) and, once the event is complete, for
+every individual which has not settled (i.e. which is waiting to continue, or has
+died or been lost during transfer). Outcomes are grouped by stage, sex and status
+code (as in the individuals file), and for each group are accumulated the moments
+of the distance between the natal and current cells, of the total no. of steps
+taken (for a movement model) and, in a patch-based model, of the distance between
+the centres of the natal and settlement patches, together with a histogram of the
+distance moved in bins of the landscape resolution. Means and SDs are updated as
+each outcome is recorded (by Welford's method, so that the SD of nearly equal
+values is not lost to rounding).
+
+The statistics of each year are written at the end of the year to a summary file
+(_DispStats), with one row per group, and to a histogram file (_DispHist), with one
+row per non-empty distance bin of each group.
+
+For full details of RangeShifter, please see:
+Bocedi G., Palmer S.C.F., Peer G., Heikkinen R.K., Matsinos Y.G., Watts K.
+and Travis J.M.J. (2014). RangeShifter: a platform for modelling spatial
+eco-evolutionary dynamics and species responses to environmental changes.
+Methods in Ecology and Evolution, 5, 388-396. doi: 10.1111/2041-210X.12162
+
+------------------------------------------------------------------------------*/
+
+#ifndef DispersalStatsH
+#define DispersalStatsH
+
+#include <map>
+#include <vector>
+using namespace std;
+
+#include "Parameters.h"
+#include "Species.h"
+#include "Landscape.h"
+#include "Patch.h"
+#include "Cell.h"
+#include "Individual.h"
+#include "OutputTable.h"
+
+//---------------------------------------------------------------------------
+
+struct dispMoments { // running moments of a dispersal measure (updated by Welford's method)
+	int n; double mean, m2, min, max;
+};
+
+struct dispAccum { // statistics of one stage, sex and status
+	int ninds;
+	dispMoments dist;			// distance moved (m)
+	dispMoments steps;		// total steps taken
+	dispMoments patchDist;	// distance between natal and settlement patches (m)
+	std::vector <int> hist;	// no. of individuals by distance moved (bins of resolution)
+};
+
+class DispersalStats {
+public:
+	DispersalStats(void);
+	~DispersalStats(void);
+	bool outHeaders( // Open the statistics files and write header records
+		Landscape*,	// pointer to Landscape
+		Species*,		// pointer to Species
+		const int,	// landscape number (-999 to close the files)
+		const int		// interval (years) at which statistics are written
+	);
+	bool active(void); // Are dispersal outcomes to be recorded?
+	void record( // Record the outcome of dispersal of an individual
+		Individual*
+	);
+	void outStats( // Write the statistics of the year, if due, and begin the next year
+		const int,	// replicate
+		const int		// year
+	);
+
+private:
+	void add(dispMoments&, const double);
+	void writeMoments(const dispMoments&);
+
+	int interval;
+	float resol;
+	bool patchModel, moveModel, stageStruct, sexual;
+	short spNum;
+	std::map <int, dispAccum> accums;	// keyed by stage, sex and status
+
+};
+
+extern DispersalStats dispStats;
+
+extern paramSim *paramsSim;
+
+//---------------------------------------------------------------------------
+#endif
@@ -22,7 +22,8 @@
 #include "Genome.h"
 //---------------------------------------------------------------------------
 
-ofstream outGenetic;
+outTable outGenetic;
+outGenMatrix outGenMat;
 
 //---------------------------------------------------------------------------
 
@@ -148,6 +149,11 @@ void Chromosome::inherit(const Chromosome* parentChr, const short posn, const sh
 }
 
 
+void Chromosome::memory(memUsage& m) {
+	m.objects[MEMGENOMES]++;
+	m.bytes[MEMGENOMES] += sizeof(Chromosome) + nloci * sizeof(locus);
+}
+
 //---------------------------------------------------------------------------
 
 // NB THIS FUNCTION IS CURRENTLY NOT BEING CALLED TO CONSTRUCT AN INSTANCE OF Genome
@@ -232,81 +238,116 @@ void Genome::inherit(const Genome* parent, const short posn, const short chr,
 
 }
 
-void Genome::outGenHeaders(const int rep, const int landNr, const bool xtab)
+void Genome::outGenHeaders(const int rep, const int landNr, const short form)
 {
 
 	if (landNr == -999) { // close file
-		if (outGenetic.is_open()) {
-			outGenetic.close(); outGenetic.clear();
-		}
+		if (outGenetic.is_open()) outGenetic.close();
+		if (outGenMat.is_open()) outGenMat.close();
 		return;
 	}
 
 	string name;
 	simParams sim = paramsSim->getSim();
+	simEngine eng = paramsSim->getEngine();
 
 	if (sim.batchMode) {
 		name = paramsSim->getDir(2)
 			+ "Batch" + Int2Str(sim.batchNum) + "_"
 			+ "Sim" + Int2Str(sim.simulation)
-			+ "_Land" + Int2Str(landNr) + "_Rep" + Int2Str(rep) + "_Genetics.txt";
+			+ "_Land" + Int2Str(landNr) + "_Rep" + Int2Str(rep) + "_Genetics";
 	}
 	else {
 		name = paramsSim->getDir(2) + "Sim" + Int2Str(sim.simulation)
-			+ "_Rep" + Int2Str(rep) + "_Genetics.txt";
+			+ "_Rep" + Int2Str(rep) + "_Genetics";
 	}
-	outGenetic.open(name.c_str());
 
-	outGenetic << "Rep\tYear\tSpecies\tIndID";
-	if (xtab) {
+	if (form == 2) { // packed allele matrix
+		std::vector <int> nloci;
+		for (int i = 0; i < nChromosomes; i++) nloci.push_back(pChromosome[i]->nLoci());
+		outGenMat.open(name, nloci, diploid, eng.compGenetics);
+		return;
+	}
+
+	outGenetic.open(name, eng.outFormat == 1, eng.compGenetics);
+
+	// column types must match the types of the values written by outGenetics()
+	outGenetic.column("Rep", 'i'); outGenetic.column("Year", 'i');
+	outGenetic.column("Species", 'i'); outGenetic.column("IndID", 'i');
+	if (form == 1) {
 		for (int i = 0; i < nChromosomes; i++) {
 			int nloci = pChromosome[i]->nLoci();
 			for (int j = 0; j < nloci; j++) {
-				outGenetic << "\tChr" << i << "Loc" << j << "Allele0";
-				if (diploid) outGenetic << "\tChr" << i << "Loc" << j << "Allele1";
+				outGenetic.column("Chr" + Int2Str(i) + "Loc" + Int2Str(j) + "Allele0", 'h');
+				if (diploid) outGenetic.column("Chr" + Int2Str(i) + "Loc" + Int2Str(j) + "Allele1", 'h');
 			}
 		}
-		outGenetic << endl;
 	}
 	else {
-		outGenetic << "\tChromosome\tLocus\tAllele0";
-		if (diploid) outGenetic << "\tAllele1";
-		outGenetic << endl;
+		outGenetic.column("Chromosome", 'i'); outGenetic.column("Locus", 'i');
+		outGenetic.column("Allele0", 'h');
+		if (diploid) outGenetic.column("Allele1", 'h');
 	}
+	outGenetic.endHeader();
 
 }
 
 void Genome::outGenetics(const int rep, const int year, const int spnum,
-	const int indID, const bool xtab)
+	const int indID, const short form)
 {
 	locus l;
-	if (xtab) {
-		outGenetic << rep << "\t" << year << "\t" << spnum << "\t" << indID;
+	if (form == 2) {
+		std::vector <short> alleles;
+		alleleValues(alleles);
+		outGenMat.add(rep, year, spnum, indID, alleles);
+		return;
+	}
+	if (form == 1) {
+		outGenetic << rep << year << spnum << indID;
 		for (int i = 0; i < nChromosomes; i++) {
 			int nloci = pChromosome[i]->nLoci();
 			for (int j = 0; j < nloci; j++) {
 				l = pChromosome[i]->alleles(j);
-				outGenetic << "\t" << l.allele[0];
-				if (diploid) outGenetic << "\t" << l.allele[1];
+				outGenetic << l.allele[0];
+				if (diploid) outGenetic << l.allele[1];
 			}
 		}
-		outGenetic << endl;
+		outGenetic.endRow();
 	}
 	else {
 		for (int i = 0; i < nChromosomes; i++) {
 			int nloci = pChromosome[i]->nLoci();
 			for (int j = 0; j < nloci; j++) {
-				outGenetic << rep << "\t" << year << "\t" << spnum << "\t"
-					<< indID << "\t" << i << "\t" << j;
+				outGenetic << rep << year << spnum << indID << i << j;
 				l = pChromosome[i]->alleles(j);
-				outGenetic << "\t" << l.allele[0];
-				if (diploid) outGenetic << "\t" << l.allele[1];
-				outGenetic << endl;
+				outGenetic << l.allele[0];
+				if (diploid) outGenetic << l.allele[1];
+				outGenetic.endRow();
 			}
 		}
 	}
 }
 
+void Genome::alleleValues(std::vector <short>& values) {
+	locus l;
+	for (int i = 0; i < nChromosomes; i++) {
+		int nloci = pChromosome[i]->nLoci();
+		for (int j = 0; j < nloci; j++) {
+			l = pChromosome[i]->alleles(j);
+			values.push_back(l.allele[0]);
+			if (diploid) values.push_back(l.allele[1]);
+		}
+	}
+}
+
+void Genome::memory(memUsage& m) {
+	m.objects[MEMGENOMES]++;
+	m.bytes[MEMGENOMES] += sizeof(Genome);
+	if (pChromosome == NULL) return;
+	m.bytes[MEMGENOMES] += nChromosomes * sizeof(Chromosome*);
+	for (int i = 0; i < nChromosomes; i++) pChromosome[i]->memory(m);
+}
+
 //---------------------------------------------------------------------------
 
 // Set up new gene at initialisation for 1 chromosome per trait
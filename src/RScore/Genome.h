@@ -26,6 +26,8 @@
 #include <algorithm>
 
 #include "Parameters.h"
+#include "OutputTable.h"
+#include "MemoryAccount.h"
 #include "Species.h"
 
 #define INTBASE 100.0; // to convert integer alleles into continuous traits
@@ -73,6 +75,9 @@ public:
 		const double,				// s.d. of mutation magnitude (genetic scale)
 		const bool					// diploid
 	);
+	void memory( // Add the memory held by the chromosome to a census
+		memUsage&
+	);
 
 protected:
 
@@ -138,14 +143,20 @@ public:
 	void outGenHeaders(
 		const int,	// replicate
 		const int,	// landscape number
-		const bool	// output as cross table?
+		const short	// form of output (see simParams)
 	);
 	void outGenetics(
 		const int,	// replicate
 		const int,	// year
 		const int,	// species number
 		const int, 	// individual ID
-		const bool 	// output as cross table?
+		const short	// form of output (see simParams)
+	);
+	void alleleValues( // Append all allele values, in the column order of the cross table
+		std::vector <short>&
+	);
+	void memory( // Add the memory held by the genome and its chromosomes to a census
+		memUsage&
 	);
 
 
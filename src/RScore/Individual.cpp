@@ -26,6 +26,8 @@
 //---------------------------------------------------------------------------
 
 int Individual::indCounter = 0;
+Individual::trfrStep Individual::trfrStepFn = 0;
+KernelSampler* Individual::kernSampler = 0;
 
 //---------------------------------------------------------------------------
 
@@ -35,6 +37,7 @@ Individual::Individual(Cell* pCell, Patch* pPatch, short stg, short a, short rep
 {
 	indId = indCounter;
 	indCounter++; // unique identifier for each individual
+	countEvent(EVINDNEW);
 
 	stage = stg;
 	if (probmale <= 0.0) sex = 0;
@@ -66,6 +69,8 @@ Individual::Individual(Cell* pCell, Patch* pPatch, short stg, short a, short rep
 			smsData->prev.y = loc.y; // previous location
 			smsData->goal.x = loc.x; 
 			smsData->goal.y = loc.y; // goal location - initialised for dispersal bias
+			smsData->dpWts = smsData->dpInflWts = calcSMSWeights(1.0);
+			smsData->memFirst = smsData->memCount = 0;
 		}
 		else smsData = 0;
 		if (moveType == 2) { // CRW
@@ -88,6 +93,7 @@ Individual::Individual(Cell* pCell, Patch* pPatch, short stg, short a, short rep
 }
 
 Individual::~Individual(void) {
+	countEvent(EVINDDELETE);
 	if (path != 0) delete path;
 	if (crw != 0) delete crw;
 	if (smsData != 0) delete smsData;
@@ -691,6 +697,8 @@ void Individual::setSMSTraits(Species* pSpecies, short SMSgenelocn, short nSMStr
 	if (smsData->gb < 1.0) smsData->gb = 1.0;
 	if (smsData->alphaDB <= 0.0) smsData->alphaDB = 0.000001f;
 	if (smsData->betaDB < 1) smsData->betaDB = 1;
+	smsData->dpWts = calcSMSWeights(smsData->dp);
+	smsData->dpInflWts = calcSMSWeights(10.0f * smsData->dp);
 	return;
 }
 
@@ -864,8 +872,8 @@ void Individual::moveto(Cell* newCell) {
 // Move to a new cell by sampling a dispersal distance from a single or double
 // negative exponential kernel
 // Returns 1 if still dispersing (including having found a potential patch), otherwise 0
-int Individual::moveKernel(Landscape* pLandscape, Species* pSpecies,
-	const short repType, const bool absorbing)
+template <const bool Absorbing, const bool IndVar>
+int Individual::moveKernel(Landscape* pLandscape, Species* pSpecies, const short /*landIx*/)
 {
 
 	intptr patch;
@@ -888,7 +896,7 @@ int Individual::moveKernel(Landscape* pLandscape, Species* pSpecies,
 	pCell = NULL;
 	pPatch = NULL;
 
-	if (trfr.indVar) { // get individual's kernel parameters
+	if constexpr (IndVar) { // get individual's kernel parameters
 		kern.meanDist1 = kern.meanDist2 = kern.probKern1 = 0.0;
 		if (pGenome != 0) {
 			kern.meanDist1 = kerntraits->meanDist1;
@@ -967,7 +975,7 @@ int Individual::moveKernel(Landscape* pLandscape, Species* pSpecies,
 #endif
 				loopsteps++;
 			} while (loopsteps < 1000 &&
-				((!absorbing && (newX < land.minX || newX > land.maxX
+				((!Absorbing && (newX < land.minX || newX > land.maxX
 					|| newY < land.minY || newY > land.maxY))
 					|| (!usefullkernel && newX == loc.x && newY == loc.y))
 				);
@@ -1001,8 +1009,10 @@ int Individual::moveKernel(Landscape* pLandscape, Species* pSpecies,
 				patch = 0;
 				patchNum = -1;
 			}
-		} while (!absorbing && patchNum < 0 && loopsteps < 1000); 			 // in a no-data region
+		} while (!Absorbing && patchNum < 0 && loopsteps < 1000); 			 // in a no-data region
 	} while (!usefullkernel && pPatch == pNatalPatch && loopsteps < 1000); 	// still in the original (natal) patch
+	countEvent(EVKERNELDRAW);
+	countEvent(EVKERNELRETRY, loopsteps - 1);
 
 	if (loopsteps < 1000) {
 		if (pCell == 0) { // beyond absorbing boundary or in no-data cell
@@ -1058,11 +1068,143 @@ int Individual::moveKernel(Landscape* pLandscape, Species* pSpecies,
 	return dispersing;
 }
 
+//---------------------------------------------------------------------------
+// Move to a new cell drawn directly from the tabulated destinations of a species-level
+// single or double negative exponential kernel (see KernelSampler), which follow the
+// same distribution as those found by moveKernel(), but at a fixed cost
+// Returns 1 if still dispersing (including having found a potential patch), otherwise 0
+int Individual::sampleKernel(Landscape* pLandscape, Species* pSpecies, const short /*landIx*/)
+{
+
+	int dispersing = 1;
+	int ix;
+	short fate;
+	bool dies;
+	double meandist, r;
+	float localK;
+	trfrKernTraits kern;
+	Cell* pCell;
+	Patch* pPatch;
+
+	landData land = pLandscape->getLandData();
+
+	trfrRules trfr = pSpecies->getTrfr();
+	settleRules sett = pSpecies->getSettRules(stage, sex);
+	short stg = 0, sx = 0;
+	if (trfr.stgDep) stg = stage;
+	if (trfr.sexDep) sx = sex;
+
+	// as in moveKernel(), the individual disperses from any cell of its natal patch
+	// while it is still in its natal cell, but otherwise from its current cell
+	if (status == 1 && pNatalPatch->getNCells() > 0) pCell = 0;
+	else pCell = pCurrCell;
+
+	// from its natal patch, the outcome may be drawn from the patch's alias table, in
+	// which any twin kernels and dispersal mortality are already combined
+	const kernAlias* ka = 0;
+	if (pCell == 0) ka = kernSampler->getAlias(pNatalPatch, stg, sx);
+	if (ka != 0) {
+		int noutcomes = (int)ka->outcomes.size();
+		r = pRandom->Random() * (double)noutcomes;
+		ix = (int)r;
+		if (ix >= noutcomes) ix = noutcomes - 1;
+		if (r - (double)ix >= ka->prob[ix]) ix = ka->alias[ix];
+		fate = ka->outcomes[ix].fate;
+		pCell = ka->outcomes[ix].pCell;
+		dies = ka->outcomes[ix].dies;
+	}
+	else {
+		// get kernel parameters for the species
+		kern = pSpecies->getKernTraits(stg, sx);
+
+		// scale the appropriate kernel mean to the cell size
+		if (trfr.twinKern)
+		{
+			if (pRandom->Bernoulli(kern.probKern1))
+				meandist = kern.meanDist1 / (float)land.resol;
+			else
+				meandist = kern.meanDist2 / (float)land.resol;
+		}
+		else
+			meandist = kern.meanDist1 / (float)land.resol;
+
+		// scaled mean may not be less than 1 unless emigration derives from the kernel
+		// (i.e. the 'use full kernel' option is applied)
+		if (!pSpecies->useFullKernel() && meandist < 1.0) meandist = 1.0;
+
+		const kernDestns* dd = kernSampler->getDestns(meandist, pNatalPatch, pCell);
+		double dispmort;
+		r = pRandom->Random();
+		if (r < dd->pLost) { // beyond absorbing boundary or in no-data cell
+			fate = 1; dispmort = dd->mortLost;
+		}
+		else {
+			if (r < dd->pLost + dd->pFail || dd->cells.empty()) { // no destination found
+				fate = 2; dispmort = dd->mortFail;
+			}
+			else {
+				ix = (int)(std::upper_bound(dd->cumProb.begin(), dd->cumProb.end(), r)
+					- dd->cumProb.begin());
+				if (ix >= (int)dd->cells.size()) ix = (int)dd->cells.size() - 1;
+				fate = 0; pCell = dd->cells[ix]; dispmort = dd->mort[ix];
+			}
+		}
+		// apply dispersal-related mortality, which may be distance-dependent (in which
+		// case the table holds the mean mortality of each outcome)
+		dies = pRandom->Bernoulli(dispmort);
+	}
+#if RSDEBUG
+	if (path != 0) (path->year)++;
+#endif
+
+	switch (fate) {
+	case 1: // beyond absorbing boundary or in no-data cell
+		pCurrCell = 0;
+		status = 6;
+		dispersing = 0;
+		break;
+	case 2: // no destination found
+		status = 6;
+		dispersing = 0;
+		break;
+	default:
+		pCurrCell = pCell;
+		pPatch = (Patch*)pCurrCell->getPatch();
+		if (pPatch == 0) localK = 0.0; // matrix
+		else localK = pPatch->getK();
+		if (pPatch != 0 && pPatch->getPatchNum() > 0 && localK > 0.0) { // found a new patch
+			status = 2; // record as potential settler
+		}
+		else {
+			dispersing = 0;
+			// can wait in matrix if population is stage structured ...
+			if (pSpecies->stageStructured()) {
+				// ... and wait option is applied ...
+				if (sett.wait) { // ... it is
+					status = 3; // waiting
+				}
+				else // ... it is not
+					status = 6; // dies (unless there is a suitable neighbouring cell)
+			}
+			else
+				status = 6; // dies (unless there is a suitable neighbouring cell)
+		}
+	}
+
+	if (dies) {
+		status = 7; // dies
+		dispersing = 0;
+	}
+
+	return dispersing;
+}
+
 //---------------------------------------------------------------------------
 // Make a single movement step according to a mechanistic movement model
 // Returns 1 if still dispersing (including having found a potential patch), otherwise 0
-int Individual::moveStep(Landscape* pLandscape, Species* pSpecies,
-	const short landIx, const bool absorbing)
+template <const short MoveType, const bool Absorbing, const bool IndVar,
+	const bool HabMort, const bool DispBias>
+int Individual::moveStep(Landscape* pLandscape, Species* pSpecies, const short landIx)
 {
 
 	if (status != 1) return 0; // not currently dispersing
@@ -1082,7 +1224,6 @@ int Individual::moveStep(Landscape* pLandscape, Species* pSpecies,
 	landData land = pLandscape->getLandData();
 	simParams sim = paramsSim->getSim();
 
-	trfrRules trfr = pSpecies->getTrfr();
 	trfrCRWTraits movt = pSpecies->getCRWTraits();
 	settleSteps settsteps = pSpecies->getSteps(stage, sex);
 
@@ -1097,7 +1238,7 @@ int Individual::moveStep(Landscape* pLandscape, Species* pSpecies,
 		patchNum = pPatch->getPatchNum();
 	}
 	// apply step-dependent mortality risk ...
-	if (trfr.habMort)
+	if constexpr (HabMort)
 	{ // habitat-dependent
 		int h = pCurrCell->getHabIndex(landIx);
 		if (h < 0) { // no-data cell - should not occur, but if it does, individual dies
@@ -1115,6 +1256,8 @@ int Individual::moveStep(Landscape* pLandscape, Species* pSpecies,
 		dispersing = 0;
 	}
 	else { // take a step
+		if (path->year == 0) countEvent(EVMOVEINDS);
+		countEvent(EVMOVESTEPS);
 		(path->year)++;
 		(path->total)++;
 		if (patch == 0 || pPatch == 0 || patchNum == 0) { // not in a patch
@@ -1125,10 +1268,9 @@ int Individual::moveStep(Landscape* pLandscape, Species* pSpecies,
 		newX = loc.x; newY = loc.y;
 
 
-		switch (trfr.moveType) {
-
-		case 1: // SMS
-			move = smsMove(pLandscape, pSpecies, landIx, pPatch == pNatalPatch, trfr.indVar, absorbing);
+		if constexpr (MoveType == 1) { // SMS
+			move = smsMove<Absorbing, IndVar, DispBias>(pLandscape, pSpecies, landIx,
+				pPatch == pNatalPatch);
 			if (move.dist < 0.0) {
 				// either INTERNAL ERROR CONDITION - INDIVIDUAL IS IN NO-DATA SQUARE
 				// or individual has crossed absorbing boundary ...
@@ -1151,10 +1293,9 @@ int Individual::moveStep(Landscape* pLandscape, Species* pSpecies,
 					pCurrCell->incrVisits();
 				}
 			}
-			break;
-
-		case 2: // CRW
-			if (trfr.indVar) {
+		}
+		else { // CRW
+			if constexpr (IndVar) {
 				if (crw != 0) {
 					movt.stepLength = crw->stepL;
 					movt.rho = crw->rho;
@@ -1190,7 +1331,7 @@ int Individual::moveStep(Landscape* pLandscape, Species* pSpecies,
 					if (xcnew < 0.0) newX = -1; else newX = (int)xcnew;
 					if (ycnew < 0.0) newY = -1; else newY = (int)ycnew;
 					loopsteps++;
-				} while (!absorbing && loopsteps < 1000 &&
+				} while (!Absorbing && loopsteps < 1000 &&
 					(newX < land.minX || newX > land.maxX || newY < land.minY || newY > land.maxY));
 				if (newX < land.minX || newX > land.maxX || newY < land.minY || newY > land.maxY)
 					pCurrCell = 0;
@@ -1198,11 +1339,11 @@ int Individual::moveStep(Landscape* pLandscape, Species* pSpecies,
 					pCurrCell = pLandscape->findCell(newX, newY);
 				if (pCurrCell == 0) { // no-data cell or beyond absorbing boundary
 					patch = 0;
-					if (absorbing) absorbed = true;
+					if (Absorbing) absorbed = true;
 				}
 				else
 					patch = pCurrCell->getPatch();
-			} while (!absorbing && pCurrCell == 0 && loopsteps < 1000);
+			} while (!Absorbing && pCurrCell == 0 && loopsteps < 1000);
 			crw->prevdrn = (float)angle;
 			crw->xc = (float)xcnew; crw->yc = (float)ycnew;
 			if (absorbed) { // beyond absorbing boundary or in no-data square
@@ -1221,9 +1362,7 @@ int Individual::moveStep(Landscape* pLandscape, Species* pSpecies,
 					pCurrCell = pPrevCell;
 				}
 			}
-			break;
-
-		} // end of switch (trfr.moveType)
+		} // end of CRW
 
 		if (patch > 0  // not no-data area or matrix
 			&& path->total >= settsteps.minSteps) {
@@ -1256,13 +1395,32 @@ int Individual::moveStep(Landscape* pLandscape, Species* pSpecies,
 
 // Functions to implement the SMS algorithm
 
+// No. of octants by which each neighbouring cell, indexed [x][y] by its position
+// relative to the current cell, lies away from each of the 8 directions of heading()
+static const int nbrOctants[8][3][3] = {
+	{ { 3, 2, 1 }, { 4, 0, 0 }, { 3, 2, 1 } },
+	{ { 4, 3, 2 }, { 3, 0, 1 }, { 2, 1, 0 } },
+	{ { 3, 4, 3 }, { 2, 0, 2 }, { 1, 0, 1 } },
+	{ { 2, 3, 4 }, { 1, 0, 3 }, { 0, 1, 2 } },
+	{ { 1, 2, 3 }, { 0, 0, 4 }, { 1, 2, 3 } },
+	{ { 0, 1, 2 }, { 1, 0, 3 }, { 2, 3, 4 } },
+	{ { 1, 0, 1 }, { 2, 0, 2 }, { 3, 4, 3 } },
+	{ { 2, 1, 0 }, { 3, 0, 1 }, { 4, 3, 2 } }
+};
+// Unit weightings, applied where there is no preferred direction
+static const smsWeights noWeights = { { 1.0, 1.0, 1.0, 1.0, 1.0 } };
+
 // Move to a neighbouring cell according to the SMS algorithm
+template <const bool Absorbing, const bool IndVar, const bool DispBias>
 movedata Individual::smsMove(Landscape* pLand, Species* pSpecies,
-	const short landIx, const bool natalPatch, const bool indvar, const bool absorbing)
+	const short landIx, const bool natalPatch)
 {
 
 	array3x3d nbr; 	// to hold weights/costs/probs of moving to neighbouring cells
-	array3x3d goal;	// to hold weights for moving towards a goal location
+	const smsWeights* dirWts;		// weightings for directional persistence
+	const smsWeights* goalWts;	// weightings for moving towards a goal location
+	smsWeights dbWts;						// weightings for dispersal bias
+	int dirOct, goalOct;				// directions of movement and of goal (see heading())
 	array3x3f hab;	// to hold weights for habitat (includes percep range)
 	int x2, y2; 			// x index from 0=W to 2=E, y index from 0=N to 2=S
 	int newX = 0, newY = 0;
@@ -1290,18 +1448,20 @@ movedata Individual::smsMove(Landscape* pLand, Species* pSpecies,
 		|| natalPatch
 		|| (movt.straigtenPath && path->settleStatus > 0)) {
 		// inflate directional persistence to promote leaving the patch
-		if (indvar) nbr = getSimDir(current.x, current.y, 10.0f * smsData->dp);
-		else nbr = getSimDir(current.x, current.y, 10.0f * movt.dp);
+		if constexpr (IndVar) dirWts = &smsData->dpInflWts;
+		else dirWts = pSpecies->getSMSWeights(1);
 	}
 	else {
-		if (indvar) nbr = getSimDir(current.x, current.y, smsData->dp);
-		else nbr = getSimDir(current.x, current.y, movt.dp);
+		if constexpr (IndVar) dirWts = &smsData->dpWts;
+		else dirWts = pSpecies->getSMSWeights(0);
 	}
+	dirOct = getSimDir(current.x, current.y);
+	if (dirOct < 0) { dirWts = &noWeights; dirOct = 0; }
 	if (natalPatch || path->settleStatus > 0) path->out = 0;
 
 	//get weights for goal bias....
-	double gb;
-	if (movt.goalType == 2) { // dispersal bias
+	if constexpr (DispBias) { // dispersal bias
+		double gb;
 		int nsteps = 0;
 		if (path->year == path->total) { // first year of dispersal - use no. of steps outside natal patch
 			nsteps = path->out;
@@ -1309,7 +1469,7 @@ movedata Individual::smsMove(Landscape* pLand, Species* pSpecies,
 		else { // use total no. of steps
 			nsteps = path->total;
 		}
-		if (indvar) {
+		if constexpr (IndVar) {
 			double exp_arg = -((double)nsteps - (double)smsData->betaDB) * (-smsData->alphaDB);
 			if (exp_arg > 100.0) exp_arg = 100.0; // to prevent exp() overflow error
 			gb = 1.0 + (smsData->gb - 1.0) / (1.0 + exp(exp_arg));
@@ -1319,9 +1479,12 @@ movedata Individual::smsMove(Landscape* pLand, Species* pSpecies,
 			if (exp_arg > 100.0) exp_arg = 100.0; // to prevent exp() overflow error
 			gb = 1.0 + (movt.gb - 1.0) / (1.0 + exp(exp_arg));
 		}
+		dbWts = calcSMSWeights((float)gb);
+		goalWts = &dbWts;
 	}
-	else gb = movt.gb;
-	goal = getGoalBias(current.x, current.y, movt.goalType, (float)gb);
+	else goalWts = pSpecies->getSMSWeights(2);
+	goalOct = getGoalBias(current.x, current.y, movt.goalType);
+	if (goalOct < 0) { goalWts = &noWeights; goalOct = 0; }
 
 	// get habitat-dependent weights (mean effective costs, given perceptual range)
 	// first check if costs have already been calculated
@@ -1330,11 +1493,13 @@ movedata Individual::smsMove(Landscape* pLand, Species* pSpecies,
 
 	if (hab.cell[0][0] < 0.0) { // costs have not already been calculated
 		hab = getHabMatrix(pLand, pSpecies, current.x, current.y, movt.pr, movt.prMethod,
-			landIx, absorbing);
+			landIx, Absorbing);
 		pCurrCell->setEffCosts(hab);
+		countEvent(EVHABCOMPUTED);
 	}
 	else {
 		// they have already been calculated - no action required
+		countEvent(EVHABREUSED);
 	}
 
 	// determine weighted effective cost for the 8 neighbours
@@ -1343,10 +1508,12 @@ movedata Individual::smsMove(Landscape* pLand, Species* pSpecies,
 		for (x2 = 0; x2 < 3; x2++) {
 			if (x2 == 1 && y2 == 1) nbr.cell[x2][y2] = 0.0;
 			else {
+				double dirwt = dirWts->wt[nbrOctants[dirOct][x2][y2]];
+				double goalwt = goalWts->wt[nbrOctants[goalOct][x2][y2]];
 				if (x2 == 1 || y2 == 1) //not diagonal
-					nbr.cell[x2][y2] = nbr.cell[x2][y2] * goal.cell[x2][y2] * hab.cell[x2][y2];
+					nbr.cell[x2][y2] = dirwt * goalwt * hab.cell[x2][y2];
 				else // diagonal
-					nbr.cell[x2][y2] = (float)SQRT2 * nbr.cell[x2][y2] * goal.cell[x2][y2] * hab.cell[x2][y2];
+					nbr.cell[x2][y2] = (float)SQRT2 * dirwt * goalwt * hab.cell[x2][y2];
 			}
 		}
 	}
@@ -1364,7 +1531,7 @@ movedata Individual::smsMove(Landscape* pLand, Species* pSpecies,
 
 	for (y2 = 2; y2 > -1; y2--) {
 		for (x2 = 0; x2 < 3; x2++) {
-			if (!absorbing) {
+			if constexpr (!Absorbing) {
 				if ((current.y + y2 - 1) < land.minY || (current.y + y2 - 1) > land.maxY
 					|| (current.x + x2 - 1) < land.minX || (current.x + x2 - 1) > land.maxX)
 					// cell is beyond current landscape limits
@@ -1421,7 +1588,7 @@ movedata Individual::smsMove(Landscape* pLand, Species* pSpecies,
 			}
 			loopsteps++;
 		} while (loopsteps < 1000
-			&& (!absorbing && (newX < land.minX || newX > land.maxX
+			&& (!Absorbing && (newX < land.minX || newX > land.maxX
 				|| newY < land.minY || newY > land.maxY)));
 		if (loopsteps >= 1000) pNewCell = 0;
 		else {
@@ -1431,7 +1598,7 @@ movedata Individual::smsMove(Landscape* pLand, Species* pSpecies,
 			}
 			pNewCell = pLand->findCell(newX, newY);
 		}
-	} while (!absorbing && pNewCell == 0 && loopsteps < 1000); // no-data cell
+	} while (!Absorbing && pNewCell == 0 && loopsteps < 1000); // no-data cell
 	if (loopsteps >= 1000 || pNewCell == 0) {
 		// unable to make a move or crossed absorbing boundary
 		// flag individual to die
@@ -1442,148 +1609,48 @@ movedata Individual::smsMove(Landscape* pLand, Species* pSpecies,
 		newcellcost = pNewCell->getCost();
 		move.cost = move.dist * 0.5f * ((float)cellcost + (float)newcellcost);
 		// make the selected move
-		if ((short)memory.size() == movt.memSize) {
-			memory.pop(); // remove oldest memory element
+		if (smsData->memCount == movt.memSize) { // remove oldest memory element
+			smsData->memFirst = (smsData->memFirst + 1) % MAXMEMSIZE;
+			smsData->memCount--;
 		}
-		memory.push(current); // record previous location in memory
+		// record previous location in memory
+		smsData->memory[(smsData->memFirst + smsData->memCount) % MAXMEMSIZE] = current;
+		smsData->memCount++;
 		pCurrCell = pNewCell;
 	}
 	return move;
 }
 
-// Weight neighbouring cells on basis of current movement direction
-array3x3d Individual::getSimDir(const int x, const int y, const float dp)
+// Get current movement direction for weighting neighbouring cells
+int Individual::getSimDir(const int x, const int y)
 {
-
-	array3x3d d;
 	locn prev;
-	double theta;
-	int xx, yy;
-
-	if (memory.empty())
-	{ // no previous movement, set matrix to unity
-		for (xx = 0; xx < 3; xx++) {
-			for (yy = 0; yy < 3; yy++) {
-				d.cell[xx][yy] = 1;
-			}
-		}
-	}
-	else { // set up the matrix dependent on relationship of previous location to current
-		d.cell[1][1] = 0;
-		prev = memory.front();
-		if ((x - prev.x) == 0 && (y - prev.y) == 0) {
-			// back to 'square 1' (first memory location) - use previous step drn only
-			prev = memory.back();
-			if ((x - prev.x) == 0 && (y - prev.y) == 0) { // STILL HAVE A PROBLEM!
-				for (xx = 0; xx < 3; xx++) {
-					for (yy = 0; yy < 3; yy++) {
-						d.cell[xx][yy] = 1.0;
-					}
-				}
-				return d;
-			}
-		}
-		else {
-		}
-		theta = atan2(((double)x - (double)prev.x), ((double)y - (double)prev.y));
-		d = calcWeightings(dp, (float)theta);
 
-	}
-	return d;
-}
+	if (smsData->memCount == 0) return -1; // no previous movement
 
-// Weight neighbouring cells on basis of goal bias
-array3x3d Individual::getGoalBias(const int x, const int y,
-	const int goaltype, const float gb)
-{
-
-	array3x3d d;
-	double theta;
-	int xx, yy;
-
-	if (goaltype == 0) { // no goal set
-		for (xx = 0; xx < 3; xx++) {
-			for (yy = 0; yy < 3; yy++) {
-				d.cell[xx][yy] = 1.0;
-			}
+	// direction depends on relationship of previous location to current
+	prev = smsData->memory[smsData->memFirst];
+	if ((x - prev.x) == 0 && (y - prev.y) == 0) {
+		// back to 'square 1' (first memory location) - use previous step drn only
+		prev = smsData->memory[(smsData->memFirst + smsData->memCount - 1) % MAXMEMSIZE];
+		if ((x - prev.x) == 0 && (y - prev.y) == 0) { // STILL HAVE A PROBLEM!
+			return -1;
 		}
 	}
-	else {
-		d.cell[1][1] = 0;
-		if ((x - smsData->goal.x) == 0 && (y - smsData->goal.y) == 0) {
-			// at goal, set matrix to unity
-			for (xx = 0; xx < 3; xx++) {
-				for (yy = 0; yy < 3; yy++) {
-					d.cell[xx][yy] = 1.0;
-				}
-			}
-			return d;
-		}
-		if (goaltype == 1) {
-			// TEMPORARY CODE - GOAL TYPE 1 NOT YET IMPLEMENTED, AS WE HAVE NO MEANS OF
-			// CAPTURING THE GOAL LOCATION OF EACH INDIVIDUAL
-			for (xx = 0; xx < 3; xx++) {
-				for (yy = 0; yy < 3; yy++) {
-					d.cell[xx][yy] = 1.0;
-				}
-			}
-			return d;
-		}
-		else // goaltype == 2
-			theta = atan2(((double)x - (double)smsData->goal.x), ((double)y - (double)smsData->goal.y));
-		d = calcWeightings(gb, (float)theta);
-	}
-
-	return d;
+	return heading(((double)x - (double)prev.x), ((double)y - (double)prev.y));
 }
 
-// Calculate weightings for neighbouring cells
-array3x3d Individual::calcWeightings(const double base, const double theta) {
-
-	array3x3d d; // 3x3 array indexed from SW corner by xx and yy
-	int dx, dy, xx, yy;
-
-	double i0 = 1.0; 					// direction of theta - lowest cost bias
-	double i1 = base;
-	double i2 = base * base;
-	double i3 = i2 * base;
-	double i4 = i3 * base;		// opposite to theta - highest cost bias
-
-	if (fabs(theta) > 7.0 * PI / 8.0) { dx = 0; dy = -1; }
-	else {
-		if (fabs(theta) > 5.0 * PI / 8.0) { dy = -1; if (theta > 0) dx = 1; else dx = -1; }
-		else {
-			if (fabs(theta) > 3.0 * PI / 8.0) { dy = 0; if (theta > 0) dx = 1; else dx = -1; }
-			else {
-				if (fabs(theta) > PI / 8.0) { dy = 1; if (theta > 0) dx = 1; else dx = -1; }
-				else { dy = 1; dx = 0; }
-			}
-		}
-	}
-	d.cell[1][1] = 0; // central cell has zero weighting
-	d.cell[dx + 1][dy + 1] = (float)i0;
-	d.cell[-dx + 1][-dy + 1] = (float)i4;
-	if (dx == 0 || dy == 0) { // theta points to a cardinal direction
-		d.cell[dy + 1][dx + 1] = (float)i2; d.cell[-dy + 1][-dx + 1] = (float)i2;
-		if (dx == 0) { // theta points N or S
-			xx = dx + 1; if (xx > 1) dx -= 2; yy = dy;
-			d.cell[xx + 1][yy + 1] = (float)i1; d.cell[-xx + 1][yy + 1] = (float)i1;
-			d.cell[xx + 1][-yy + 1] = (float)i3; d.cell[-xx + 1][-yy + 1] = (float)i3;
-		}
-		else { // theta points W or E
-			yy = dy + 1; if (yy > 1) dy -= 2; xx = dx;
-			d.cell[xx + 1][yy + 1] = (float)i1; d.cell[xx + 1][-yy + 1] = (float)i1;
-			d.cell[-xx + 1][yy + 1] = (float)i3; d.cell[-xx + 1][-yy + 1] = (float)i3;
-		}
-	}
-	else { // theta points to an ordinal direction
-		d.cell[dx + 1][-dy + 1] = (float)i2; d.cell[-dx + 1][dy + 1] = (float)i2;
-		xx = dx + 1; if (xx > 1) xx -= 2; d.cell[xx + 1][dy + 1] = (float)i1;
-		yy = dy + 1; if (yy > 1) yy -= 2; d.cell[dx + 1][yy + 1] = (float)i1;
-		d.cell[-xx + 1][-dy + 1] = (float)i3; d.cell[-dx + 1][-yy + 1] = (float)i3;
-	}
-
-	return d;
+// Get direction of goal for weighting neighbouring cells
+int Individual::getGoalBias(const int x, const int y, const int goaltype)
+{
+	if (goaltype == 0) return -1; // no goal set
+	// at goal, no direction
+	if ((x - smsData->goal.x) == 0 && (y - smsData->goal.y) == 0) return -1;
+	// TEMPORARY CODE - GOAL TYPE 1 NOT YET IMPLEMENTED, AS WE HAVE NO MEANS OF
+	// CAPTURING THE GOAL LOCATION OF EACH INDIVIDUAL
+	if (goaltype == 1) return -1;
+	// goaltype == 2
+	return heading(((double)x - (double)smsData->goal.x), ((double)y - (double)smsData->goal.y));
 }
 
 // Weight neighbouring cells on basis of (habitat) costs
@@ -1716,22 +1783,129 @@ array3x3f Individual::getHabMatrix(Landscape* pLand, Species* pSpecies,
 
 }
 
+//---------------------------------------------------------------------------
+
+// Selection of the transfer routine specialised for the current simulation
+
+// Each combination of transfer options is compiled as a separate instantiation of
+// moveKernel() or moveStep(), so that the per-step code carries no tests of options
+// which cannot change during a simulation; the runtime options are resolved one at
+// a time into template arguments by the following functions
+
+template <const short MoveType, const bool Absorbing, const bool IndVar, const bool HabMort>
+static Individual::trfrStep selectMoveStep(const bool dispBias) {
+	if constexpr (MoveType == 1) { // SMS
+		if (dispBias) return &Individual::moveStep<MoveType, Absorbing, IndVar, HabMort, true>;
+	}
+	// dispersal bias does not apply to CRW
+	return &Individual::moveStep<MoveType, Absorbing, IndVar, HabMort, false>;
+}
+
+template <const short MoveType, const bool Absorbing, const bool IndVar>
+static Individual::trfrStep selectMoveStep(const bool habMort, const bool dispBias) {
+	if (habMort) return selectMoveStep<MoveType, Absorbing, IndVar, true>(dispBias);
+	else return selectMoveStep<MoveType, Absorbing, IndVar, false>(dispBias);
+}
+
+template <const short MoveType, const bool Absorbing>
+static Individual::trfrStep selectMoveStep(const bool indVar, const bool habMort,
+	const bool dispBias)
+{
+	if (indVar) return selectMoveStep<MoveType, Absorbing, true>(habMort, dispBias);
+	else return selectMoveStep<MoveType, Absorbing, false>(habMort, dispBias);
+}
+
+template <const short MoveType>
+static Individual::trfrStep selectMoveStep(const bool absorbing, const bool indVar,
+	const bool habMort, const bool dispBias)
+{
+	if (absorbing) return selectMoveStep<MoveType, true>(indVar, habMort, dispBias);
+	else return selectMoveStep<MoveType, false>(indVar, habMort, dispBias);
+}
+
+// Select the transfer routine matching the species' transfer rules
+void Individual::selectTransfer(Landscape* pLandscape, Species* pSpecies,
+	const bool absorbing)
+{
+	trfrRules trfr = pSpecies->getTrfr();
+	simEngine eng = paramsSim->getEngine();
+
+	if (kernSampler != 0) {
+		delete kernSampler; kernSampler = 0;
+	}
+
+	if (trfr.moveModel) {
+		if (trfr.moveType == 1) { // SMS
+			trfrSMSTraits movt = pSpecies->getSMSTraits();
+			trfrStepFn = selectMoveStep<1>(absorbing, trfr.indVar, trfr.habMort,
+				movt.goalType == 2);
+		}
+		else { // CRW
+			trfrStepFn = selectMoveStep<2>(absorbing, trfr.indVar, trfr.habMort, false);
+		}
+	}
+	else { // dispersal kernel
+		if (eng.kernSampler > 0 && !trfr.indVar) {
+			// tabulated destinations, unless a kernel is too wide to be tabulated
+			landParams ppLand = pLandscape->getLandParams();
+			kernSampler = new KernelSampler(pLandscape, pSpecies, absorbing,
+				eng.kernSampler == 2 && ppLand.patchModel);
+			if (kernSampler->tabulated()) {
+				trfrStepFn = &Individual::sampleKernel;
+				return;
+			}
+			delete kernSampler; kernSampler = 0;
+		}
+		if (absorbing) {
+			if (trfr.indVar) trfrStepFn = &Individual::moveKernel<true, true>;
+			else trfrStepFn = &Individual::moveKernel<true, false>;
+		}
+		else {
+			if (trfr.indVar) trfrStepFn = &Individual::moveKernel<false, true>;
+			else trfrStepFn = &Individual::moveKernel<false, false>;
+		}
+	}
+}
+
+Individual::trfrStep Individual::getTransfer(void) { return trfrStepFn; }
+
+void Individual::resetTransfer(void) {
+	if (kernSampler != 0) kernSampler->reset();
+}
+
 //---------------------------------------------------------------------------
 // Write records to individuals file
 void Individual::outGenetics(const int rep, const int year, const int spnum,
-	const int landNr, const bool xtab)
+	const int landNr, const short form)
 {
 	if (landNr == -1) {
 		if (pGenome != 0) {
-			pGenome->outGenetics(rep, year, spnum, indId, xtab);
+			pGenome->outGenetics(rep, year, spnum, indId, form);
 		}
 	}
 	else { // open/close file
-		pGenome->outGenHeaders(rep, landNr, xtab);
+		pGenome->outGenHeaders(rep, landNr, form);
 	}
 
 }
 
+void Individual::alleleValues(std::vector <short>& values) {
+	if (pGenome != 0) pGenome->alleleValues(values);
+}
+
+void Individual::memory(memUsage& m) {
+	m.objects[MEMINDS]++;
+	long long b = sizeof(Individual);
+	if (emigtraits != 0) b += sizeof(emigTraits);
+	if (kerntraits != 0) b += sizeof(trfrKernTraits);
+	if (setttraits != 0) b += sizeof(settleTraits);
+	if (path != 0) b += sizeof(pathData);
+	if (crw != 0) b += sizeof(crwParams);
+	if (smsData != 0) b += sizeof(smsdata);
+	m.bytes[MEMINDS] += b;
+	if (pGenome != 0) pGenome->memory(m);
+}
+
 #if RS_RCPP
 //---------------------------------------------------------------------------
 // Write records to movement paths file
@@ -1785,6 +1959,38 @@ void Individual::outMovePath(const int year)
 
 //---------------------------------------------------------------------------
 
+// Direction of a vector as one of 8 octants, numbered clockwise from 0 = +y
+// (i.e. with the vector lying within PI/8 of 0 = +y, 1 = +x+y, 2 = +x, etc.)
+// Formerly the angle of the vector was found by atan2() and rounded to float before
+// being compared with the octant boundaries; here the side of each boundary on which
+// the vector lies is found directly, and atan2() is used only for a vector lying so
+// close to a boundary that the rounding of the angle could have altered the result
+int heading(const double x, const double y) {
+	static const double cosBound[4] = {
+		cos(PI / 8.0), cos(3.0 * PI / 8.0), cos(5.0 * PI / 8.0), cos(7.0 * PI / 8.0) };
+	static const double sinBound[4] = {
+		sin(PI / 8.0), sin(3.0 * PI / 8.0), sin(5.0 * PI / 8.0), sin(7.0 * PI / 8.0) };
+	double u = fabs(x);
+	double tolerance = 1.0e-5 * (u + fabs(y));
+	int sector = 0; // no. of boundaries (at odd multiples of PI/8) lying between +y and the vector
+	for (int i = 0; i < 4; i++) {
+		double side = u * cosBound[i] - y * sinBound[i];
+		if (fabs(side) <= tolerance) { // too close to call
+			double theta = (float)atan2(x, y);
+			sector = 0;
+			if (fabs(theta) > 7.0 * PI / 8.0) sector = 4;
+			else if (fabs(theta) > 5.0 * PI / 8.0) sector = 3;
+			else if (fabs(theta) > 3.0 * PI / 8.0) sector = 2;
+			else if (fabs(theta) > PI / 8.0) sector = 1;
+			break;
+		}
+		if (side < 0.0) break;
+		sector++;
+	}
+	if (x > 0.0 || sector == 0 || sector == 4) return sector;
+	else return 8 - sector;
+}
+
 double wrpcauchy(double location, double rho) {
 	double result;
 
@@ -1855,6 +2061,40 @@ void testIndividual() {
 
 	// Develops
 
+	// SMS directional weighting
+	// Octant directions match those of the angle of the vector, rounded to float
+	auto angleOctant = [](const int x, const int y) {
+		double theta = (float)atan2((double)x, (double)y);
+		int sector = 0;
+		if (fabs(theta) > 7.0 * PI / 8.0) sector = 4;
+		else if (fabs(theta) > 5.0 * PI / 8.0) sector = 3;
+		else if (fabs(theta) > 3.0 * PI / 8.0) sector = 2;
+		else if (fabs(theta) > PI / 8.0) sector = 1;
+		if (theta > 0 || sector == 0 || sector == 4) return sector;
+		else return 8 - sector;
+	};
+	for (int x = -50; x <= 50; x++) {
+		for (int y = -50; y <= 50; y++) {
+			if (x != 0 || y != 0) assert(heading(x, y) == angleOctant(x, y));
+		}
+	}
+	assert(heading(1000, 2414) == angleOctant(1000, 2414));
+	assert(heading(-2414, 1000) == angleOctant(-2414, 1000));
+	assert(heading(-5741, -13860) == angleOctant(-5741, -13860));
+	// Lowest weighting applies to the neighbouring cell in the direction of heading,
+	// highest to the cell opposite
+	smsWeights w = calcSMSWeights(3.0);
+	assert(w.wt[0] == 1.0 && w.wt[2] == 9.0 && w.wt[4] == 81.0);
+	for (int x2 = 0; x2 < 3; x2++) {
+		for (int y2 = 0; y2 < 3; y2++) {
+			if (x2 != 1 || y2 != 1) {
+				int h = heading(x2 - 1, y2 - 1);
+				assert(nbrOctants[h][x2][y2] == 0);
+				assert(nbrOctants[h][2 - x2][2 - y2] == 4);
+			}
+		}
+	}
+
 }
 #endif // RSDEBUG
 
@@ -45,7 +45,6 @@ Last updated: 26 October 2021 by Steve Palmer
 #define IndividualH
 
 
-#include <queue>
 #include <algorithm>
 using namespace std;
 
@@ -55,6 +54,8 @@ using namespace std;
 #include "Patch.h"
 #include "Cell.h"
 #include "Genome.h"
+#include "KernelSampler.h"
+#include "Profiler.h"
 
 #define NODATACOST 100000 // cost to use in place of nodata value for SMS
 #define ABSNODATACOST 100 // cost to use in place of nodata value for SMS
@@ -97,6 +98,11 @@ struct smsdata {
 	float gb;				// goal bias
 	float alphaDB;	// dispersal bias decay rate
 	int betaDB;			// dispersal bias decay inflection point (no. of steps)
+	smsWeights dpWts;			// weightings for directional persistence
+	smsWeights dpInflWts;	// weightings for inflated directional persistence
+	locn memory[MAXMEMSIZE];	// memory of last N squares visited, held as a ring buffer
+	short memFirst;				// index of oldest square in memory
+	short memCount;				// no. of squares in memory
 };
 
 class Individual {
@@ -190,45 +196,70 @@ public:
 	void moveto( // Move to a specified neighbouring cell
 		Cell*	// pointer to the new cell
 	);
+	// Transfer routine specialised for one combination of transfer options
+	// Returns 1 if still dispersing (including having found a potential patch), otherwise 0
+	typedef int (Individual::*trfrStep)(
+		Landscape*,		// pointer to Landscape
+		Species*,			// pointer to Species
+		const short		// landscape change index
+	);
+	// Select the transfer routine matching the species' transfer rules - must be
+	// called once at the start of each simulation, before any individual disperses
+	static void selectTransfer(
+		Landscape*,		// pointer to Landscape
+		Species*,			// pointer to Species
+		const bool		// absorbing boundaries?
+	);
+	static trfrStep getTransfer(void); // Get the selected transfer routine
+	// Discard any tables held by the selected transfer routine - must be called
+	// whenever the landscape limits or patch configuration change
+	static void resetTransfer(void);
 	// Move to a new cell by sampling a dispersal distance from a single or double
 	// negative exponential kernel
 	// Returns 1 if still dispersing (including having found a potential patch), otherwise 0
+	template <const bool Absorbing, const bool IndVar>
 	int moveKernel(
 		Landscape*,		// pointer to Landscape
 		Species*,			// pointer to Species
-		const short,	// reproduction type (see Species)
-		const bool    // absorbing boundaries?
+		const short		// landscape change index (not used)
+	);
+	// Move to a new cell drawn directly from the tabulated destinations of a species-level
+	// single or double negative exponential kernel (see KernelSampler)
+	// Returns 1 if still dispersing (including having found a potential patch), otherwise 0
+	int sampleKernel(
+		Landscape*,		// pointer to Landscape
+		Species*,			// pointer to Species
+		const short		// landscape change index (not used)
 	);
 	// Make a single movement step according to a mechanistic movement model
 	// Returns 1 if still dispersing (including having found a potential patch), otherwise 0
+	template <const short MoveType, const bool Absorbing, const bool IndVar,
+		const bool HabMort, const bool DispBias>
 	int moveStep(
 		Landscape*,		// pointer to Landscape
 		Species*,			// pointer to Species
-		const short,	// landscape change index
-		const bool    // absorbing boundaries?
+		const short		// landscape change index
 	);
-	movedata smsMove( // Move to a neighbouring cell according to the SMS algorithm
+	// Move to a neighbouring cell according to the SMS algorithm
+	template <const bool Absorbing, const bool IndVar, const bool DispBias>
+	movedata smsMove(
 		Landscape*,		// pointer to Landscape
 		Species*,			// pointer to Species
 		const short,	// landscape change index
-		const bool,		// TRUE if still in (or returned to) natal patch
-		const bool,   // individual variability?
-		const bool    // absorbing boundaries?
+		const bool		// TRUE if still in (or returned to) natal patch
 	);
-	array3x3d getSimDir( // Weight neighbouring cells on basis of current movement direction
+	// Get current movement direction for weighting neighbouring cells
+	// Returns direction as octant (0-7, see heading()) or -1 if there is none
+	int getSimDir(
 		const int,	// current x co-ordinate
-		const int,	// current y co-ordinate
-		const float	// directional persistence value
+		const int		// current y co-ordinate
 	);
-	array3x3d getGoalBias( // Weight neighbouring cells on basis of goal bias
+	// Get direction of goal for weighting neighbouring cells
+	// Returns direction as octant (0-7, see heading()) or -1 if there is none
+	int getGoalBias(
 		const int,	// current x co-ordinate
 		const int,	// current y co-ordinate
-		const int,	// goal type: 0 = none, 1 = towards goal (NOT IMPLEMENTED), 2 = dispersal bias
-		const float	// GOAL BIAS VALUE
-	);
-	array3x3d calcWeightings( // Calculate weightings for neighbouring cells
-		const double,	// base for power-law (directional persistence or goal bias value)
-		const double	// direction in which lowest (unit) weighting is to be applied
+		const int		// goal type: 0 = none, 1 = towards goal (NOT IMPLEMENTED), 2 = dispersal bias
 	);
 	array3x3f getHabMatrix( // Weight neighbouring cells on basis of (habitat) costs
 		Landscape*,		// pointer to Landscape
@@ -245,7 +276,13 @@ public:
 		const int,		 	// year
 		const int,		 	// species number
 		const int,		 	// landscape number
-		const bool	 		// output as cross table?
+		const short	 		// form of output (see simParams)
+	);
+	void alleleValues( // Append all allele values (if the individual has a genome)
+		std::vector <short>&
+	);
+	void memory( // Add the memory held by the individual, its traits, movement data and genome to a census
+		memUsage&
 	);
 #if RS_RCPP
 	void outMovePath( // Write records to movement paths file
@@ -282,18 +319,25 @@ private:
 	crwParams *crw;     				// pointer to CRW traits and data
 	smsdata *smsData;						// pointer to variables required for SMS
 	settleTraits *setttraits;		// pointer to settlement traits
-	std::queue <locn> memory;		// memory of last N squares visited for SMS
 
 	Genome *pGenome;
 
+	static trfrStep trfrStepFn;	// transfer routine selected for the current simulation
+	static KernelSampler *kernSampler;	// tabulated kernel destinations (if applied)
+
 };
 
 
 //---------------------------------------------------------------------------
 
+int heading( // Direction of a vector as octant (0 = +y, 2 = +x, 4 = -y, 6 = -x)
+	const double,	// x component
+	const double	// y component
+);
 double cauchy(double location, double scale) ;
 double wrpcauchy (double location, double rho = exp(double(-1)));
 
+extern paramSim *paramsSim;
 extern RSrandom *pRandom;
 
 #if RSDEBUG
@@ -301,7 +345,7 @@ extern ofstream DEBUGLOG;
 #endif
 
 #if RS_RCPP
-extern ofstream outMovePaths;
+extern outFile outMovePaths;
 #endif
 
 #if RSDEBUG
@@ -0,0 +1,515 @@
+/*----------------------------------------------------------------------------
+ *	
+ *	Copyright (C) 2020 Greta Bocedi, Stephen C.F. Palmer, Justin M.J. Travis, Anne-Kathleen Malchow, Damaris Zurell 
+ *	
+ *	This file is part of RangeShifter.
+ *	
+ *	RangeShifter is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *	
+ *	RangeShifter is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *	GNU General Public License for more details.
+ *	
+ *	You should have received a copy of the GNU General Public License
+ *	along with RangeShifter. If not, see <https://www.gnu.org/licenses/>.
+ *	
+ --------------------------------------------------------------------------*/
+ 
+ 
+//---------------------------------------------------------------------------
+
+#include "KernelSampler.h"
+//---------------------------------------------------------------------------
+
+KernelSampler::KernelSampler(Landscape* pLand, Species* pSp, const bool absorb,
+	const bool patchtables)
+{
+	pLandscape = pLand; pSpecies = pSp; absorbing = absorb;
+	patchTables = patchtables; aliasesBuilt = false;
+	usefullkernel = pSpecies->useFullKernel();
+	trfrRules trfr = pSpecies->getTrfr();
+	distMort = trfr.distMort;
+	mortParams = pSpecies->getMortParams();
+	land = pLandscape->getLandData();
+	resol = land.resol;
+	stageParams sstruct = pSpecies->getStage();
+	nstages = nsexes = 1;
+	if (trfr.stgDep) nstages = sstruct.nStages;
+	if (trfr.sexDep) nsexes = NSEXES;
+}
+
+KernelSampler::~KernelSampler() {
+	kernels.clear();
+	destns.clear();
+	aliases.clear();
+}
+
+// Kernel mean scaled to the cell size, which may not be less than 1 unless emigration
+// derives from the kernel (as in Individual::moveKernel())
+double KernelSampler::scaledMean(const float meanDist) {
+	double meandist = meanDist / (float)resol;
+	if (!usefullkernel && meandist < 1.0) meandist = 1.0;
+	return meandist;
+}
+
+// Can all the species' kernels be tabulated, i.e. are they no wider than MAXKERNRADIUS?
+bool KernelSampler::tabulated(void) {
+	trfrRules trfr = pSpecies->getTrfr();
+	trfrKernTraits kern;
+	double meandist;
+	for (int stg = 0; stg < nstages; stg++) {
+		for (int sex = 0; sex < nsexes; sex++) {
+			kern = pSpecies->getKernTraits(stg, sex);
+			for (int k = 0; k < 2; k++) {
+				if (k == 0) meandist = scaledMean(kern.meanDist1);
+				else {
+					if (!trfr.twinKern) continue;
+					meandist = scaledMean(kern.meanDist2);
+				}
+				if ((int)(-meandist * log(0.0000001)) + 2 > MAXKERNRADIUS) return false;
+			}
+		}
+	}
+	return true;
+}
+
+// Dispersal mortality at a given distance (no. of cells)
+double KernelSampler::mortality(const double dist) {
+	if (distMort)
+		return 1.0 / (1.0 + exp(-(dist * (float)resol - mortParams.mortBeta) * mortParams.mortAlpha));
+	else
+		return mortParams.fixedMort;
+}
+
+//---------------------------------------------------------------------------
+
+// Get the offsets reachable by a kernel, tabulating them if necessary
+const kernTable& KernelSampler::getKernel(const double meandist)
+{
+	std::map <double, kernTable>::iterator it = kernels.find(meandist);
+	if (it != kernels.end()) return it->second;
+
+	// moveKernel() draws the distance as -meandist * log(r1), where r1 is uniform on
+	// [0.0000001,1), so the kernel is truncated at dmax
+	double dmax = -meandist * log(0.0000001);
+	double kscale = 1.0 / (1.0 - 0.0000001);
+	int radius = (int)dmax + 2;
+	int width = 2 * radius + 1;
+	std::vector <double> prob(width * width, 0.0);
+	std::vector <double> mort(width * width, 0.0);
+
+	// the start position within the cell (drawn as loc + Random() * 0.999) is integrated
+	// over a regular grid, and the angle over regularly spaced rays, sufficient for each
+	// cell at the maximum distance to be crossed by several rays; along each ray, the
+	// kernel probability of the distance spent within each cell crossed is exact
+	const int npos = 4;
+	int nrays = 16 * ((int)dmax + 1);
+	double wt = kscale / (double)(npos * npos * nrays);
+	double x0, y0, angle, sinang, cosang;
+	double d0, d1, e0, e1, p, dnextx, dnexty, ddx, ddy;
+	int ix, iy, stepx, stepy, ixy;
+	for (int i = 0; i < npos; i++) {
+		x0 = ((double)i + 0.5) / (double)npos * 0.999;
+		for (int j = 0; j < npos; j++) {
+			y0 = ((double)j + 0.5) / (double)npos * 0.999;
+			for (int k = 0; k < nrays; k++) {
+				angle = ((double)k + 0.5) / (double)nrays * 2.0 * PI;
+				sinang = sin(angle); cosang = cos(angle);
+				// distances to the next cell boundary in x and y, and between boundaries
+				if (sinang > 0.0) { stepx = 1; ddx = 1.0 / sinang; dnextx = (1.0 - x0) * ddx; }
+				else {
+					if (sinang < 0.0) { stepx = -1; ddx = -1.0 / sinang; dnextx = x0 * ddx; }
+					else { stepx = 0; ddx = 0.0; dnextx = dmax; }
+				}
+				if (cosang > 0.0) { stepy = 1; ddy = 1.0 / cosang; dnexty = (1.0 - y0) * ddy; }
+				else {
+					if (cosang < 0.0) { stepy = -1; ddy = -1.0 / cosang; dnexty = y0 * ddy; }
+					else { stepy = 0; ddy = 0.0; dnexty = dmax; }
+				}
+				ix = iy = 0;
+				d0 = 0.0; e0 = 1.0;
+				while (d0 < dmax) {
+					d1 = dnextx;
+					if (dnexty < d1) d1 = dnexty;
+					if (dmax < d1) d1 = dmax;
+					e1 = exp(-d1 / meandist);
+					p = (e0 - e1) * wt;
+					ixy = (iy + radius) * width + ix + radius;
+					prob[ixy] += p;
+					if (distMort) { // mean mortality at the quartiles of the interval
+						mort[ixy] += p * 0.5 * (mortality(-meandist * log(0.75 * e0 + 0.25 * e1))
+							+ mortality(-meandist * log(0.25 * e0 + 0.75 * e1)));
+					}
+					else mort[ixy] += p * mortParams.fixedMort;
+					d0 = d1; e0 = e1;
+					if (dnextx <= dnexty) { ix += stepx; dnextx += ddx; }
+					else { iy += stepy; dnexty += ddy; }
+				}
+			}
+		}
+	}
+
+	kernTable& kt = kernels[meandist];
+	kt.radius = radius;
+	ixy = radius * width + radius;
+	kt.prob0 = prob[ixy]; kt.mort0 = mort[ixy];
+	for (iy = 0; iy < width; iy++) {
+		for (ix = 1; ix < width; ix++) {
+			ixy = iy * width + ix;
+			prob[ixy] += prob[ixy - 1]; mort[ixy] += mort[ixy - 1];
+		}
+	}
+	kt.cumProb.swap(prob); kt.cumMort.swap(mort);
+#if RSDEBUG
+	DEBUGLOG << "KernelSampler::getKernel(): meandist=" << meandist
+		<< " radius=" << radius << endl;
+#endif
+	return kt;
+}
+
+//---------------------------------------------------------------------------
+
+static bool compareLocns(const locn& a, const locn& b) {
+	return a.y < b.y || (a.y == b.y && a.x < b.x);
+}
+
+// Accumulate the offsets of a kernel from each source cell over the surrounding region,
+// classify each cell reached against the landscape, and hence build the cumulative
+// probabilities of the disperser's outcomes
+void KernelSampler::buildDestns(const kernTable& kt, Patch* pNatalPatch, Cell* pSource,
+	kernDestns* dd)
+{
+	std::vector <locn> srclocns;
+	if (pSource == 0) {
+		int ncells = pNatalPatch->getNCells();
+		for (int i = 0; i < ncells; i++) srclocns.push_back(pNatalPatch->getCellLocn(i));
+	}
+	else srclocns.push_back(pSource->getLocn());
+	double wt = 1.0 / (double)srclocns.size();
+
+	// source cells are taken as runs along rows, so that the offsets from a run of
+	// cells may be accumulated from the cumulative probabilities of each row of offsets
+	std::sort(srclocns.begin(), srclocns.end(), compareLocns);
+	int radius = kt.radius;
+	int kwidth = 2 * radius + 1;
+	int x0 = srclocns[0].x, x1 = x0, y0 = srclocns[0].y, y1 = y0;
+	for (int i = 1; i < (int)srclocns.size(); i++) {
+		if (srclocns[i].x < x0) x0 = srclocns[i].x;
+		if (srclocns[i].x > x1) x1 = srclocns[i].x;
+		if (srclocns[i].y < y0) y0 = srclocns[i].y;
+		if (srclocns[i].y > y1) y1 = srclocns[i].y;
+	}
+	x0 -= radius; x1 += radius; y0 -= radius; y1 += radius;
+	int width = x1 - x0 + 1;
+	std::vector <double> prob((size_t)width * (size_t)(y1 - y0 + 1), 0.0);
+	std::vector <double> mort(prob.size(), 0.0);
+
+	int run0, run1, t0, t1, row, krow, ixy;
+	int nsrc = (int)srclocns.size();
+	int i = 0;
+	while (i < nsrc) {
+		run0 = run1 = srclocns[i].x;
+		while (i + 1 < nsrc && srclocns[i + 1].y == srclocns[i].y
+			&& srclocns[i + 1].x == run1 + 1) {
+			i++; run1++;
+		}
+		for (int dy = -radius; dy <= radius; dy++) {
+			row = (srclocns[i].y + dy - y0) * width - x0;
+			krow = (dy + radius) * kwidth + radius;
+			for (int x = run0 - radius; x <= run1 + radius; x++) {
+				// sum of offsets x - run1 to x - run0 along the row
+				t0 = x - run1 - 1; t1 = x - run0;
+				if (t1 > radius) t1 = radius;
+				if (t0 < -radius) {
+					prob[row + x] += kt.cumProb[krow + t1];
+					mort[row + x] += kt.cumMort[krow + t1];
+				}
+				else {
+					prob[row + x] += kt.cumProb[krow + t1] - kt.cumProb[krow + t0];
+					mort[row + x] += kt.cumMort[krow + t1] - kt.cumMort[krow + t0];
+				}
+			}
+		}
+		i++;
+	}
+
+	// probabilities (and mortality) of a single draw being rejected, being in the natal
+	// patch, being lost or reaching a valid destination
+	double pRej = 0.0, pNatal = 0.0, pLost = 0.0, pValid = 0.0;
+	double mRej = 0.0, mNatal = 0.0, mLost = 0.0;
+
+	if (!usefullkernel) { // draws remaining within the current cell are rejected
+		for (i = 0; i < nsrc; i++) {
+			row = (srclocns[i].y - y0) * width + srclocns[i].x - x0;
+			prob[row] -= kt.prob0; mort[row] -= kt.mort0;
+		}
+		pRej += kt.prob0; mRej += kt.mort0;
+	}
+
+	// valid destinations are held in order of landscape cell no., so that the same
+	// random number always gives the same outcome
+	double p, m;
+	Cell* pCell;
+	std::vector <double> validprob;
+	for (int y = y0; y <= y1; y++) {
+		for (int x = x0; x <= x1; x++) {
+			ixy = (y - y0) * width + x - x0;
+			// (a difference of cumulative sums may leave rounding error where there are no offsets)
+			if (prob[ixy] <= 1.0e-15) continue;
+			p = prob[ixy] * wt; m = mort[ixy] * wt;
+			if (x < land.minX || x > land.maxX || y < land.minY || y > land.maxY) pCell = 0;
+			else pCell = pLandscape->findCell(x, y);
+			if (pCell == 0) { // beyond boundary or in no-data cell
+				if (absorbing) { pLost += p; mLost += m; }
+				else { pRej += p; mRej += m; }
+				continue;
+			}
+			if (!usefullkernel && pCell->getPatch() == (intptr)pNatalPatch) {
+				pNatal += p; mNatal += m; continue;
+			}
+			pValid += p;
+			dd->cells.push_back(pCell);
+			validprob.push_back(p);
+			// (clamped, as rounding error may be relatively large where p is very small)
+			m /= p;
+			if (m < 0.0) m = 0.0;
+			if (m > 1.0) m = 1.0;
+			dd->mort.push_back(m);
+		}
+	}
+	dd->mortLost = 0.0;
+	if (pLost > 0.0) dd->mortLost = mLost / pLost;
+	dd->mortFail = mortParams.fixedMort;
+	if (pRej + pNatal > 0.0) dd->mortFail = (mRej + mNatal) / (pRej + pNatal);
+
+	// the rejection scheme accepts a loss only until a draw has fallen within the natal
+	// patch (see moveKernel()), and fails after MAXKERNDRAWS draws
+	double total = pRej + pNatal + pLost + pValid;
+	double rawvalid = pValid;
+	if (total > 0.0) {
+		pRej /= total; pNatal /= total; pLost /= total; pValid /= total;
+	}
+	double notnatal = 1.0, natal = 0.0, lost = 0.0;
+	for (int i = 0; i < MAXKERNDRAWS; i++) {
+		lost += notnatal * pLost;
+		natal = natal * (1.0 - pValid) + notnatal * pNatal;
+		notnatal *= pRej;
+	}
+	dd->pLost = lost;
+	dd->pFail = notnatal + natal;
+
+	double cum = dd->pLost + dd->pFail;
+	double scale = 0.0;
+	if (rawvalid > 0.0) scale = (1.0 - cum) / rawvalid;
+	for (int i = 0; i < (int)validprob.size(); i++) {
+		cum += validprob[i] * scale;
+		dd->cumProb.push_back(cum);
+	}
+	if (!validprob.empty()) dd->cumProb.back() = 1.0;
+}
+
+// Get the conditioned destinations of a disperser, building the table if necessary
+const kernDestns* KernelSampler::getDestns(const double meandist,
+	Patch* pNatalPatch, Cell* pCell)
+{
+	checkLimits();
+
+	long long key = pNatalPatch->getSeqNum();
+	if (pCell != 0) {
+		locn loc = pCell->getLocn();
+		key += ((long long)loc.y * (long long)land.dimX + (long long)loc.x + 1) << 32;
+	}
+	std::map <long long, kernDestns>& sources = destns[meandist];
+	std::map <long long, kernDestns>::iterator it = sources.find(key);
+	if (it != sources.end()) return &it->second;
+
+	kernDestns* dd = &sources[key];
+	buildDestns(getKernel(meandist), pNatalPatch, pCell, dd);
+	return dd;
+}
+
+// Get the alias table of the outcomes of dispersal from a natal patch
+const kernAlias* KernelSampler::getAlias(Patch* pNatalPatch, const short stg,
+	const short sex)
+{
+	if (!patchTables) return 0;
+	checkLimits();
+	if (!aliasesBuilt) buildAliases();
+	std::map <int, std::vector <kernAlias> >::iterator it
+		= aliases.find(pNatalPatch->getSeqNum());
+	if (it == aliases.end()) return 0;
+	const kernAlias* ka = &it->second[stg * nsexes + sex];
+	if (ka->outcomes.empty()) return 0;
+	return ka;
+}
+
+// Build the alias tables of the outcomes of dispersal from every patch, for each
+// stage and sex, from the source tables of the kernel(s) applying to it
+void KernelSampler::buildAliases(void)
+{
+	aliases.clear();
+	trfrRules trfr = pSpecies->getTrfr();
+	trfrKernTraits kern;
+	Patch* pPatch;
+	locn loc;
+	const kernDestns* dd;
+	double wkern, prev, p, m;
+	int nreach, ix, jx;
+	// destinations of each kernel in order of landscape cell no., with the weights of
+	// reaching them alive or dying, and the merged destinations of twin kernels
+	std::vector <int> cellno[2], mcellno;
+	std::vector <Cell*> cells[2], mcells;
+	std::vector <double> wAlive[2], wDies[2], mwAlive, mwDies;
+	std::vector <double> wts;
+	kernOutcome outc;
+
+	int npatches = pLandscape->patchCount();
+	for (int i = 0; i < npatches; i++) {
+		pPatch = pLandscape->getPatch(i);
+		if (pPatch == 0 || pPatch->getNCells() == 0) continue; // e.g. the matrix
+		std::vector <kernAlias>& tables = aliases[pPatch->getSeqNum()];
+		tables.resize(nstages * nsexes);
+		for (int stg = 0; stg < nstages; stg++) {
+			for (int sex = 0; sex < nsexes; sex++) {
+				kern = pSpecies->getKernTraits(stg, sex);
+				double wLost[2] = { 0.0, 0.0 }, wFail[2] = { 0.0, 0.0 };
+				for (int k = 0; k < 2; k++) {
+					cellno[k].clear(); cells[k].clear(); wAlive[k].clear(); wDies[k].clear();
+					if (k == 0) {
+						if (trfr.twinKern) wkern = kern.probKern1; else wkern = 1.0;
+						dd = getDestns(scaledMean(kern.meanDist1), pPatch, 0);
+					}
+					else {
+						if (!trfr.twinKern) continue;
+						wkern = 1.0 - kern.probKern1;
+						dd = getDestns(scaledMean(kern.meanDist2), pPatch, 0);
+					}
+					wLost[0] += wkern * dd->pLost * (1.0 - dd->mortLost);
+					wLost[1] += wkern * dd->pLost * dd->mortLost;
+					wFail[0] += wkern * dd->pFail * (1.0 - dd->mortFail);
+					wFail[1] += wkern * dd->pFail * dd->mortFail;
+					prev = dd->pLost + dd->pFail;
+					for (int j = 0; j < (int)dd->cells.size(); j++) {
+						p = wkern * (dd->cumProb[j] - prev); prev = dd->cumProb[j];
+						m = dd->mort[j];
+						loc = dd->cells[j]->getLocn();
+						cellno[k].push_back(loc.y * land.dimX + loc.x);
+						cells[k].push_back(dd->cells[j]);
+						wAlive[k].push_back(p * (1.0 - m));
+						wDies[k].push_back(p * m);
+					}
+				}
+				// merge the destinations of the two kernels
+				mcellno.clear(); mcells.clear(); mwAlive.clear(); mwDies.clear();
+				ix = jx = 0;
+				while (ix < (int)cellno[0].size() || jx < (int)cellno[1].size()) {
+					if (jx >= (int)cellno[1].size()
+						|| (ix < (int)cellno[0].size() && cellno[0][ix] < cellno[1][jx])) {
+						mcellno.push_back(cellno[0][ix]); mcells.push_back(cells[0][ix]);
+						mwAlive.push_back(wAlive[0][ix]); mwDies.push_back(wDies[0][ix]);
+						ix++;
+					}
+					else {
+						if (ix < (int)cellno[0].size() && cellno[0][ix] == cellno[1][jx]) {
+							mcellno.push_back(cellno[0][ix]); mcells.push_back(cells[0][ix]);
+							mwAlive.push_back(wAlive[0][ix] + wAlive[1][jx]);
+							mwDies.push_back(wDies[0][ix] + wDies[1][jx]);
+							ix++;
+						}
+						else {
+							mcellno.push_back(cellno[1][jx]); mcells.push_back(cells[1][jx]);
+							mwAlive.push_back(wAlive[1][jx]); mwDies.push_back(wDies[1][jx]);
+						}
+						jx++;
+					}
+				}
+				// outcomes are held in order of destination cell no., so that the same
+				// random number always gives the same outcome
+				kernAlias* ka = &tables[stg * nsexes + sex];
+				wts.clear();
+				nreach = (int)mcells.size();
+				for (int d = 0; d < 2; d++) {
+					outc.dies = (d == 1);
+					outc.fate = 0;
+					for (int j = 0; j < nreach; j++) {
+						if (d == 0) p = mwAlive[j]; else p = mwDies[j];
+						if (p <= 0.0) continue;
+						outc.pCell = mcells[j];
+						ka->outcomes.push_back(outc); wts.push_back(p);
+					}
+					outc.pCell = 0;
+					if (wLost[d] > 0.0) {
+						outc.fate = 1; ka->outcomes.push_back(outc); wts.push_back(wLost[d]);
+					}
+					if (wFail[d] > 0.0) {
+						outc.fate = 2; ka->outcomes.push_back(outc); wts.push_back(wFail[d]);
+					}
+				}
+				makeAlias(wts, ka);
+			}
+		}
+	}
+
+	// the source tables of natal patches are no longer required
+	std::map <double, std::map <long long, kernDestns> >::iterator itk;
+	for (itk = destns.begin(); itk != destns.end(); itk++) {
+		itk->second.erase(itk->second.begin(), itk->second.lower_bound(1LL << 32));
+	}
+	aliasesBuilt = true;
+#if RSDEBUG
+	DEBUGLOG << "KernelSampler::buildAliases(): patches=" << aliases.size() << endl;
+#endif
+}
+
+// Set up an alias table from outcome weights (Vose's method)
+void KernelSampler::makeAlias(const std::vector <double>& wts, kernAlias* ka)
+{
+	int n = (int)wts.size();
+	double total = 0.0;
+	for (int i = 0; i < n; i++) total += wts[i];
+	ka->prob.assign(n, 1.0);
+	ka->alias.resize(n);
+	std::vector <double> scaled(n);
+	std::vector <int> small, large;
+	for (int i = 0; i < n; i++) {
+		ka->alias[i] = i;
+		scaled[i] = wts[i] * (double)n / total;
+		if (scaled[i] < 1.0) small.push_back(i); else large.push_back(i);
+	}
+	int s, l;
+	while (!small.empty() && !large.empty()) {
+		s = small.back(); small.pop_back();
+		l = large.back();
+		ka->prob[s] = scaled[s]; ka->alias[s] = l;
+		scaled[l] -= 1.0 - scaled[s];
+		if (scaled[l] < 1.0) {
+			large.pop_back(); small.push_back(l);
+		}
+	}
+	// any remaining outcomes (subject only to rounding error) are always selected
+}
+
+// Discard all tables if the landscape limits have changed
+void KernelSampler::checkLimits(void) {
+	landData ld = pLandscape->getLandData();
+	if (ld.minX != land.minX || ld.minY != land.minY
+		|| ld.maxX != land.maxX || ld.maxY != land.maxY) {
+		reset();
+		land = ld;
+	}
+}
+
+// Discard source tables after a change in the landscape
+void KernelSampler::reset(void) {
+	destns.clear();
+	aliases.clear();
+	aliasesBuilt = false;
+}
+
+//---------------------------------------------------------------------------
+//---------------------------------------------------------------------------
+//---------------------------------------------------------------------------
@@ -0,0 +1,188 @@
+/*----------------------------------------------------------------------------
+ *	
+ *	Copyright (C) 2020 Greta Bocedi, Stephen C.F. Palmer, Justin M.J. Travis, Anne-Kathleen Malchow, Damaris Zurell 
+ *	
+ *	This file is part of RangeShifter.
+ *	
+ *	RangeShifter is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *	
+ *	RangeShifter is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *	GNU General Public License for more details.
+ *	
+ *	You should have received a copy of the GNU General Public License
+ *	along with RangeShifter. If not, see <https://www.gnu.org/licenses/>.
+ *	
+ --------------------------------------------------------------------------*/
+ 
+ 
+/*------------------------------------------------------------------------------
+
+RangeShifter v2.0 KernelSampler
+
+Implements the KernelSampler class
+
+An alternative to the rejection sampling of dispersal kernel destinations applied
+by Individual::moveKernel(), in which a disperser's destination is drawn directly
+from the distribution of destinations which the rejection scheme produces, i.e.
+that of the kernel conditioned upon leaving the natal cell and patch (unless the
+full kernel is used) and upon remaining within reflective boundaries.
+
+For each distinct (scaled) kernel mean, the probability of each cell offset being
+reached from a position drawn at random within the current cell is first tabulated
+by integrating the (truncated) negative exponential kernel along a set of rays.
+For each dispersal source (natal patch or current cell) and kernel, the offsets are
+then classified against the landscape to give the cumulative probabilities of the
+valid destination cells, together with those of loss beyond an absorbing boundary
+and of failure to find a valid destination within the permitted number of draws,
+and (for distance-dependent mortality) the mean dispersal mortality of each outcome.
+Source tables are built when first required, and are discarded whenever the
+landscape limits or patch configuration change.
+
+In a patch-based model, the outcomes of dispersal from every natal patch may also be
+precomputed as alias tables (Walker's method), in which twin kernels and dispersal
+mortality are combined, so that each disperser's fate is a single draw. The alias
+tables are rebuilt for all patches at the first dispersal following any change in
+the landscape.
+
+The sampler applies only to species-level kernels, as individually variable kernels
+cannot share tables.
+
+For full details of RangeShifter, please see:
+Bocedi G., Palmer S.C.F., Peer G., Heikkinen R.K., Matsinos Y.G., Watts K.
+and Travis J.M.J. (2014). RangeShifter: a platform for modelling spatial
+eco-evolutionary dynamics and species responses to environmental changes.
+Methods in Ecology and Evolution, 5, 388-396. doi: 10.1111/2041-210X.12162
+
+------------------------------------------------------------------------------*/
+
+#ifndef KernelSamplerH
+#define KernelSamplerH
+
+#include <algorithm>
+#include <map>
+#include <vector>
+using namespace std;
+
+#include "Parameters.h"
+#include "Species.h"
+#include "Landscape.h"
+#include "Patch.h"
+#include "Cell.h"
+
+#define MAXKERNRADIUS 256	// maximum radius (cells) of a tabulated dispersal kernel
+#define MAXKERNDRAWS 999	// maximum draws accepted by the rejection scheme (see moveKernel())
+
+//---------------------------------------------------------------------------
+
+struct kernTable {	// probability of reaching each cell offset from a random position in a cell
+	int radius;	// maximum offset (no. of cells)
+	// cumulative probability of the offsets along each row (dx = -radius to radius),
+	// for each row (dy = -radius to radius), and likewise of probability multiplied
+	// by expected dispersal mortality
+	std::vector <double> cumProb;
+	std::vector <double> cumMort;
+	double prob0, mort0;	// probability (and mortality) of offset zero
+};
+struct kernDestns { // conditioned destinations from a dispersal source
+	double pLost;		// probability of loss beyond an absorbing boundary or in a no-data cell
+	double pFail;		// probability of failing to find a valid destination
+	double mortLost;	// dispersal mortality of a lost individual
+	double mortFail;	// dispersal mortality of an individual failing to find a destination
+	std::vector <Cell*> cells;		// valid destination cells
+	std::vector <double> cumProb;	// cumulative probability of each destination (incl. pLost and pFail)
+	std::vector <double> mort;		// dispersal mortality of each destination
+};
+
+struct kernOutcome { // outcome of dispersal from a natal patch
+	Cell *pCell;	// destination cell (0 unless fate is 0)
+	short fate;		// 0 = reaches cell, 1 = lost, 2 = fails to find a destination
+	bool dies;		// suffers dispersal mortality?
+};
+struct kernAlias { // alias table of the outcomes of dispersal from a natal patch
+	std::vector <kernOutcome> outcomes;
+	std::vector <double> prob;	// probability of each outcome being selected rather than its alias
+	std::vector <int> alias;		// index of alias of each outcome
+};
+
+class KernelSampler {
+public:
+	KernelSampler(
+		Landscape*,	// pointer to Landscape
+		Species*,		// pointer to Species
+		const bool,	// absorbing boundaries?
+		const bool	// precompute alias tables of outcomes for each natal patch?
+	);
+	~KernelSampler();
+	// Can all the species' kernels be tabulated, i.e. are they no wider than MAXKERNRADIUS?
+	bool tabulated(void);
+	// Get the conditioned destinations of a disperser, building the table if necessary
+	const kernDestns* getDestns(
+		const double,	// kernel mean (no. of cells)
+		Patch*,				// pointer to the natal Patch
+		Cell*					// pointer to the current Cell, or 0 if dispersing from the natal Patch
+	);
+	// Get the alias table of the outcomes of dispersal from a natal patch, building the
+	// tables for all patches if necessary; returns 0 if they are not precomputed
+	const kernAlias* getAlias(
+		Patch*,				// pointer to the natal Patch
+		const short,	// stage (0 if kernels are not stage-dependent)
+		const short		// sex (0 if kernels are not sex-dependent)
+	);
+	void reset(void); // discard source tables after a change in the landscape
+
+private:
+	double scaledMean( // Kernel mean scaled to the cell size
+		const float		// kernel mean (m)
+	);
+	void checkLimits(void); // discard all tables if the landscape limits have changed
+	void buildAliases(void);
+	void makeAlias( // Set up an alias table from outcome weights
+		const std::vector <double>&,	// weights of the outcomes
+		kernAlias*		// alias table, holding the outcomes
+	);
+	const kernTable& getKernel( // Get offsets of a kernel, tabulating them if necessary
+		const double	// kernel mean (no. of cells)
+	);
+	void buildDestns(
+		const kernTable&,	// offsets of the kernel
+		Patch*,				// pointer to the natal Patch
+		Cell*,				// pointer to the source Cell, or 0 for all cells of the natal Patch
+		kernDestns*		// destinations to be filled
+	);
+	double mortality( // Dispersal mortality at a given distance
+		const double	// distance (no. of cells)
+	);
+
+	Landscape *pLandscape;
+	Species *pSpecies;
+	bool absorbing;
+	bool patchTables;		// precompute alias tables for each natal patch?
+	bool aliasesBuilt;	// are the alias tables up to date?
+	bool usefullkernel;
+	bool distMort;
+	int resol;
+	trfrMortParams mortParams;
+	landData land;	// landscape limits when the source tables were built
+	std::map <double, kernTable> kernels;	// offsets by kernel mean
+	// source tables by kernel mean and source, where the source key is the natal patch
+	// sequential no. for a disperser in its natal patch, or otherwise the current cell
+	// index combined with the natal patch sequential no.
+	std::map <double, std::map <long long, kernDestns> > destns;
+	int nstages, nsexes; // no. of stages and sexes for which kernels are defined
+	// alias tables by natal patch sequential no., and stage and sex
+	std::map <int, std::vector <kernAlias> > aliases;
+
+};
+
+//---------------------------------------------------------------------------
+
+#if RSDEBUG
+extern ofstream DEBUGLOG;
+#endif
+
+#endif
@@ -27,10 +27,10 @@
 
 ifstream landscape;
 
-ofstream outConnMat;
-ofstream outvisits;
+outFile outConnMat;
+outFile outvisits;
 #if RS_RCPP
-ofstream outMovePaths;
+outFile outMovePaths;
 #endif // RS_RCPP
 
 //---------------------------------------------------------------------------
@@ -873,6 +873,7 @@ void Landscape::resetPatchPopns(void) {
 }
 
 void Landscape::updateCarryingCapacity(Species* pSpecies, int yr, short landIx) {
+	profScope prof(PROFUPDATEK);
 	envGradParams grad = paramsGrad->getGradient();
 	bool gradK = false;
 	if (grad.gradient && grad.gradType == 1) gradK = true; // gradient in carrying capacity
@@ -898,6 +899,11 @@ int Landscape::patchCount(void) {
 	return (int)patches.size();
 }
 
+Patch* Landscape::getPatch(const int ix) {
+	if (ix >= 0 && ix < (int)patches.size()) return patches[ix];
+	else return 0;
+}
+
 void Landscape::listPatches(void) {
 	patchLimits p;
 	int npatches = (int)patches.size();
@@ -2485,7 +2491,7 @@ bool Landscape::outConnectHeaders(int option)
 	else
 		name += "Sim" + Int2Str(sim.simulation);
 	name += "_Connect.txt";
-	outConnMat.open(name.c_str());
+	outConnMat.open(name.c_str(), false, paramsSim->getEngine().compConnect, true);
 
 	outConnMat << "Rep\tYear\tStartPatch\tEndPatch\tNinds" << endl;
 
@@ -2532,6 +2538,7 @@ void Landscape::outPathsHeaders(int rep, int option)
 
 void Landscape::outConnect(int rep, int yr)
 {
+	profScope prof(PROFOUTCONNECT);
 	int patchnum0, patchnum1;
 	int npatches = (int)patches.size();
 	int* emigrants = new int[npatches]; // 1D array to hold emigrants from each patch
@@ -2638,6 +2645,31 @@ void Landscape::outVisits(int rep, int landNr) {
 	outvisits.close(); outvisits.clear();
 }
 
+void Landscape::memory(memUsage& m) {
+	if (cells != 0) {
+		m.bytes[MEMCELLS] += (long long)dimY * (sizeof(Cell**) + (long long)dimX * sizeof(Cell*));
+		for (int y = 0; y < dimY; y++) {
+			for (int x = 0; x < dimX; x++) {
+				if (cells[y][x] != 0) cells[y][x]->memory(m);
+			}
+		}
+	}
+	m.bytes[MEMPATCHES] += patches.capacity() * sizeof(Patch*) + patchnums.capacity() * sizeof(int);
+	long long npatches = (long long)patches.size();
+	for (int i = 0; i < (int)npatches; i++) patches[i]->memory(m);
+
+	m.objects[MEMMATRICES] += landchanges.size() + patchchanges.size() + costschanges.size();
+	m.bytes[MEMMATRICES] += landchanges.capacity() * sizeof(landChange)
+		+ patchchanges.capacity() * sizeof(patchChange) + costschanges.capacity() * sizeof(costChange);
+	if (connectMatrix != 0) { // created for the no. of patches
+		m.objects[MEMMATRICES]++;
+		m.bytes[MEMMATRICES] += npatches * (sizeof(int*) + npatches * sizeof(int));
+	}
+	long long chgbytes = (long long)dimY * (sizeof(int**) + (long long)dimX * (sizeof(int*) + 3 * sizeof(int)));
+	if (patchChgMatrix != 0) { m.objects[MEMMATRICES]++; m.bytes[MEMMATRICES] += chgbytes; }
+	if (costsChgMatrix != 0) { m.objects[MEMMATRICES]++; m.bytes[MEMMATRICES] += chgbytes; }
+}
+
 //---------------------------------------------------------------------------
 
 //---------------------------------------------------------------------------
@@ -78,6 +78,8 @@ Last updated: 2 December 2021 by Steve Palmer
 using namespace std;
 
 #include "Parameters.h"
+#include "OutputWriter.h"
+#include "Profiler.h"
 #include "Patch.h"
 #include "Cell.h"
 #include "Species.h"
@@ -301,6 +303,9 @@ public:
 		int			// y co-ordinate
 	);
 	int patchCount(void);
+	Patch* getPatch( // Return pointer to a specified patch
+		const int		// index no. of the Patch within the vector patches
+	);
 	void updateHabitatIndices(void);
 	void setEnvGradient(
 		Species*, // pointer to Species
@@ -466,6 +471,9 @@ public:
 
 	void resetVisits(void);
 	void outVisits(int,int);	// save SMS path visits map to raster text file
+	void memory( // Add the memory held by the cells, patches, connectivity matrix and landscape changes to a census
+		memUsage&
+	);
 
 private:
 	bool generated;				// artificially generated?
@@ -0,0 +1,131 @@
+/*----------------------------------------------------------------------------
+ *	
+ *	Copyright (C) 2020 Greta Bocedi, Stephen C.F. Palmer, Justin M.J. Travis, Anne-Kathleen Malchow, Damaris Zurell 
+ *	
+ *	This file is part of RangeShifter.
+ *	
+ *	RangeShifter is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *	
+ *	RangeShifter is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *	GNU General Public License for more details.
+ *	
+ *	You should have received a copy of the GNU General Public License
+ *	along with RangeShifter. If not, see <https://www.gnu.org/licenses/>.
+ *	
+ --------------------------------------------------------------------------*/
+ 
+ 
+//---------------------------------------------------------------------------
+
+#include "MemoryAccount.h"
+#include "Landscape.h"
+#include "Community.h"
+//---------------------------------------------------------------------------
+
+MemoryAccount memAccount;
+
+outTable outMem;
+
+// Names of the subsystems, in the order of their numbers
+static const char* memNames[NMEMSUBSYSTEMS] = {
+	"Cells", "Patches", "Popns", "Inds", "Genomes", "Matrices", "Output"
+};
+
+void clearMemory(memUsage& m) {
+	for (int i = 0; i < NMEMSUBSYSTEMS; i++) { m.objects[i] = 0; m.bytes[i] = 0; }
+}
+
+const char* memoryName(const int subsystem) {
+	if (subsystem < 0 || subsystem >= NMEMSUBSYSTEMS) return "";
+	return memNames[subsystem];
+}
+
+//---------------------------------------------------------------------------
+
+MemoryAccount::MemoryAccount(void) {
+	on = false;
+	clearMemory(yearMax); clearMemory(simMax);
+	yearTotal = simTotal = 0;
+}
+
+MemoryAccount::~MemoryAccount(void) { }
+
+bool MemoryAccount::outHeaders(const int landNr) {
+	if (landNr == -999) { // close file
+		if (outMem.is_open()) outMem.close();
+		on = false;
+		return true;
+	}
+
+	string name;
+	simParams sim = paramsSim->getSim();
+	if (sim.batchMode) {
+		name = paramsSim->getDir(2)
+			+ "Batch" + Int2Str(sim.batchNum) + "_"
+			+ "Sim" + Int2Str(sim.simulation) + "_Land" + Int2Str(landNr);
+	}
+	else {
+		name = paramsSim->getDir(2) + "Sim" + Int2Str(sim.simulation);
+	}
+
+	// column types must match the types of the values written by outMemory()
+	outMem.open(name + "_Memory", false, OUTNOCOMP, true);
+	outMem.column("Rep", 'i'); outMem.column("Year", 'i');
+	for (int i = 0; i < NMEMSUBSYSTEMS; i++) {
+		outMem.column(string(memNames[i]) + "Objects", 'l');
+		outMem.column(string(memNames[i]) + "Bytes", 'l');
+	}
+	outMem.column("TotalBytes", 'l');
+	outMem.endHeader();
+
+	on = outMem.is_open();
+	clearMemory(yearMax); yearTotal = 0;
+	return on;
+}
+
+void MemoryAccount::census(Landscape* pLandscape, Community* pComm) {
+	if (!on) return;
+	memUsage m;
+	clearMemory(m);
+	pLandscape->memory(m);
+	pComm->memory(m);
+	outFile::memory(m);
+	outTable::memory(m);
+	long long total = 0;
+	for (int i = 0; i < NMEMSUBSYSTEMS; i++) {
+		if (m.objects[i] > yearMax.objects[i]) yearMax.objects[i] = m.objects[i];
+		if (m.bytes[i] > yearMax.bytes[i]) yearMax.bytes[i] = m.bytes[i];
+		if (m.objects[i] > simMax.objects[i]) simMax.objects[i] = m.objects[i];
+		if (m.bytes[i] > simMax.bytes[i]) simMax.bytes[i] = m.bytes[i];
+		total += m.bytes[i];
+	}
+	if (total > yearTotal) yearTotal = total;
+	if (total > simTotal) simTotal = total;
+}
+
+void MemoryAccount::outMemory(const int rep, const int yr) {
+	if (!on) return;
+	outMem << rep << yr;
+	for (int i = 0; i < NMEMSUBSYSTEMS; i++)
+		outMem << yearMax.objects[i] << yearMax.bytes[i];
+	outMem << yearTotal;
+	outMem.endRow();
+	clearMemory(yearMax); yearTotal = 0;
+}
+
+void MemoryAccount::outSummary(void) {
+	if (!on) return;
+	outMem << -1 << -1;
+	for (int i = 0; i < NMEMSUBSYSTEMS; i++)
+		outMem << simMax.objects[i] << simMax.bytes[i];
+	outMem << simTotal;
+	outMem.endRow();
+	clearMemory(simMax); simTotal = 0;
+}
+
+//---------------------------------------------------------------------------
@@ -0,0 +1,117 @@
+/*----------------------------------------------------------------------------
+ *	
+ *	Copyright (C) 2020 Greta Bocedi, Stephen C.F. Palmer, Justin M.J. Travis, Anne-Kathleen Malchow, Damaris Zurell 
+ *	
+ *	This file is part of RangeShifter.
+ *	
+ *	RangeShifter is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *	
+ *	RangeShifter is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *	GNU General Public License for more details.
+ *	
+ *	You should have received a copy of the GNU General Public License
+ *	along with RangeShifter. If not, see <https://www.gnu.org/licenses/>.
+ *	
+ --------------------------------------------------------------------------*/
+ 
+ 
+/*------------------------------------------------------------------------------
+
+RangeShifter v2.0 MemoryAccount
+
+Implements the MemoryAccount class
+
+Accounts for the memory held by each subsystem of the model: cells (with their
+habitat vectors and SMS costs), patches (with their cell vectors), sub-communities
+and populations (with their vectors of individuals), individuals (with their traits
+and movement data), genomes (with their chromosomes and alleles), the connectivity
+and landscape change matrices, and output (file buffers, records waiting to be
+written and occupancy counts).
+
+Memory is measured by a census, in which each object adds its own size and the
+capacity of its vectors and arrays (but not any overhead of the heap allocator) to
+a memUsage. A census is taken after reproduction and after dispersal in each
+generation and at the end of each year, which are the points at which populations
+and SMS costs are largest, and the largest no. of objects and bytes of each
+subsystem at any census of the year (and the largest total) are written at the end
+of the year to a memory file (_Memory). The largest values of the simulation are
+written as its last row, with replicate and year -1.
+
+For full details of RangeShifter, please see:
+Bocedi G., Palmer S.C.F., Peer G., Heikkinen R.K., Matsinos Y.G., Watts K.
+and Travis J.M.J. (2014). RangeShifter: a platform for modelling spatial
+eco-evolutionary dynamics and species responses to environmental changes.
+Methods in Ecology and Evolution, 5, 388-396. doi: 10.1111/2041-210X.12162
+
+------------------------------------------------------------------------------*/
+
+#ifndef MemoryAccountH
+#define MemoryAccountH
+
+#include <fstream>
+using namespace std;
+
+#include "Parameters.h"
+#include "OutputTable.h"
+
+// Subsystems of which memory is accounted
+#define MEMCELLS 0			// cells, their habitat vectors and SMS costs
+#define MEMPATCHES 1		// patches and their cell vectors
+#define MEMPOPNS 2			// sub-communities, populations and their vectors of individuals
+#define MEMINDS 3				// individuals, their traits and movement data
+#define MEMGENOMES 4		// genomes, chromosomes and alleles
+#define MEMMATRICES 5		// connectivity matrix and landscape changes
+#define MEMOUTPUT 6			// output file buffers and records, occupancy counts
+#define NMEMSUBSYSTEMS 7
+
+struct memUsage {
+	long long objects[NMEMSUBSYSTEMS];
+	long long bytes[NMEMSUBSYSTEMS];
+};
+
+void clearMemory(memUsage&);
+const char* memoryName( // Name of a subsystem, as in the memory file
+	const int		// subsystem
+);
+
+class Landscape;
+class Community;
+
+//---------------------------------------------------------------------------
+
+class MemoryAccount {
+public:
+	MemoryAccount(void);
+	~MemoryAccount(void);
+	bool outHeaders( // Open the memory file and write the header record
+		const int		// landscape number (-999 to close the file)
+	);
+	void census( // Measure the memory in use, updating the largest values
+		Landscape*,	// pointer to Landscape
+		Community*	// pointer to Community
+	);
+	void outMemory( // Write the largest values of the year and begin the next year
+		const int,	// replicate
+		const int		// year
+	);
+	void outSummary(void); // Write the largest values of the simulation (as replicate and
+												 // year -1), and reset them
+
+private:
+	bool on;
+	memUsage yearMax, simMax;	// largest value of each subsystem at any census
+	long long yearTotal, simTotal;	// largest total bytes at any census
+
+};
+
+extern MemoryAccount memAccount;
+
+extern paramSim *paramsSim;
+
+//---------------------------------------------------------------------------
+#endif
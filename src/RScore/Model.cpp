@@ -87,6 +87,12 @@ int RunModel(Landscape* pLandscape, int seqsim)
 	Rcpp::List list_outPop;
 #endif
 
+	// select the transfer routine for the simulation's transfer rules
+	Individual::selectTransfer(pLandscape, pSpecies, sim.absorbing);
+	// set output file buffering
+	simEngine eng = paramsSim->getEngine();
+	outFile::setEngine(eng);
+
 	// Loop through replicates
 	for (int rep = 0; rep < sim.reps; rep++) {
 #if RSDEBUG
@@ -131,6 +137,7 @@ int RunModel(Landscape* pLandscape, int seqsim)
 			DEBUGLOG << "RunModel(): finished resetting landscape" << endl << endl;
 #endif
 			pLandscape->generatePatches();
+			Individual::resetTransfer();
 			if (v.viewLand || sim.saveMaps) {
 				pLandscape->setLandMap();
 				pLandscape->drawLandscape(rep, 0, ppLand.landNum);
@@ -173,15 +180,16 @@ int RunModel(Landscape* pLandscape, int seqsim)
 		}
 
 		filesOK = true;
-		if (rep == 0) {
-			// open output files
+		outFile::setReplicate(rep);
+		if (rep == 0 || eng.outShards) {
+			// open output files (for every replicate if they are sharded by replicate)
 			if (sim.outRange) { // open Range file
 				if (!pComm->outRangeHeaders(pSpecies, ppLand.landNum)) {
 					MemoLine("UNABLE TO OPEN RANGE FILE");
 					filesOK = false;
 				}
 			}
-			if (sim.outOccup && sim.reps > 1)
+			if (rep == 0 && sim.outOccup && sim.reps > 1)
 				if (!pComm->outOccupancyHeaders(0)) {
 					MemoLine("UNABLE TO OPEN OCCUPANCY FILE(S)");
 					filesOK = false;
@@ -208,6 +216,21 @@ int RunModel(Landscape* pLandscape, int seqsim)
 					MemoLine("UNABLE TO OPEN CONNECTIVITY FILE");
 					filesOK = false;
 				}
+			if (eng.dispStats > 0)
+				if (!pComm->outDispStatsHeaders(pSpecies, ppLand.landNum)) {
+					MemoLine("UNABLE TO OPEN DISPERSAL STATISTICS FILES");
+					filesOK = false;
+				}
+			if (eng.profile)
+				if (!profiler.outHeaders(ppLand.landNum)) {
+					MemoLine("UNABLE TO OPEN PROFILE FILE");
+					filesOK = false;
+				}
+			if (eng.memReport)
+				if (!memAccount.outHeaders(ppLand.landNum)) {
+					MemoLine("UNABLE TO OPEN MEMORY FILE");
+					filesOK = false;
+				}
 		}
 #if RSDEBUG
 		DEBUGLOG << "RunModel(): completed opening output files" << endl;
@@ -231,6 +254,12 @@ int RunModel(Landscape* pLandscape, int seqsim)
 				pComm->outTraitsRowsHeaders(pSpecies, -999);
 			if (sim.outConnect && ppLand.patchModel)
 				pLandscape->outConnectHeaders(-999);
+			if (eng.dispStats > 0)
+				pComm->outDispStatsHeaders(pSpecies, -999);
+			if (eng.profile)
+				profiler.outHeaders(-999);
+			if (eng.memReport)
+				memAccount.outHeaders(-999);
 #if RS_RCPP && !R_CMD
 			return Rcpp::List::create(Rcpp::Named("Errors") = 666);
 #else
@@ -322,6 +351,7 @@ int RunModel(Landscape* pLandscape, int seqsim)
 				cout << "starting year " << yr << endl;
 #endif
 			}
+			profScope landScope(PROFLANDCHANGE);
 			if (init.seedType == 0 && init.freeType < 2) {
 				// apply any range restrictions
 				if (yr == init.initFrzYr) {
@@ -409,6 +439,7 @@ int RunModel(Landscape* pLandscape, int seqsim)
 							}
 							ixpchchg--;
 							pLandscape->resetPatches(); // reset patch limits
+							Individual::resetTransfer();
 						}
 						if (landChg.costfile != "NULL") { // apply any SMS cost changes
 #if RSDEBUG
@@ -435,6 +466,7 @@ int RunModel(Landscape* pLandscape, int seqsim)
 					}
 				}
 			} // end of environmental gradient, etc.
+			landScope.stop();
 
 			if (updateCC) {
 				pLandscape->updateCarryingCapacity(pSpecies, yr, landIx);
@@ -514,6 +546,7 @@ int RunModel(Landscape* pLandscape, int seqsim)
 
 				// reproduction
 				pComm->reproduction(yr);
+				if (eng.memReport) memAccount.census(pLandscape, pComm);
 
 				if (dem.stageStruct) {
 					if (sstruct.survival == 0) { // at reproduction
@@ -540,6 +573,7 @@ int RunModel(Landscape* pLandscape, int seqsim)
 #else
 				pComm->dispersal(landIx);
 #endif // RS_RCPP
+				if (eng.memReport) memAccount.census(pLandscape, pComm);
 #if RSDEBUG
 				DEBUGLOG << "RunModel(): yr=" << yr << " gen=" << gen << " completed dispersal" << endl;
 #endif
@@ -615,7 +649,22 @@ int RunModel(Landscape* pLandscape, int seqsim)
 				if (totalInds <= 0) { yr++; break; }
 			}
 
+			if (eng.dispStats > 0) pComm->outDispStats(rep, yr);
+			if (eng.memReport) {
+				memAccount.census(pLandscape, pComm);
+				memAccount.outMemory(rep, yr);
+			}
+			profScope writeScope(PROFOUTWRITE);
+			outTable::emitAll(); // hand this year's records to the writer thread
+			outFile::flushIfDue();
+			writeScope.stop();
+			if (eng.profile) profiler.outProfile(rep, yr);
+			if (runStatus.due()) runStatus.update(rep, yr, totalInds, pComm->matrixInds());
+
 		} // end of the years loop
+		runStatus.endReplicate(rep, yr - 1, totalInds, pComm->matrixInds());
+		// write any dispersal statistics of the year in which the population went extinct
+		if (eng.dispStats > 0) pComm->outDispStats(rep, yr - 1);
 
 		// Final output and popn. visualisation
 #if BATCH
@@ -635,6 +684,11 @@ int RunModel(Landscape* pLandscape, int seqsim)
 #if RSDEBUG
 		DEBUGLOG << "RunModel(): yr=" << yr << " completed final summary output" << endl;
 #endif
+		if (eng.memReport) { // memory of the final year (if the population went extinct)
+			memAccount.census(pLandscape, pComm);		// and summary output
+			memAccount.outMemory(rep, yr);
+			if (rep == sim.reps - 1) memAccount.outSummary(); // largest of the simulation
+		}
 
 		pComm->resetPopns();
 
@@ -676,6 +730,7 @@ int RunModel(Landscape* pLandscape, int seqsim)
 			}
 			ixpchchg--;
 			pLandscape->resetPatches();
+			Individual::resetTransfer();
 		}
 		if (ppLand.dynamic) {
 			trfrRules trfr = pSpecies->getTrfr();
@@ -711,6 +766,8 @@ int RunModel(Landscape* pLandscape, int seqsim)
 			pComm->outInds(rep, 0, 0, -999);
 		if (sim.outGenetics) // close Genetics output file
 			pComm->outGenetics(rep, 0, 0, -999);
+		// write the times of the final year, summary output and reset
+		if (eng.profile) profiler.outProfile(rep, yr);
 
 		if (sim.saveVisits) {
 			pLandscape->outVisits(rep, ppLand.landNum);
@@ -721,6 +778,18 @@ int RunModel(Landscape* pLandscape, int seqsim)
 		if (sim.outPaths)
 			pLandscape->outPathsHeaders(rep, -999);
 #endif
+		if (eng.outShards) { // close the replicate's shards of output files
+			if (sim.outRange) pComm->outRangeHeaders(pSpecies, -999);
+			if (sim.outPop) pComm->outPopHeaders(pSpecies, -999);
+			if (sim.outTraitsCells) pComm->outTraitsHeaders(pSpecies, -999);
+			if (sim.outTraitsRows) pComm->outTraitsRowsHeaders(pSpecies, -999);
+			if (sim.outConnect && ppLand.patchModel) pLandscape->outConnectHeaders(-999);
+			if (eng.dispStats > 0) pComm->outDispStatsHeaders(pSpecies, -999);
+			if (eng.profile) profiler.outHeaders(-999);
+			if (eng.memReport) memAccount.outHeaders(-999);
+		}
+		outTable::emitAll();
+		outFile::flushAll();
 #if RSDEBUG
 		DEBUGLOG << endl << "RunModel(): finished rep=" << rep << endl;
 #endif
@@ -737,7 +806,7 @@ int RunModel(Landscape* pLandscape, int seqsim)
 		MemoLine("Writing final occupancy output...");
 		pComm->outOccupancy();
 		pComm->outOccSuit(v.viewGraph);
-		pComm->deleteOccupancy((sim.years / sim.outIntOcc) + 1);
+		pComm->deleteOccupancy();
 		pComm->outOccupancyHeaders(-999);
 		MemoLine("...finished");
 	}
@@ -752,10 +821,26 @@ int RunModel(Landscape* pLandscape, int seqsim)
 		pComm->outTraitsHeaders(pSpecies, -999); // close Traits file
 	if (sim.outTraitsRows)
 		pComm->outTraitsRowsHeaders(pSpecies, -999); // close Traits rows file
+	if (eng.dispStats > 0)
+		pComm->outDispStatsHeaders(pSpecies, -999); // close Dispersal statistics files
+	if (eng.profile)
+		profiler.outHeaders(-999); // close Profile file
+	if (eng.memReport)
+		memAccount.outHeaders(-999); // close Memory file
 	// close Individuals & Genetics output files if open
 	// they can still be open if the simulation was stopped by the user
 	if (sim.outInds) pComm->outInds(0, 0, 0, -999);
 	if (sim.outGenetics) pComm->outGenetics(0, 0, 0, -999);
+	if (eng.outShards) { // write the index of shards of output files
+		string name = paramsSim->getDir(2);
+		if (sim.batchMode)
+			name += "Batch" + Int2Str(sim.batchNum) + "_"
+				+ "Sim" + Int2Str(sim.simulation) + "_Land" + Int2Str(ppLand.landNum);
+		else
+			name += "Sim" + Int2Str(sim.simulation);
+		if (!outFile::writeShardIndex(name + "_Shards.txt"))
+			MemoLine("UNABLE TO WRITE INDEX OF OUTPUT FILE SHARDS");
+	}
 
 	MemoLine("Deleting community...");
 	delete pComm; pComm = 0;
@@ -2032,7 +2117,17 @@ void OutParameters(Landscape* pLandscape)
 				break;
 			}
 		}
-		if (sim.outGenXtab) outPar << " (as cross table)";
+		switch (sim.outGenForm) {
+		case 1:
+			outPar << " (as cross table)";
+			break;
+		case 2:
+			outPar << " (as packed allele matrix)";
+			break;
+		case 3:
+			outPar << " (as allele frequencies)";
+			break;
+		}
 		outPar << endl;
 	}
 
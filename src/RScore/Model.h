@@ -54,6 +54,7 @@ Last updated: 26 October 2021 by Steve Palmer
 #include "Community.h"
 #include "SubCommunity.h"
 #include "Species.h"
+#include "RunStatus.h"
 
 #if !RS_EMBARCADERO && !LINUX_CLUSTER && !RS_RCPP
 #include <filesystem>
@@ -0,0 +1,582 @@
+/*----------------------------------------------------------------------------
+ *	
+ *	Copyright (C) 2020 Greta Bocedi, Stephen C.F. Palmer, Justin M.J. Travis, Anne-Kathleen Malchow, Damaris Zurell 
+ *	
+ *	This file is part of RangeShifter.
+ *	
+ *	RangeShifter is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *	
+ *	RangeShifter is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *	GNU General Public License for more details.
+ *	
+ *	You should have received a copy of the GNU General Public License
+ *	along with RangeShifter. If not, see <https://www.gnu.org/licenses/>.
+ *	
+ --------------------------------------------------------------------------*/
+ 
+ 
+//---------------------------------------------------------------------------
+
+#include "OutputTable.h"
+#include "MemoryAccount.h"
+
+#include <memory>
+#include <sstream>
+//---------------------------------------------------------------------------
+
+// Size of a value of a column type (zero if the type is not recognised)
+size_t colTypeSize(const char type) {
+	switch (type) {
+	case 'h': return sizeof(short);
+	case 'i': return sizeof(int);
+	case 'f': return sizeof(float);
+	case 'd': return sizeof(double);
+	case 'l': return sizeof(long long);
+	}
+	return 0;
+}
+
+//---------------------------------------------------------------------------
+
+// Write rows of values held by column as tab-separated text
+static void writeRows(ostream& out, const std::vector <char>& types,
+	const std::vector <std::vector <char> >& data, const int nrows)
+{
+	short h; int n; float f; double d; long long l;
+	int ncols = (int)types.size();
+	for (int r = 0; r < nrows; r++) {
+		for (int i = 0; i < ncols; i++) {
+			if (i > 0) out << "\t";
+			const char* p = data[i].data() + (size_t)r * colTypeSize(types[i]);
+			switch (types[i]) {
+			case 'h': memcpy(&h, p, sizeof(h)); out << h; break;
+			case 'i': memcpy(&n, p, sizeof(n)); out << n; break;
+			case 'f': memcpy(&f, p, sizeof(f)); out << f; break;
+			case 'd': memcpy(&d, p, sizeof(d)); out << d; break;
+			case 'l': memcpy(&l, p, sizeof(l)); out << l; break;
+			}
+		}
+		out << "\n";
+	}
+}
+
+// Write rows of values held by column as a block of a binary table
+// Each column is written either plain or, if shorter, run-length encoded (as are the
+// replicate and year, which are constant within a block, and the individual ID etc.
+// in long-format genetics)
+static void writeEncoded(ostream& out, const std::vector <char>& types,
+	const std::vector <std::vector <char> >& data, const int n)
+{
+	unsigned int nr = n;
+	unsigned int nruns, runlen;
+	char encoding;
+	out.write((const char*)&nr, sizeof(nr));
+	for (int i = 0; i < (int)data.size(); i++) {
+		size_t sz = colTypeSize(types[i]);
+		size_t len = (size_t)n * sz;
+		const char* d = data[i].data();
+		nruns = 1;
+		for (int r = 1; r < n; r++) {
+			if (memcmp(d + r * sz, d + (r - 1) * sz, sz) != 0) nruns++;
+		}
+		if (nruns * (sizeof(runlen) + sz) < len) {
+			encoding = 1;
+			out.write(&encoding, 1);
+			out.write((const char*)&nruns, sizeof(nruns));
+			runlen = 1;
+			for (int r = 1; r <= n; r++) {
+				if (r < n && memcmp(d + r * sz, d + (r - 1) * sz, sz) == 0) runlen++;
+				else {
+					out.write((const char*)&runlen, sizeof(runlen));
+					out.write(d + (r - 1) * sz, sz);
+					runlen = 1;
+				}
+			}
+		}
+		else {
+			encoding = 0;
+			out.write(&encoding, 1);
+			out.write(d, len);
+		}
+	}
+}
+
+// Copy formatted output into the buffer of a writer job
+static size_t fillBuffer(const std::ostringstream& out, std::vector <char>& buf) {
+	const string s = out.str();
+	buf.assign(s.begin(), s.end());
+	return buf.size();
+}
+
+// Rows handed by an outTable to the writer thread
+struct outBlock {
+	bool binary;
+	int nrows;
+	std::vector <char> types;
+	std::vector <std::vector <char> > data;
+};
+
+// Open tables which may hold rows not yet written (accessed by simulation thread only)
+static std::vector <outTable*> openTables;
+
+//---------------------------------------------------------------------------
+
+outTable::outTable(void) {
+	binary = deferred = false; col = nrows = 0;
+}
+
+outTable::~outTable(void) { }
+
+void outTable::open(const string name, const bool bin, const short codec,
+	const bool shard)
+{
+	binary = bin;
+	names.clear(); types.clear(); data.clear();
+	col = nrows = 0;
+	if (binary) file.open((name + ".rsb").c_str(), true, codec, shard);
+	else file.open((name + ".txt").c_str(), false, codec, shard);
+	deferred = file.buffered();
+	if (file.is_open()) openTables.push_back(this);
+}
+
+void outTable::close(void) {
+	if (!file.is_open()) return;
+	for (int i = 0; i < (int)openTables.size(); i++) {
+		if (openTables[i] == this) { openTables.erase(openTables.begin() + i); break; }
+	}
+	if ((binary || deferred) && nrows > 0) emit(nrows);
+	if (binary) {
+		unsigned int end = 0;
+		file.write((const char*)&end, sizeof(end));
+	}
+	file.close(); file.clear();
+}
+
+bool outTable::is_open(void) { return file.is_open(); }
+
+void outTable::column(const string name, const char type) {
+	names.push_back(name); types.push_back(type);
+}
+
+void outTable::endHeader(void) {
+	int ncols = (int)names.size();
+	if (binary) {
+		unsigned int bom = 0x01020304;
+		unsigned int n = ncols;
+		unsigned short len;
+		file.write(OUTTABLEMAGIC, 8);
+		file.write((const char*)&bom, sizeof(bom));
+		file.write((const char*)&n, sizeof(n));
+		for (int i = 0; i < ncols; i++) {
+			len = (unsigned short)names[i].size();
+			file.write(&types[i], 1);
+			file.write((const char*)&len, sizeof(len));
+			file.write(names[i].data(), len);
+		}
+	}
+	else {
+		for (int i = 0; i < ncols; i++) {
+			if (i > 0) file << "\t";
+			file << names[i];
+		}
+		file << endl;
+	}
+	if (binary || deferred) {
+		data.resize(ncols);
+		for (int i = 0; i < ncols; i++) data[i].reserve(colTypeSize(types[i]) * 1024);
+	}
+}
+
+// If rows are held, the value is stored in the column's type
+template <typename T> void outTable::put(const T value) {
+	if (binary || deferred) {
+		std::vector <char>& d = data[col];
+		size_t n = d.size();
+		switch (types[col]) {
+		case 'h': { short v = (short)value; d.resize(n + sizeof(v)); memcpy(&d[n], &v, sizeof(v)); break; }
+		case 'i': { int v = (int)value; d.resize(n + sizeof(v)); memcpy(&d[n], &v, sizeof(v)); break; }
+		case 'f': { float v = (float)value; d.resize(n + sizeof(v)); memcpy(&d[n], &v, sizeof(v)); break; }
+		case 'd': { double v = (double)value; d.resize(n + sizeof(v)); memcpy(&d[n], &v, sizeof(v)); break; }
+		case 'l': { long long v = (long long)value; d.resize(n + sizeof(v)); memcpy(&d[n], &v, sizeof(v)); break; }
+		}
+	}
+	else {
+		if (col > 0) file << "\t";
+		file << value;
+	}
+	col++;
+}
+
+outTable& outTable::operator<<(const short v) { put(v); return *this; }
+outTable& outTable::operator<<(const int v) { put(v); return *this; }
+outTable& outTable::operator<<(const float v) { put(v); return *this; }
+outTable& outTable::operator<<(const double v) { put(v); return *this; }
+outTable& outTable::operator<<(const long long v) { put(v); return *this; }
+
+void outTable::endRow(void) {
+	col = 0;
+	if (!binary && !deferred) { file << endl; return; }
+	// start a new block if the replicate or year has changed
+	if (nrows > 0 && data.size() >= 2) {
+		bool same = true;
+		for (int i = 0; i < 2; i++) {
+			size_t sz = colTypeSize(types[i]);
+			if (memcmp(&data[i][0], &data[i][(size_t)nrows * sz], sz) != 0) same = false;
+		}
+		if (!same) emit(nrows);
+	}
+	nrows++;
+	if (nrows >= OUTBLOCKROWS) emit(nrows);
+}
+
+void outTable::emit(const int n) {
+	if (!deferred) { // binary table written directly
+		writeEncoded(file, types, data, n);
+		for (int i = 0; i < (int)data.size(); i++)
+			data[i].erase(data[i].begin(), data[i].begin() + (size_t)n * colTypeSize(types[i]));
+		nrows -= n;
+		file.flush();
+		return;
+	}
+	// the block takes over the values of the first n rows, and any following row is
+	// copied back to begin the next block
+	std::shared_ptr <outBlock> block = std::make_shared <outBlock>();
+	block->binary = binary; block->nrows = n; block->types = types;
+	block->data.resize(data.size());
+	for (int i = 0; i < (int)data.size(); i++) {
+		size_t len = (size_t)n * colTypeSize(types[i]);
+		std::vector <char>& d = block->data[i];
+		d.swap(data[i]);
+		data[i].reserve(len);
+		data[i].assign(d.begin() + len, d.end());
+		d.resize(len);
+	}
+	nrows -= n;
+	file.writeDeferred([block](std::vector <char>& buf) {
+		std::ostringstream out;
+		if (block->binary) writeEncoded(out, block->types, block->data, block->nrows);
+		else writeRows(out, block->types, block->data, block->nrows);
+		return fillBuffer(out, buf);
+	});
+}
+
+void outTable::emitAll(void) {
+	for (int i = 0; i < (int)openTables.size(); i++) {
+		outTable* t = openTables[i];
+		if (t->deferred && t->nrows > 0) t->emit(t->nrows);
+	}
+}
+
+void outTable::memory(memUsage& m) {
+	for (int i = 0; i < (int)openTables.size(); i++) {
+		outTable* t = openTables[i];
+		m.objects[MEMOUTPUT]++;
+		for (int j = 0; j < (int)t->data.size(); j++)
+			m.bytes[MEMOUTPUT] += (long long)t->data[j].capacity();
+	}
+}
+
+//---------------------------------------------------------------------------
+
+inTable::inTable(void) { nrows = 0; }
+
+inTable::~inTable(void) { close(); }
+
+bool inTable::open(const string name) {
+	char magic[8];
+	unsigned int bom, ncols;
+	unsigned short len;
+	char type;
+	close();
+	file.open(name.c_str(), std::ios::binary);
+	if (!file.is_open()) return false;
+	file.read(magic, 8);
+	file.read((char*)&bom, sizeof(bom));
+	file.read((char*)&ncols, sizeof(ncols));
+	if (!file || memcmp(magic, OUTTABLEMAGIC, 8) != 0 || bom != 0x01020304) {
+		close(); return false;
+	}
+	for (unsigned int i = 0; i < ncols; i++) {
+		file.read(&type, 1);
+		file.read((char*)&len, sizeof(len));
+		string colname(len, ' ');
+		if (len > 0) file.read(&colname[0], len);
+		if (!file || colTypeSize(type) == 0) {
+			close(); return false;
+		}
+		names.push_back(colname); types.push_back(type);
+	}
+	data.resize(ncols);
+	return true;
+}
+
+void inTable::close(void) {
+	if (file.is_open()) file.close();
+	file.clear();
+	names.clear(); types.clear(); data.clear();
+	nrows = 0;
+}
+
+bool inTable::readBlock(void) {
+	unsigned int nr = 0;
+	nrows = 0;
+	if (!file.is_open()) return false;
+	file.read((char*)&nr, sizeof(nr));
+	if (!file || nr == 0) return false;
+	char encoding;
+	unsigned int nruns, runlen, r;
+	for (int i = 0; i < (int)data.size(); i++) {
+		size_t sz = colTypeSize(types[i]);
+		data[i].resize((size_t)nr * sz);
+		file.read(&encoding, 1);
+		if (encoding == 0) file.read(data[i].data(), data[i].size());
+		else { // run-length encoded
+			file.read((char*)&nruns, sizeof(nruns));
+			r = 0;
+			for (unsigned int j = 0; j < nruns && file; j++) {
+				file.read((char*)&runlen, sizeof(runlen));
+				if (runlen > nr - r) return false;
+				file.read(data[i].data() + r * sz, sz);
+				for (unsigned int k = 1; k < runlen; k++)
+					memcpy(data[i].data() + (r + k) * sz, data[i].data() + r * sz, sz);
+				r += runlen;
+			}
+			if (r != nr) return false;
+		}
+	}
+	if (!file) return false;
+	nrows = nr;
+	return true;
+}
+
+int inTable::nColumns(void) { return (int)names.size(); }
+string inTable::colName(const int i) { return names[i]; }
+char inTable::colType(const int i) { return types[i]; }
+int inTable::nRows(void) { return nrows; }
+
+void inTable::writeHeader(ostream& out) {
+	for (int i = 0; i < (int)names.size(); i++) {
+		if (i > 0) out << "\t";
+		out << names[i];
+	}
+	out << "\n";
+}
+
+void inTable::writeBlock(ostream& out) {
+	writeRows(out, types, data, nrows);
+}
+
+//---------------------------------------------------------------------------
+
+outGenMatrix::outGenMatrix(void) {
+	key[0] = key[1] = key[2] = 0;
+}
+
+outGenMatrix::~outGenMatrix(void) { }
+
+void outGenMatrix::open(const string name, const std::vector <int>& nloci, const bool diploid,
+	const short codec)
+{
+	ids.clear(); values.clear();
+	file.open((name + ".rsg").c_str(), true, codec);
+	unsigned int bom = 0x01020304;
+	unsigned int nchr = (unsigned int)nloci.size();
+	unsigned int n;
+	char ploidy = diploid ? 2 : 1;
+	file.write(OUTGENMAGIC, 8);
+	file.write((const char*)&bom, sizeof(bom));
+	file.write((const char*)&nchr, sizeof(nchr));
+	for (unsigned int i = 0; i < nchr; i++) {
+		n = nloci[i];
+		file.write((const char*)&n, sizeof(n));
+	}
+	file.write(&ploidy, 1);
+}
+
+void outGenMatrix::close(void) {
+	if (!file.is_open()) return;
+	if (!ids.empty()) writeBlock();
+	unsigned int end = 0;
+	file.write((const char*)&end, sizeof(end));
+	file.close(); file.clear();
+}
+
+bool outGenMatrix::is_open(void) { return file.is_open(); }
+
+void outGenMatrix::add(const int rep, const int year, const int spnum, const int id,
+	const std::vector <short>& alleles)
+{
+	if (!ids.empty()) {
+		if (rep != key[0] || year != key[1] || spnum != key[2]
+			|| values.size() + alleles.size() > OUTGENBLOCKVALS) writeBlock();
+	}
+	key[0] = rep; key[1] = year; key[2] = spnum;
+	ids.push_back(id);
+	values.insert(values.end(), alleles.begin(), alleles.end());
+}
+
+// Write a block of a packed allele matrix
+// The allele values are packed least significant bit first, each offset by the
+// minimum value of the block
+static void writePacked(ostream& out, const int* key, const std::vector <int>& ids,
+	const std::vector <short>& values)
+{
+	unsigned int tag = 1;
+	unsigned int ninds = (unsigned int)ids.size();
+	short minval = 0, maxval = 0;
+	unsigned char bits = 0;
+	if (!values.empty()) {
+		minval = maxval = values[0];
+		for (size_t i = 1; i < values.size(); i++) {
+			if (values[i] < minval) minval = values[i];
+			if (values[i] > maxval) maxval = values[i];
+		}
+	}
+	while (bits < 16 && ((int)maxval - (int)minval) >> bits) bits++;
+	out.write((const char*)&tag, sizeof(tag));
+	out.write((const char*)key, 3 * sizeof(int));
+	out.write((const char*)&ninds, sizeof(ninds));
+	out.write((const char*)&minval, sizeof(minval));
+	out.write((const char*)&bits, 1);
+	out.write((const char*)ids.data(), ninds * sizeof(int));
+	if (bits > 0) {
+		std::vector <unsigned char> packed(((size_t)bits * values.size() + 7) / 8, 0);
+		unsigned long long acc = 0;
+		int nacc = 0;
+		size_t j = 0;
+		for (size_t i = 0; i < values.size(); i++) {
+			acc |= (unsigned long long)(values[i] - minval) << nacc;
+			nacc += bits;
+			while (nacc >= 8) {
+				packed[j++] = (unsigned char)(acc & 0xFF);
+				acc >>= 8; nacc -= 8;
+			}
+		}
+		if (nacc > 0) packed[j] = (unsigned char)(acc & 0xFF);
+		out.write((const char*)packed.data(), packed.size());
+	}
+}
+
+// Alleles of a generation handed by an outGenMatrix to the writer thread
+struct outGenBlock {
+	int key[3];
+	std::vector <int> ids;
+	std::vector <short> values;
+};
+
+void outGenMatrix::writeBlock(void) {
+	if (!file.buffered()) {
+		writePacked(file, key, ids, values);
+		ids.clear(); values.clear();
+		file.flush();
+		return;
+	}
+	std::shared_ptr <outGenBlock> block = std::make_shared <outGenBlock>();
+	for (int i = 0; i < 3; i++) block->key[i] = key[i];
+	block->ids.swap(ids); block->values.swap(values);
+	file.writeDeferred([block](std::vector <char>& buf) {
+		std::ostringstream out;
+		writePacked(out, block->key, block->ids, block->values);
+		return fillBuffer(out, buf);
+	});
+}
+
+//---------------------------------------------------------------------------
+
+inGenMatrix::inGenMatrix(void) { diploid = false; nvals = 0; }
+
+inGenMatrix::~inGenMatrix(void) { close(); }
+
+bool inGenMatrix::open(const string name) {
+	char magic[8];
+	unsigned int bom, nchr, n;
+	char ploidy;
+	close();
+	file.open(name.c_str(), std::ios::binary);
+	if (!file.is_open()) return false;
+	file.read(magic, 8);
+	file.read((char*)&bom, sizeof(bom));
+	file.read((char*)&nchr, sizeof(nchr));
+	if (!file || memcmp(magic, OUTGENMAGIC, 8) != 0 || bom != 0x01020304) {
+		close(); return false;
+	}
+	for (unsigned int i = 0; i < nchr && file; i++) {
+		file.read((char*)&n, sizeof(n));
+		nloci.push_back(n);
+		nvals += n;
+	}
+	file.read(&ploidy, 1);
+	if (!file) { close(); return false; }
+	diploid = (ploidy == 2);
+	if (diploid) nvals *= 2;
+	return true;
+}
+
+void inGenMatrix::close(void) {
+	if (file.is_open()) file.close();
+	file.clear();
+	nloci.clear(); ids.clear(); values.clear();
+	nvals = 0;
+}
+
+bool inGenMatrix::readBlock(void) {
+	unsigned int tag = 0, ninds;
+	short minval;
+	unsigned char bits;
+	ids.clear(); values.clear();
+	if (!file.is_open()) return false;
+	file.read((char*)&tag, sizeof(tag));
+	if (!file || tag != 1) return false;
+	file.read((char*)key, 3 * sizeof(int));
+	file.read((char*)&ninds, sizeof(ninds));
+	file.read((char*)&minval, sizeof(minval));
+	file.read((char*)&bits, 1);
+	if (!file || bits > 16) return false;
+	ids.resize(ninds);
+	file.read((char*)ids.data(), ninds * sizeof(int));
+	values.assign((size_t)ninds * nvals, minval);
+	if (bits > 0) {
+		std::vector <unsigned char> packed(((size_t)bits * values.size() + 7) / 8);
+		file.read((char*)packed.data(), packed.size());
+		unsigned long long acc = 0;
+		int nacc = 0;
+		size_t j = 0;
+		unsigned int mask = (1u << bits) - 1;
+		for (size_t i = 0; i < values.size(); i++) {
+			while (nacc < bits) {
+				acc |= (unsigned long long)packed[j++] << nacc;
+				nacc += 8;
+			}
+			values[i] = (short)(minval + (int)(acc & mask));
+			acc >>= bits; nacc -= bits;
+		}
+	}
+	return (bool)file;
+}
+
+void inGenMatrix::writeHeader(ostream& out) {
+	out << "Rep\tYear\tSpecies\tIndID";
+	for (int i = 0; i < (int)nloci.size(); i++) {
+		for (int j = 0; j < nloci[i]; j++) {
+			out << "\tChr" << i << "Loc" << j << "Allele0";
+			if (diploid) out << "\tChr" << i << "Loc" << j << "Allele1";
+		}
+	}
+	out << "\n";
+}
+
+void inGenMatrix::writeBlock(ostream& out) {
+	for (int r = 0; r < (int)ids.size(); r++) {
+		out << key[0] << "\t" << key[1] << "\t" << key[2] << "\t" << ids[r];
+		const short* v = values.data() + (size_t)r * nvals;
+		for (int i = 0; i < nvals; i++) out << "\t" << v[i];
+		out << "\n";
+	}
+}
+
+//---------------------------------------------------------------------------
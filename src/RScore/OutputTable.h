@@ -0,0 +1,224 @@
+/*----------------------------------------------------------------------------
+ *	
+ *	Copyright (C) 2020 Greta Bocedi, Stephen C.F. Palmer, Justin M.J. Travis, Anne-Kathleen Malchow, Damaris Zurell 
+ *	
+ *	This file is part of RangeShifter.
+ *	
+ *	RangeShifter is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *	
+ *	RangeShifter is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *	GNU General Public License for more details.
+ *	
+ *	You should have received a copy of the GNU General Public License
+ *	along with RangeShifter. If not, see <https://www.gnu.org/licenses/>.
+ *	
+ --------------------------------------------------------------------------*/
+ 
+ 
+/*------------------------------------------------------------------------------
+
+RangeShifter v2.0 OutputTable
+
+Implements the outTable and inTable classes
+
+An outTable writes a result file of typed columns (the population, individuals and
+genetics files) either as tab-separated text or in a binary columnar format. Its
+columns are declared with their names and types before any record is written, and
+each record is then written field by field, in column order, with operator<<.
+
+If the file is buffered (see OutputWriter.h), the values of each record are only
+stored, in their columns' types, and the rows held are handed as an immutable block
+to the writer thread, which formats them as text (or encodes them) while the
+simulation continues. This happens whenever the replicate or year changes, when
+the block is full, when the file is closed, and for all tables at once when
+emitAll() is called, which the simulation does at the end of each year. Otherwise,
+a text table is formatted directly, record by record, on the simulation thread.
+
+The binary file opens with a self-describing schema, i.e. a magic string, a byte
+order mark and the name and type of each column, and continues with blocks of rows,
+in each of which the values of each column are held contiguously in the column's
+type, either plain or run-length encoded. A new block is started whenever the first
+two columns (replicate and year) change, or when the block reaches OUTBLOCKROWS
+rows, and the file ends with an empty block.
+
+An inTable reads a binary file, and can write it in exactly the text layout which
+the simulation would have written (as by the RangeShifter_convert tool). Values are
+therefore written to the binary file in the type in which they are written to text,
+so that both are formatted identically.
+
+Column types are 'h' (short), 'i' (int), 'f' (float), 'd' (double) and 'l' (long long).
+
+An outGenMatrix writes genetics as a packed allele matrix (.rsg), of which the
+blocks are likewise packed by the writer thread if the file is buffered. The file header
+gives the no. of loci on each chromosome and the ploidy, and each generation (i.e.
+replicate, year and species) is then written as a block headed by its no. of
+individuals and the minimum and bit width of its allele values, followed by the
+individual IDs and then every allele of every individual (in the column order of
+the genetics cross table), each packed into that bit width. An inGenMatrix reads
+the file and writes it as the genetics cross table text file.
+
+For full details of RangeShifter, please see:
+Bocedi G., Palmer S.C.F., Peer G., Heikkinen R.K., Matsinos Y.G., Watts K.
+and Travis J.M.J. (2014). RangeShifter: a platform for modelling spatial
+eco-evolutionary dynamics and species responses to environmental changes.
+Methods in Ecology and Evolution, 5, 388-396. doi: 10.1111/2041-210X.12162
+
+------------------------------------------------------------------------------*/
+
+#ifndef OutputTableH
+#define OutputTableH
+
+#include <cstring>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <vector>
+using namespace std;
+
+#include "OutputWriter.h"
+
+#define OUTTABLEMAGIC "RSTABLE1"	// first 8 bytes of a binary table file
+#define OUTBLOCKROWS 65536				// max. no. of rows in a block of a binary table
+#define OUTGENMAGIC "RSGENES1"		// first 8 bytes of a packed allele matrix file
+#define OUTGENBLOCKVALS 16777216	// max. no. of allele values in a block of a matrix
+
+//---------------------------------------------------------------------------
+
+class outTable {
+
+public:
+	outTable(void);
+	~outTable(void);
+	void open( // Open the file, with extension .txt (text) or .rsb (binary)
+		const string,	// file name, excluding extension
+		const bool,		// binary format?
+		const short,	// compression codec (see OutputWriter)
+		const bool = false	// one shard per replicate if files are sharded? (see OutputWriter)
+	);
+	void close(void);
+	bool is_open(void);
+	void column( // Declare the next column
+		const string,	// name
+		const char		// type
+	);
+	void endHeader(void); // Write the header once all columns are declared
+	outTable& operator<<(const short);
+	outTable& operator<<(const int);
+	outTable& operator<<(const float);
+	outTable& operator<<(const double);
+	outTable& operator<<(const long long);
+	void endRow(void);
+	static void emitAll(void); // Pass the rows held by all open tables to be written
+	static void memory( // Add the memory held by the rows of all open tables to a census
+		memUsage&
+	);
+
+private:
+	template <typename T> void put(const T);
+	void emit(const int); // Write (or pass to be written) the first n rows of the current block
+
+	outFile file;
+	bool binary;
+	bool deferred;	// rows are formatted by the writer thread
+	std::vector <string> names;
+	std::vector <char> types;
+	int col;		// column of the next field of the current row
+	int nrows;	// no. of complete rows in the current block
+	std::vector <std::vector <char> > data;	// current block's values for each column
+
+};
+
+//---------------------------------------------------------------------------
+
+class inTable {
+
+public:
+	inTable(void);
+	~inTable(void);
+	bool open(const string);	// Open a binary table file and read its schema
+	void close(void);
+	bool readBlock(void);	// Read the next block, returning false at the end of the file
+	int nColumns(void);
+	string colName(const int);
+	char colType(const int);
+	int nRows(void);		// no. of rows in the current block
+	void writeHeader(ostream&);	// Write the header as text
+	void writeBlock(ostream&);	// Write the current block as text
+
+private:
+	std::ifstream file;
+	std::vector <string> names;
+	std::vector <char> types;
+	int nrows;
+	std::vector <std::vector <char> > data;
+
+};
+
+//---------------------------------------------------------------------------
+
+class outGenMatrix {
+
+public:
+	outGenMatrix(void);
+	~outGenMatrix(void);
+	void open( // Open the file, with extension .rsg
+		const string,	// file name, excluding extension
+		const std::vector <int>&,	// no. of loci on each chromosome
+		const bool,		// diploid?
+		const short		// compression codec (see OutputWriter)
+	);
+	void close(void);
+	bool is_open(void);
+	void add( // Add an individual's alleles
+		const int,		// replicate
+		const int,		// year
+		const int,		// species number
+		const int,		// individual ID
+		const std::vector <short>&	// allele values
+	);
+
+private:
+	void writeBlock(void);
+
+	outFile file;
+	int key[3];	// replicate, year and species of the current block
+	std::vector <int> ids;
+	std::vector <short> values;
+
+};
+
+//---------------------------------------------------------------------------
+
+class inGenMatrix {
+
+public:
+	inGenMatrix(void);
+	~inGenMatrix(void);
+	bool open(const string);	// Open a packed allele matrix file and read its header
+	void close(void);
+	bool readBlock(void);	// Read the next block, returning false at the end of the file
+	void writeHeader(ostream&);	// Write the header of the genetics cross table
+	void writeBlock(ostream&);	// Write the current block as rows of the cross table
+
+private:
+	std::ifstream file;
+	std::vector <int> nloci;
+	bool diploid;
+	int nvals;	// no. of allele values per individual
+	int key[3];
+	std::vector <int> ids;
+	std::vector <short> values;
+
+};
+
+//---------------------------------------------------------------------------
+
+size_t colTypeSize(const char);
+
+//---------------------------------------------------------------------------
+#endif
@@ -0,0 +1,512 @@
+/*----------------------------------------------------------------------------
+ *	
+ *	Copyright (C) 2020 Greta Bocedi, Stephen C.F. Palmer, Justin M.J. Travis, Anne-Kathleen Malchow, Damaris Zurell 
+ *	
+ *	This file is part of RangeShifter.
+ *	
+ *	RangeShifter is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *	
+ *	RangeShifter is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *	GNU General Public License for more details.
+ *	
+ *	You should have received a copy of the GNU General Public License
+ *	along with RangeShifter. If not, see <https://www.gnu.org/licenses/>.
+ *	
+ --------------------------------------------------------------------------*/
+ 
+ 
+//---------------------------------------------------------------------------
+
+#include "OutputWriter.h"
+#include "MemoryAccount.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#if RS_ZLIB
+#include <zlib.h>
+#endif
+#if RS_ZSTD
+#include <zstd.h>
+#endif
+//---------------------------------------------------------------------------
+
+// Compressed stream of an output file
+class outCompressor {
+public:
+	virtual ~outCompressor(void) { }
+	// compress data to the file; action 0 = continue, 1 = flush, 2 = end the stream
+	// returns false if the data could not be compressed or written
+	virtual bool write(std::FILE*, const char*, const size_t, const short) = 0;
+};
+
+#if RS_ZLIB
+class gzipCompressor : public outCompressor {
+public:
+	gzipCompressor(void) {
+		zs.zalloc = Z_NULL; zs.zfree = Z_NULL; zs.opaque = Z_NULL;
+		// window bits of 15 + 16 for a gzip header and trailer
+		deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+		out.resize(262144);
+	}
+	~gzipCompressor(void) { deflateEnd(&zs); }
+	bool write(std::FILE* f, const char* data, const size_t len, const short action) {
+		int flush = Z_NO_FLUSH;
+		if (action == 1) flush = Z_SYNC_FLUSH;
+		if (action == 2) flush = Z_FINISH;
+		zs.next_in = (Bytef*)data; zs.avail_in = (uInt)len;
+		do {
+			zs.next_out = (Bytef*)out.data(); zs.avail_out = (uInt)out.size();
+			if (deflate(&zs, flush) == Z_STREAM_ERROR) return false;
+			size_t n = out.size() - zs.avail_out;
+			if (std::fwrite(out.data(), 1, n, f) != n) return false;
+		} while (zs.avail_out == 0);
+		return true;
+	}
+private:
+	z_stream zs;
+	std::vector <char> out;
+};
+#endif
+
+#if RS_ZSTD
+class zstdCompressor : public outCompressor {
+public:
+	zstdCompressor(void) {
+		cs = ZSTD_createCStream();
+		ZSTD_initCStream(cs, 3);
+		out.resize(ZSTD_CStreamOutSize());
+	}
+	~zstdCompressor(void) { ZSTD_freeCStream(cs); }
+	bool write(std::FILE* f, const char* data, const size_t len, const short action) {
+		ZSTD_EndDirective mode = ZSTD_e_continue;
+		if (action == 1) mode = ZSTD_e_flush;
+		if (action == 2) mode = ZSTD_e_end;
+		ZSTD_inBuffer in = { data, len, 0 };
+		size_t remaining;
+		do {
+			ZSTD_outBuffer o = { out.data(), out.size(), 0 };
+			remaining = ZSTD_compressStream2(cs, &o, &in, mode);
+			if (ZSTD_isError(remaining)) return false;
+			if (std::fwrite(out.data(), 1, o.pos, f) != o.pos) return false;
+		} while (mode == ZSTD_e_continue ? in.pos < in.size : remaining != 0);
+		return true;
+	}
+private:
+	ZSTD_CStream* cs;
+	std::vector <char> out;
+};
+#endif
+
+static outCompressor* newCompressor(const short codec) {
+#if RS_ZLIB
+	if (codec == OUTGZIP) return new gzipCompressor();
+#endif
+#if RS_ZSTD
+	if (codec == OUTZSTD) return new zstdCompressor();
+#endif
+	return 0;
+}
+
+// Write data to a file, compressed if required, and then flush or close the file,
+// returning false if any of it failed (e.g. the disk is full)
+static bool writeData(std::FILE* f, outCompressor* comp, const char* data, const size_t len,
+	const short action)
+{
+	bool ok = true;
+	if (comp != 0) ok = comp->write(f, data, len, action);
+	else {
+		if (len > 0 && std::fwrite(data, 1, len, f) != len) ok = false;
+	}
+	if (action == 1 && std::fflush(f) != 0) ok = false;
+	if (action == 2 && std::fclose(f) != 0) ok = false;
+	return ok;
+}
+
+//---------------------------------------------------------------------------
+
+// A buffer of records to be written by the writer thread, and then optionally
+// followed by flushing or closing the file
+// If the job has a formatter, the buffer is first filled by calling it
+struct outJob {
+	std::FILE* file;
+	outCompressor* comp;
+	std::vector <char> data;
+	size_t len;
+	short action;	// 0 = write, 1 = write and flush, 2 = write and close
+	outFormatter format;
+	bool* failed;	// error flag of the file, set if the job cannot be written
+};
+
+struct outShard {
+	int rep;
+	string file;		// name of the shard (excluding directory)
+	string merged;	// name of the file of which it is a shard
+};
+
+class OutputWriter {
+
+public:
+	OutputWriter(void);
+	~OutputWriter(void);
+	void submit(outJob&);
+	void getBuffer(std::vector <char>&);
+	void wait(void);
+	void addFile(outFileBuf*);
+	void removeFile(outFileBuf*);
+	void flushAll(void);
+	void flushIfDue(void);
+	void memory(memUsage&);
+	void setEngine(const size_t, const int, const bool);
+
+	size_t bufSize;	// size of each file's buffer (bytes), 0 for unbuffered output
+	int interval;	// interval at which open files are flushed (s), 0 for replicate end only
+	bool sharded;	// write a shard per replicate of files opened as shards?
+	int shardRep;	// replicate of shards opened subsequently
+	std::vector <outShard> shards;	// shards opened since the last index was written
+	int nFailed;	// no. of files closed since the last report which were not written in full
+
+private:
+	void run(void);
+
+	std::thread worker;
+	std::mutex mtx;
+	std::condition_variable cvWork, cvDone;
+	std::deque <outJob> jobs;
+	std::vector <std::vector <char> > pool;	// buffers available for re-use
+	bool busy, stop;
+	std::vector <outFileBuf*> files;	// open files (accessed by simulation thread only)
+	std::chrono::steady_clock::time_point lastFlush;
+
+};
+
+// The writer is constructed on first use, i.e. by the first outFile constructed,
+// and is therefore destroyed after all outFiles
+static OutputWriter& writer(void) {
+	static OutputWriter w;
+	return w;
+}
+
+OutputWriter::OutputWriter(void) {
+	bufSize = 1024 * 1024; interval = 0;
+	sharded = false; shardRep = 0; nFailed = 0;
+	busy = stop = false;
+	lastFlush = std::chrono::steady_clock::now();
+}
+
+OutputWriter::~OutputWriter(void) {
+	if (worker.joinable()) {
+		{
+			std::lock_guard <std::mutex> lock(mtx);
+			stop = true;
+		}
+		cvWork.notify_one();
+		worker.join();
+	}
+}
+
+void OutputWriter::submit(outJob& job) {
+	std::unique_lock <std::mutex> lock(mtx);
+	if (!worker.joinable()) worker = std::thread(&OutputWriter::run, this);
+	// limit the memory held by output waiting to be written
+	while (jobs.size() >= OUTQUEUEMAX) cvDone.wait(lock);
+	jobs.push_back(std::move(job));
+	lock.unlock();
+	cvWork.notify_one();
+}
+
+void OutputWriter::getBuffer(std::vector <char>& buf) {
+	{
+		std::lock_guard <std::mutex> lock(mtx);
+		while (!pool.empty()) {
+			buf.swap(pool.back()); pool.pop_back();
+			if (buf.size() == bufSize) return;
+		}
+	}
+	buf.assign(bufSize, 0);
+}
+
+// Wait until all submitted buffers have been written
+void OutputWriter::wait(void) {
+	std::unique_lock <std::mutex> lock(mtx);
+	while (busy || !jobs.empty()) cvDone.wait(lock);
+}
+
+void OutputWriter::run(void) {
+	outJob job;
+	std::unique_lock <std::mutex> lock(mtx);
+	while (true) {
+		while (!stop && jobs.empty()) cvWork.wait(lock);
+		if (jobs.empty()) break;
+		job = std::move(jobs.front()); jobs.pop_front();
+		busy = true;
+		lock.unlock();
+		if (job.format) {
+			job.len = job.format(job.data);
+			job.format = nullptr;
+		}
+		bool ok = writeData(job.file, job.comp, job.data.data(), job.len, job.action);
+		lock.lock();
+		if (!ok && job.failed != 0) *job.failed = true;
+		busy = false;
+		if (job.data.size() == bufSize) pool.push_back(std::move(job.data));
+		cvDone.notify_all();
+	}
+}
+
+// Buffers already in the pool and those still to be written are of the previous size,
+// so the settings are changed only once the writer thread is idle
+void OutputWriter::setEngine(const size_t bufsize, const int flushint, const bool shards) {
+	wait();
+	std::lock_guard <std::mutex> lock(mtx);
+	if (bufsize != bufSize) pool.clear();
+	bufSize = bufsize; interval = flushint; sharded = shards;
+}
+
+void OutputWriter::addFile(outFileBuf* f) { files.push_back(f); }
+
+void OutputWriter::removeFile(outFileBuf* f) {
+	for (int i = 0; i < (int)files.size(); i++) {
+		if (files[i] == f) { files.erase(files.begin() + i); return; }
+	}
+}
+
+void OutputWriter::flushAll(void) {
+	for (int i = 0; i < (int)files.size(); i++) files[i]->flushFile();
+	lastFlush = std::chrono::steady_clock::now();
+}
+
+void OutputWriter::flushIfDue(void) {
+	if (interval <= 0) return;
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	if (now - lastFlush >= std::chrono::seconds(interval)) flushAll();
+}
+
+// Buffers of open files, of records waiting to be written and available for re-use
+void OutputWriter::memory(memUsage& m) {
+	for (int i = 0; i < (int)files.size(); i++) {
+		m.objects[MEMOUTPUT]++; m.bytes[MEMOUTPUT] += (long long)files[i]->bufferSize();
+	}
+	std::lock_guard <std::mutex> lock(mtx);
+	for (int i = 0; i < (int)jobs.size(); i++) {
+		m.objects[MEMOUTPUT]++; m.bytes[MEMOUTPUT] += (long long)jobs[i].data.capacity();
+	}
+	for (int i = 0; i < (int)pool.size(); i++) {
+		m.objects[MEMOUTPUT]++; m.bytes[MEMOUTPUT] += (long long)pool[i].capacity();
+	}
+}
+
+//---------------------------------------------------------------------------
+
+outFileBuf::outFileBuf(void) {
+	file = 0; comp = 0; async = false; failed = false;
+}
+
+outFileBuf::~outFileBuf(void) {
+	close();
+}
+
+bool outFileBuf::open(const char* name, const bool binary, const short codec) {
+	close();
+	file = std::fopen(name, (binary || codec != OUTNOCOMP) ? "wb" : "w");
+	if (file == 0) return false;
+	failed = false;
+	if (codec != OUTNOCOMP) comp = newCompressor(codec);
+	OutputWriter& w = writer();
+	async = w.bufSize > 0;
+	if (async) w.getBuffer(buffer);
+	else buffer.assign(65536, 0);
+	setp(buffer.data(), buffer.data() + buffer.size());
+	w.addFile(this);
+	return true;
+}
+
+// Pass the buffered records to the writer thread, and replace the buffer
+void outFileBuf::submit(const short action) {
+	outJob job;
+	job.file = file; job.comp = comp; job.len = pptr() - pbase(); job.action = action;
+	job.failed = &failed;
+	job.data.swap(buffer);
+	OutputWriter& w = writer();
+	w.submit(job);
+	if (action == 2) buffer.clear();
+	else w.getBuffer(buffer);
+	setp(buffer.data(), buffer.data() + buffer.size());
+}
+
+// Returns false if the file was not written in full
+bool outFileBuf::close(void) {
+	if (file == 0) return true;
+	OutputWriter& w = writer();
+	w.removeFile(this);
+	if (async) {
+		submit(2);
+		w.wait(); // after which the writer thread no longer sets the error flag
+	}
+	else if (!writeData(file, comp, pbase(), pptr() - pbase(), 2)) failed = true;
+	if (comp != 0) { delete comp; comp = 0; }
+	file = 0;
+	buffer.clear(); buffer.shrink_to_fit();
+	setp(0, 0);
+	if (failed) w.nFailed++;
+	return !failed;
+}
+
+bool outFileBuf::is_open(void) { return file != 0; }
+
+bool outFileBuf::buffered(void) { return file != 0 && async; }
+
+size_t outFileBuf::bufferSize(void) { return buffer.capacity(); }
+
+// The records already in the buffer are passed to the writer thread first, so that
+// the file is written in order
+void outFileBuf::writeDeferred(const outFormatter& format) {
+	if (file == 0) return;
+	if (async) {
+		if (pptr() > pbase()) submit(0);
+		outJob job;
+		job.file = file; job.comp = comp; job.len = 0; job.action = 0;
+		job.format = format; job.failed = &failed;
+		writer().submit(job);
+	}
+	else {
+		std::vector <char> data;
+		size_t len = format(data);
+		if (!writeData(file, comp, pbase(), pptr() - pbase(), 0)) failed = true;
+		setp(buffer.data(), buffer.data() + buffer.size());
+		if (!writeData(file, comp, data.data(), len, 0)) failed = true;
+	}
+}
+
+void outFileBuf::flushFile(void) {
+	if (file == 0) return;
+	if (async) submit(1);
+	else sync();
+}
+
+outFileBuf::int_type outFileBuf::overflow(int_type c) {
+	if (file == 0) return traits_type::eof();
+	if (async) submit(0);
+	else {
+		if (!writeData(file, comp, pbase(), pptr() - pbase(), 0)) failed = true;
+		setp(buffer.data(), buffer.data() + buffer.size());
+	}
+	if (!traits_type::eq_int_type(c, traits_type::eof())) {
+		*pptr() = traits_type::to_char_type(c);
+		pbump(1);
+	}
+	return traits_type::not_eof(c);
+}
+
+// Called for std::endl (or flush()), which writes the record immediately only for
+// unbuffered output
+int outFileBuf::sync(void) {
+	if (file == 0 || async) return 0;
+	if (!writeData(file, comp, pbase(), pptr() - pbase(), 1)) failed = true;
+	setp(buffer.data(), buffer.data() + buffer.size());
+	return failed ? -1 : 0;
+}
+
+//---------------------------------------------------------------------------
+
+outFile::outFile(void) : std::ostream(&buf) {
+	writer();
+}
+
+outFile::~outFile(void) { }
+
+void outFile::open(const char* name, const bool binary, const short codec,
+	const bool shard)
+{
+	OutputWriter& w = writer();
+	string fullname = name;
+	string merged;
+	if (shard && w.sharded) {
+		// insert the replicate before the file type, i.e. the last part of the name
+		size_t dir = fullname.find_last_of("/\\");
+		size_t ix = fullname.find_last_of('_');
+		if (ix != string::npos && (dir == string::npos || ix > dir)) {
+			merged = fullname;
+			fullname.insert(ix, "_Rep" + to_string(w.shardRep));
+		}
+	}
+	string ext;
+	if (codec == OUTGZIP) ext = ".gz";
+	if (codec == OUTZSTD) ext = ".zst";
+	fullname += ext;
+	if (buf.open(fullname.c_str(), binary, codec)) {
+		clear();
+		if (!merged.empty()) {
+			outShard s;
+			size_t dir = fullname.find_last_of("/\\");
+			s.rep = w.shardRep;
+			s.file = dir == string::npos ? fullname : fullname.substr(dir + 1);
+			s.merged = (dir == string::npos ? merged : merged.substr(dir + 1)) + ext;
+			w.shards.push_back(s);
+		}
+	}
+	else setstate(std::ios_base::failbit);
+}
+
+void outFile::close(void) {
+	if (!buf.is_open()) setstate(std::ios_base::failbit);
+	if (!buf.close()) setstate(std::ios_base::badbit);
+}
+
+bool outFile::is_open(void) { return buf.is_open(); }
+
+bool outFile::buffered(void) { return buf.buffered(); }
+
+void outFile::writeDeferred(const outFormatter& format) { buf.writeDeferred(format); }
+
+bool outFile::codecAvailable(const short codec) {
+	if (codec == OUTNOCOMP) return true;
+#if RS_ZLIB
+	if (codec == OUTGZIP) return true;
+#endif
+#if RS_ZSTD
+	if (codec == OUTZSTD) return true;
+#endif
+	return false;
+}
+
+void outFile::setEngine(simEngine e) {
+	writer().setEngine((size_t)e.outBuffer * 1024, e.outFlush, e.outShards != 0);
+}
+
+int outFile::writeErrors(void) {
+	OutputWriter& w = writer();
+	int n = w.nFailed;
+	w.nFailed = 0;
+	return n;
+}
+
+void outFile::setReplicate(const int rep) { writer().shardRep = rep; }
+
+bool outFile::writeShardIndex(const string name) {
+	OutputWriter& w = writer();
+	if (w.shards.empty()) return true;
+	std::ofstream index(name.c_str());
+	index << "Rep\tShard\tFile" << endl;
+	for (int i = 0; i < (int)w.shards.size(); i++)
+		index << w.shards[i].rep << "\t" << w.shards[i].file << "\t" << w.shards[i].merged << endl;
+	w.shards.clear();
+	index.close();
+	return !index.fail();
+}
+
+void outFile::flushAll(void) { writer().flushAll(); }
+
+void outFile::flushIfDue(void) { writer().flushIfDue(); }
+
+void outFile::memory(memUsage& m) { writer().memory(m); }
+
+//---------------------------------------------------------------------------
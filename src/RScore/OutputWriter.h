@@ -0,0 +1,167 @@
+/*----------------------------------------------------------------------------
+ *	
+ *	Copyright (C) 2020 Greta Bocedi, Stephen C.F. Palmer, Justin M.J. Travis, Anne-Kathleen Malchow, Damaris Zurell 
+ *	
+ *	This file is part of RangeShifter.
+ *	
+ *	RangeShifter is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *	
+ *	RangeShifter is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *	GNU General Public License for more details.
+ *	
+ *	You should have received a copy of the GNU General Public License
+ *	along with RangeShifter. If not, see <https://www.gnu.org/licenses/>.
+ *	
+ --------------------------------------------------------------------------*/
+ 
+ 
+/*------------------------------------------------------------------------------
+
+RangeShifter v2.0 OutputWriter
+
+Implements the outFile class
+
+An output file stream to replace std::ofstream for the simulation's result files.
+Records are formatted on the simulation thread into a large buffer for each file,
+and filled buffers are passed to a single background thread which writes them, so
+that output does not wait on the file system. std::endl does not flush the file;
+instead, all open files are flushed at the end of each replicate and, optionally,
+at a regular interval, and a file is completely written before close() returns.
+Buffers are recycled between files.
+
+If the buffer size is set to zero, records are written directly on the simulation
+thread and each is flushed as before.
+
+A file may also be written as a compressed stream (gzip, if built with zlib, i.e.
+RS_ZLIB is defined, or zstd, if built with RS_ZSTD), in which case the buffers are
+compressed by the writer thread. Flushing a compressed file completes the stream
+up to the last record written, so that it may be read while the simulation runs.
+
+Records need not be formatted on the simulation thread: writeDeferred() queues a
+function which the writer thread calls to format a block of records (e.g. a
+snapshot of values held by an outTable, see OutputTable.h) immediately before
+writing it, in turn with the file's other output.
+
+Files which would otherwise hold the records of all replicates of a simulation may
+instead be written as a shard per replicate, named as the file but with _Rep<r>
+inserted before the file type (e.g. Batch1_Sim1_Land1_Rep0_Pop.txt), as are the
+individuals and genetics files. Each shard is listed in an index file, from which
+the RangeShifter_merge tool reassembles the single file of the simulation.
+
+For full details of RangeShifter, please see:
+Bocedi G., Palmer S.C.F., Peer G., Heikkinen R.K., Matsinos Y.G., Watts K.
+and Travis J.M.J. (2014). RangeShifter: a platform for modelling spatial
+eco-evolutionary dynamics and species responses to environmental changes.
+Methods in Ecology and Evolution, 5, 388-396. doi: 10.1111/2041-210X.12162
+
+------------------------------------------------------------------------------*/
+
+#ifndef OutputWriterH
+#define OutputWriterH
+
+#include <cstdio>
+#include <functional>
+#include <ostream>
+#include <streambuf>
+#include <vector>
+using namespace std;
+
+#include "Parameters.h"
+
+#define OUTQUEUEMAX 16	// max. no. of buffers awaiting the writer thread
+
+// Compression codecs
+#define OUTNOCOMP 0
+#define OUTGZIP 1
+#define OUTZSTD 2
+
+class outCompressor;
+struct memUsage;
+
+// A function which formats a block of records into a buffer, returning their length
+typedef std::function <size_t(std::vector <char>&)> outFormatter;
+
+//---------------------------------------------------------------------------
+
+class outFileBuf : public std::streambuf {
+
+public:
+	outFileBuf(void);
+	~outFileBuf(void);
+	bool open(const char*, const bool, const short);
+	bool close(void);	// returns false if the file was not written in full
+	bool is_open(void);
+	bool buffered(void);
+	void flushFile(void); // pass buffered records to be written and flush the file
+	void writeDeferred(const outFormatter&);
+	size_t bufferSize(void);
+
+protected:
+	int_type overflow(int_type);
+	int sync(void);
+
+private:
+	void submit(const short);
+
+	std::FILE* file;
+	outCompressor* comp;	// compressor of a compressed file, otherwise 0
+	std::vector <char> buffer;
+	bool async;	// pass buffers to the writer thread? otherwise write directly
+	bool failed;	// has writing, flushing or closing the file failed?
+								// (set by the writer thread while buffers are pending)
+
+};
+
+//---------------------------------------------------------------------------
+
+class outFile : public std::ostream {
+
+public:
+	outFile(void);
+	~outFile(void);
+	void open( // Open the file, appending .gz or .zst to its name if compressed
+		const char*,		// file name
+		const bool = false,	// binary mode?
+		const short = OUTNOCOMP,	// compression codec
+		const bool = false	// one shard per replicate if files are sharded?
+	);
+	void close(void);
+	bool is_open(void);
+	bool buffered(void); // Are records written by the writer thread?
+	void writeDeferred( // Write a block of records formatted by the writer thread
+		const outFormatter&	// function to format the records (on the writer thread
+												// if buffered, otherwise immediately)
+	);
+	static bool codecAvailable(const short); // Is a compression codec available in this build?
+
+	static void setEngine( // Set buffer size, flush interval and sharding for files opened subsequently
+		simEngine
+	);
+	static void setReplicate( // Set the replicate of shards opened subsequently
+		const int
+	);
+	static bool writeShardIndex( // Write the index of shards opened since the last index,
+															 // if any, and clear it
+		const string	// index file name
+	);
+	static int writeErrors(void); // No. of files closed since the last call which were
+																// not written in full (e.g. the disk was full)
+	static void flushAll(void); // Flush all open files
+	static void flushIfDue(void); // Flush all open files if the flush interval has elapsed
+	static void memory( // Add the memory held by file buffers and records waiting to be
+										// written to a census
+		memUsage&
+	);
+
+private:
+	outFileBuf buf;
+
+};
+
+//---------------------------------------------------------------------------
+#endif
@@ -222,7 +222,7 @@ paramSim::paramSim(void) {
 	slowFactor = 1;
 	batchMode = absorbing = false;
 	outRange = outOccup = outPop = outInds = false;
-	outGenetics = outGenXtab = false; outGenType = 0;
+	outGenetics = outGenXtab = false; outGenType = 0; outGenForm = 0;
 	outTraitsCells = outTraitsRows = outConnect = false;
 	saveMaps = false; saveTraitMaps = false;
 	saveVisits = false;
@@ -233,6 +233,10 @@ paramSim::paramSim(void) {
 	drawLoaded = false;
 	viewLand = false; viewPatch = false; viewGrad = false; viewCosts = false;
 	viewPop = false; viewTraits = false; viewPaths = false; viewGraph = false;
+	kernSampler = 0; outBuffer = 1024; outFlush = 0; outFormat = 0;
+	compPop = compInds = compGenetics = compRange = compConnect = compTraits = 0;
+	dispStats = 0; threads = 0; outShards = 0; profile = 0;
+	memReport = 0; preflight = 0; memLimit = 0; statusInt = 0;
 	dir = ' ';
 }
 
@@ -253,6 +257,7 @@ void paramSim::setSim(simParams s) {
 		outGenType = s.outGenType;
 	}
 	outGenXtab = s.outGenXtab;
+	if (s.outGenForm >= 0 && s.outGenForm <= 3) outGenForm = s.outGenForm;
 	outTraitsCells = s.outTraitsCells; outTraitsRows = s.outTraitsRows;
 	outConnect = s.outConnect;
 	if (s.outStartPop >= 0) outStartPop = s.outStartPop;
@@ -287,6 +292,7 @@ simParams paramSim::getSim(void) {
 	s.simulation = simulation; s.reps = reps; s.years = years;
 	s.outRange = outRange; s.outOccup = outOccup; s.outPop = outPop; s.outInds = outInds;
 	s.outGenetics = outGenetics; s.outGenType = outGenType; s.outGenXtab = outGenXtab;
+	s.outGenForm = outGenForm;
 	s.outTraitsCells = outTraitsCells; s.outTraitsRows = outTraitsRows; s.outConnect = outConnect;
 	s.outStartPop = outStartPop; s.outStartInd = outStartInd; s.outStartGenetic = outStartGenetic;
 	s.outStartTraitCell = outStartTraitCell; s.outStartTraitRow = outStartTraitRow;
@@ -333,6 +339,40 @@ simView paramSim::getViews(void) {
 	return v;
 }
 
+void paramSim::setEngine(simEngine e) {
+	if (e.kernSampler >= 0 && e.kernSampler <= 2) kernSampler = e.kernSampler;
+	if (e.outBuffer >= 0) outBuffer = e.outBuffer;
+	if (e.outFlush >= 0) outFlush = e.outFlush;
+	if (e.outFormat >= 0 && e.outFormat <= 1) outFormat = e.outFormat;
+	if (e.compPop >= 0 && e.compPop <= 2) compPop = e.compPop;
+	if (e.compInds >= 0 && e.compInds <= 2) compInds = e.compInds;
+	if (e.compGenetics >= 0 && e.compGenetics <= 2) compGenetics = e.compGenetics;
+	if (e.compRange >= 0 && e.compRange <= 2) compRange = e.compRange;
+	if (e.compConnect >= 0 && e.compConnect <= 2) compConnect = e.compConnect;
+	if (e.compTraits >= 0 && e.compTraits <= 2) compTraits = e.compTraits;
+	if (e.dispStats >= 0) dispStats = e.dispStats;
+	if (e.threads >= 0) threads = e.threads;
+	if (e.outShards >= 0 && e.outShards <= 1) outShards = e.outShards;
+	if (e.profile >= 0 && e.profile <= 1) profile = e.profile;
+	if (e.memReport >= 0 && e.memReport <= 1) memReport = e.memReport;
+	if (e.preflight >= 0 && e.preflight <= 2) preflight = e.preflight;
+	if (e.memLimit >= 0) memLimit = e.memLimit;
+	if (e.statusInt >= 0) statusInt = e.statusInt;
+}
+
+simEngine paramSim::getEngine(void) {
+	simEngine e;
+	e.kernSampler = kernSampler;
+	e.outBuffer = outBuffer; e.outFlush = outFlush; e.outFormat = outFormat;
+	e.compPop = compPop; e.compInds = compInds; e.compGenetics = compGenetics;
+	e.compRange = compRange; e.compConnect = compConnect; e.compTraits = compTraits;
+	e.dispStats = dispStats; e.threads = threads; e.outShards = outShards;
+	e.profile = profile; e.memReport = memReport;
+	e.preflight = preflight; e.memLimit = memLimit;
+	e.statusInt = statusInt;
+	return e;
+}
+
 void paramSim::setDir(string s) {
 	dir = s;
 }
@@ -65,6 +65,7 @@ using namespace std;
 
 #define NSTAGES 10		// maximum number of stages permitted
 #define NSEXES 2			// maximum number of sexes permitted
+#define MAXMEMSIZE 14	// maximum SMS memory size (no. of steps)
 #define PARAMDEBUG 0
 #define NTRAITS 18		// maximum number of variable traits which can be displayed
 											// in GUI (VCL version)
@@ -282,7 +283,7 @@ struct simParams {
 	int mapInt; int traitInt;
 	bool batchMode; bool absorbing;
 	bool outRange; bool outOccup; bool outPop; bool outInds;
-	bool outGenetics; short outGenType; bool outGenXtab;
+	bool outGenetics; short outGenType; bool outGenXtab; short outGenForm;
 	bool outTraitsCells; bool outTraitsRows; bool outConnect;
 	bool saveMaps;
 	bool drawLoaded; bool saveTraitMaps;
@@ -299,6 +300,28 @@ struct simView {
 	int slowFactor;
 };
 
+// Optional engine settings, which do not alter the model being simulated but only
+// the way in which it is computed (read from the end of the batch Control file)
+struct simEngine {
+	short kernSampler;	// dispersal kernel sampler: 0 = rejection, 1 = tabulated destinations,
+											// 2 = as 1 plus precomputed outcomes for each patch (patch-based model)
+	int outBuffer;			// size of each output file's buffer (KB), 0 = write each record directly
+	int outFlush;				// interval at which output files are flushed (s), 0 = at end of replicate
+	short outFormat;		// format of population, individuals and genetics files:
+											// 0 = tab-separated text, 1 = binary columnar (see OutputTable)
+	// compression codec of each type of output file: 0 = none, 1 = gzip, 2 = zstd
+	short compPop, compInds, compGenetics, compRange, compConnect, compTraits;
+	int dispStats;			// interval at which dispersal statistics are written (years), 0 = none
+	int threads;				// no. of threads for computing trait summaries, 0 = one per processor
+	short outShards;		// write files holding all replicates as one shard per replicate? 0 = no, 1 = yes
+	short profile;			// time the phases of each year and write them to a profile file? 0 = no, 1 = yes
+	short memReport;		// account for memory by subsystem and write it to a memory file? 0 = no, 1 = yes
+	short preflight;		// estimate the resources needed before running the batch:
+											// 0 = no, 1 = yes, and refuse a batch which would not fit, 2 = estimate only
+	int memLimit;				// memory available to the batch (MB), 0 = physical memory of the node
+	int statusInt;			// interval at which the status file is written (s), 0 = none
+};
+
 class paramSim {
 
 public:
@@ -309,6 +332,8 @@ public:
 	int getSimNum(void);
 	void setViews(simView);
 	simView getViews(void);
+	void setEngine(simEngine);
+	simEngine getEngine(void);
 	void setDir(string);
 	string getDir(int);
 #if RS_RCPP
@@ -351,6 +376,8 @@ private:
 	short outGenType;				// produce output genetics for: 0 = juveniles only
 													// 1 = all individuals, 2 = adults (i.e. final stage) only
 	bool outGenXtab;				// produce output genetics as a cross table?
+	short outGenForm;				// form of output genetics: 0 = one row per locus, 1 = cross table,
+													// 2 = packed allele matrix, 3 = allele frequencies by population
 	bool outTraitsCells;		// produce output summary traits by cell file?
 	bool outTraitsRows;			// produce output summary traits by row (y) file?
 	bool outConnect;				// produce output connectivity file?
@@ -373,6 +400,20 @@ private:
 	bool viewTraits;				// view summary traits map(s) on screen?
 	bool viewPaths;					// view individual movement paths on screen?
 	bool viewGraph;					// view population/occupancy graph on screen?
+	short kernSampler;			// dispersal kernel sampler (see simEngine)
+	int outBuffer;					// output file buffer size (KB) (see simEngine)
+	int outFlush;						// output file flush interval (s) (see simEngine)
+	short outFormat;				// population, individuals and genetics file format (see simEngine)
+	short compPop, compInds, compGenetics;	// output file compression codecs (see simEngine)
+	short compRange, compConnect, compTraits;
+	int dispStats;					// dispersal statistics interval (years) (see simEngine)
+	int threads;						// no. of computing threads (see simEngine)
+	short outShards;				// output files sharded by replicate (see simEngine)
+	short profile;					// phases of each year timed (see simEngine)
+	short memReport;				// memory accounted by subsystem (see simEngine)
+	short preflight;				// resources estimated before the batch (see simEngine)
+	int memLimit;						// memory available to the batch (MB) (see simEngine)
+	int statusInt;					// status file interval (s) (see simEngine)
 	string dir;							// full name of working directory
 
 };
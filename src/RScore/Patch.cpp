@@ -284,6 +284,18 @@ if (ncells > 0) {
 return pCell;
 }
 
+// Return mean environmental value of the cells in the patch
+// Unlike getRandomCell(), this draws no random number, and so may be used for output
+// For a cell-based model, this will be the value of the only Cell
+float Patch::getMeanEnvVal(void) {
+int ncells = (int)cells.size();
+if (ncells == 1) return cells[0]->getEnvVal();
+double sum = 0.0;
+for (int i = 0; i < ncells; i++) sum += cells[i]->getEnvVal();
+if (ncells > 0) return (float)(sum / (double)ncells);
+else return 0.0;
+}
+
 // Remove a cell from the patch
 void Patch::removeCell(Cell* pCell) {
 int ncells = (int)cells.size();
@@ -350,6 +362,12 @@ if (sex >= 0 && sex < NSEXES) return nTemp[sex];
 else return 0;
 }
 
+void Patch::memory(memUsage& m) {
+m.objects[MEMPATCHES]++;
+m.bytes[MEMPATCHES] += sizeof(Patch) + cells.capacity() * sizeof(Cell*)
+	+ popns.capacity() * sizeof(patchPopn);
+}
+
 //---------------------------------------------------------------------------
 //---------------------------------------------------------------------------
 //---------------------------------------------------------------------------
@@ -111,6 +111,7 @@ public:
 		Cell*	// pointer to the Cell to be removed from the Patch
 	);
 	Cell* getRandomCell(void);
+	float getMeanEnvVal(void); // Return mean environmental value of the cells in the patch
 	void setSubComm(
 		intptr		// pointer to the Sub-community cast as an integer
 	);
@@ -143,6 +144,9 @@ public:
 	float getK(void);
 	// dummy function for batch version
 	void drawCells(float,int,rgb);
+	void memory( // Add the memory held by the patch and its cell vector to a census
+		memUsage&
+	);
 
 	private:
 	int patchSeqNum;// sequential patch number - patch 0 is reserved for the inter-patch matrix
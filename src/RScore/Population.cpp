@@ -25,8 +25,11 @@
 #include "Population.h"
 //---------------------------------------------------------------------------
 
-ofstream outPop;
-ofstream outInds;
+outTable outPop;
+outTable outInds;
+outTable outGenFreq;
+static std::vector <locn> genFreqLoci;	// chromosome (x) and locus (y) of each allele column
+static short genFreqPloidy;
 
 //---------------------------------------------------------------------------
 
@@ -206,9 +209,10 @@ Population::~Population(void) {
 	juvs.clear();
 }
 
-traitsums Population::getTraits(Species* pSpecies) {
-	int g;
-	traitsums ts;
+//---------------------------------------------------------------------------
+
+// Set all sums of trait genes to zero
+void clearTraits(traitsums& ts) {
 	for (int i = 0; i < NSEXES; i++) {
 		ts.ninds[i] = 0;
 		ts.sumD0[i] = ts.ssqD0[i] = 0.0;
@@ -223,7 +227,36 @@ traitsums Population::getTraits(Species* pSpecies) {
 		ts.sumS0[i] = ts.ssqS0[i] = 0.0;
 		ts.sumAlphaS[i] = ts.ssqAlphaS[i] = 0.0; ts.sumBetaS[i] = ts.ssqBetaS[i] = 0.0;
 	}
+}
+
+// Add the second set of sums of trait genes to the first
+void addTraits(traitsums& ts, const traitsums& x) {
+	for (int s = 0; s < NSEXES; s++) {
+		ts.ninds[s] += x.ninds[s];
+		ts.sumD0[s] += x.sumD0[s];     ts.ssqD0[s] += x.ssqD0[s];
+		ts.sumAlpha[s] += x.sumAlpha[s];  ts.ssqAlpha[s] += x.ssqAlpha[s];
+		ts.sumBeta[s] += x.sumBeta[s];   ts.ssqBeta[s] += x.ssqBeta[s];
+		ts.sumDist1[s] += x.sumDist1[s];  ts.ssqDist1[s] += x.ssqDist1[s];
+		ts.sumDist2[s] += x.sumDist2[s];  ts.ssqDist2[s] += x.ssqDist2[s];
+		ts.sumProp1[s] += x.sumProp1[s];  ts.ssqProp1[s] += x.ssqProp1[s];
+		ts.sumDP[s] += x.sumDP[s];     ts.ssqDP[s] += x.ssqDP[s];
+		ts.sumGB[s] += x.sumGB[s];     ts.ssqGB[s] += x.ssqGB[s];
+		ts.sumAlphaDB[s] += x.sumAlphaDB[s]; ts.ssqAlphaDB[s] += x.ssqAlphaDB[s];
+		ts.sumBetaDB[s] += x.sumBetaDB[s];  ts.ssqBetaDB[s] += x.ssqBetaDB[s];
+		ts.sumStepL[s] += x.sumStepL[s];  ts.ssqStepL[s] += x.ssqStepL[s];
+		ts.sumRho[s] += x.sumRho[s];    ts.ssqRho[s] += x.ssqRho[s];
+		ts.sumS0[s] += x.sumS0[s];     ts.ssqS0[s] += x.ssqS0[s];
+		ts.sumAlphaS[s] += x.sumAlphaS[s]; ts.ssqAlphaS[s] += x.ssqAlphaS[s];
+		ts.sumBetaS[s] += x.sumBetaS[s];  ts.ssqBetaS[s] += x.ssqBetaS[s];
+	}
+}
+
+//---------------------------------------------------------------------------
 
+// Add the trait genes of all Individuals to the sums
+// Only reads the Individuals, so may be called concurrently for different Populations
+void Population::getTraits(Species* pSpecies, traitsums& ts) {
+	int g;
 	demogrParams dem = pSpecies->getDemogr();
 	emigRules emig = pSpecies->getEmig();
 	trfrRules trfr = pSpecies->getTrfr();
@@ -263,8 +296,6 @@ traitsums Population::getTraits(Species* pSpecies) {
 		ts.sumAlphaS[g] += s.alpha; ts.ssqAlphaS[g] += s.alpha * s.alpha;
 		ts.sumBetaS[g] += s.beta;   ts.ssqBetaS[g] += s.beta * s.beta;
 	}
-
-	return ts;
 }
 
 int Population::getNInds(void) { return (int)inds.size(); }
@@ -801,6 +832,29 @@ disperser Population::extractSettler(int ix) {
 	return d;
 }
 
+// Record the outcome of dispersal of all individuals (of the matrix population)
+// in the dispersal statistics
+void Population::recordDispersal(void) {
+	int ninds = (int)inds.size();
+	for (int i = 0; i < ninds; i++) {
+		if (inds[i] != 0) dispStats.record(inds[i]);
+	}
+}
+
+void Population::memory(memUsage& m) {
+	m.objects[MEMPOPNS]++;
+	m.bytes[MEMPOPNS] += sizeof(Population)
+		+ (inds.capacity() + juvs.capacity()) * sizeof(Individual*);
+	int ninds = (int)inds.size();
+	for (int i = 0; i < ninds; i++) {
+		if (inds[i] != 0) inds[i]->memory(m);
+	}
+	ninds = (int)juvs.size();
+	for (int i = 0; i < ninds; i++) {
+		if (juvs[i] != 0) juvs[i]->memory(m);
+	}
+}
+
 // Add a specified individual to the new/current dispersal group
 // Add a specified individual to the population
 void Population::recruit(Individual* pInd) {
@@ -838,18 +892,14 @@ int Population::transfer(Landscape* pLandscape, short landIx)
 	settleRules sett;
 	settleTraits settDD;
 	settlePatch settle;
-	simParams sim = paramsSim->getSim();
 
 	// each individual takes one step
 	// for dispersal by kernel, this should be the only step taken
+	// (the step routine is specialised for the simulation's transfer rules)
+	Individual::trfrStep moveInd = Individual::getTransfer();
 	int ninds = (int)inds.size();
 	for (int i = 0; i < ninds; i++) {
-		if (trfr.moveModel) {
-			disperser = inds[i]->moveStep(pLandscape, pSpecies, landIx, sim.absorbing);
-		}
-		else {
-			disperser = inds[i]->moveKernel(pLandscape, pSpecies, reptype, sim.absorbing);
-		}
+		disperser = (inds[i]->*moveInd)(pLandscape, pSpecies, landIx);
 		ndispersers += disperser;
 		if (disperser) {
 			if (reptype > 0)
@@ -1315,12 +1365,12 @@ bool Population::outPopHeaders(int landNr, bool patchModel) {
 
 	if (landNr == -999) { // close file
 		if (outPop.is_open()) outPop.close();
-		outPop.clear();
 		return true;
 	}
 
 	string name;
 	simParams sim = paramsSim->getSim();
+	simEngine eng = paramsSim->getEngine();
 	envGradParams grad = paramsGrad->getGradient();
 
 	// NEED TO REPLACE CONDITIONAL COLUMNS BASED ON ATTRIBUTES OF ONE SPECIES TO COVER
@@ -1331,37 +1381,42 @@ bool Population::outPopHeaders(int landNr, bool patchModel) {
 	if (sim.batchMode) {
 		name = paramsSim->getDir(2)
 			+ "Batch" + Int2Str(sim.batchNum) + "_"
-			+ "Sim" + Int2Str(sim.simulation) + "_Land" + Int2Str(landNr) + "_Pop.txt";
+			+ "Sim" + Int2Str(sim.simulation) + "_Land" + Int2Str(landNr) + "_Pop";
 	}
 	else {
-		name = paramsSim->getDir(2) + "Sim" + Int2Str(sim.simulation) + "_Pop.txt";
+		name = paramsSim->getDir(2) + "Sim" + Int2Str(sim.simulation) + "_Pop";
 	}
-	outPop.open(name.c_str());
-	outPop << "Rep\tYear\tRepSeason";
-	if (patchModel) outPop << "\tPatchID\tNcells";
-	else outPop << "\tx\ty";
+	outPop.open(name, eng.outFormat == 1, eng.compPop, true);
+	// column types must match the types of the values written by outPopulation()
+	outPop.column("Rep", 'i'); outPop.column("Year", 'i'); outPop.column("RepSeason", 'i');
+	if (patchModel) { outPop.column("PatchID", 'i'); outPop.column("Ncells", 'i'); }
+	else { outPop.column("x", 'i'); outPop.column("y", 'i'); }
 	// determine whether environmental data need be written for populations
 	bool writeEnv = false;
 	if (grad.gradient) writeEnv = true;
 	if (paramsStoch->envStoch()) writeEnv = true;
-	if (writeEnv) outPop << "\tEpsilon\tGradient\tLocal_K";
-	outPop << "\tSpecies\tNInd";
+	if (writeEnv) {
+		outPop.column("Epsilon", 'f'); outPop.column("Gradient", 'f'); outPop.column("Local_K", 'f');
+	}
+	outPop.column("Species", 'h'); outPop.column("NInd", 'i');
 	if (dem.stageStruct) {
 		if (dem.repType == 0)
 		{
-			for (int i = 1; i < sstruct.nStages; i++) outPop << "\tNInd_stage" << i;
-			outPop << "\tNJuvs";
+			for (int i = 1; i < sstruct.nStages; i++) outPop.column("NInd_stage" + Int2Str(i), 'i');
+			outPop.column("NJuvs", 'i');
 		}
 		else {
-			for (int i = 1; i < sstruct.nStages; i++)
-				outPop << "\tNfemales_stage" << i << "\tNmales_stage" << i;
-			outPop << "\tNJuvFemales\tNJuvMales";
+			for (int i = 1; i < sstruct.nStages; i++) {
+				outPop.column("Nfemales_stage" + Int2Str(i), 'i');
+				outPop.column("Nmales_stage" + Int2Str(i), 'i');
+			}
+			outPop.column("NJuvFemales", 'i'); outPop.column("NJuvMales", 'i');
 		}
 	}
 	else {
-		if (dem.repType != 0) outPop << "\tNfemales\tNmales";
+		if (dem.repType != 0) { outPop.column("Nfemales", 'i'); outPop.column("Nmales", 'i'); }
 	}
-	outPop << endl;
+	outPop.endHeader();
 
 	return outPop.is_open();
 }
@@ -1371,57 +1426,55 @@ bool Population::outPopHeaders(int landNr, bool patchModel) {
 void Population::outPopulation(int rep, int yr, int gen, float eps,
 	bool patchModel, bool writeEnv, bool gradK)
 {
-	Cell* pCell;
 // NEED TO REPLACE CONDITIONAL COLUMNS BASED ON ATTRIBUTES OF ONE SPECIES TO COVER
 // ATTRIBUTES OF *ALL* SPECIES AS DETECTED AT MODEL LEVEL
 	demogrParams dem = pSpecies->getDemogr();
 	stageParams sstruct = pSpecies->getStage();
 	popStats p;
 
-	outPop << rep << "\t" << yr << "\t" << gen;
+	outPop << rep << yr << gen;
 	if (patchModel) {
-		outPop << "\t" << pPatch->getPatchNum();
-		outPop << "\t" << pPatch->getNCells();
+		outPop << pPatch->getPatchNum();
+		outPop << pPatch->getNCells();
 	}
 	else {
 		locn loc = pPatch->getCellLocn(0);
-		outPop << "\t" << loc.x << "\t" << loc.y;
+		outPop << loc.x << loc.y;
 	}
 	if (writeEnv) {
 		if (pPatch->getPatchNum() == 0) { // matrix
-			outPop << "\t0\t0\t0";
+			outPop << 0.0f << 0.0f << 0.0f;
 		}
 		else {
 			float k = pPatch->getK();
-			float envval = 0.0;
-			pCell = pPatch->getRandomCell();
-			if (pCell != 0) envval = pCell->getEnvVal();
-			outPop << "\t" << eps << "\t" << envval << "\t" << k;
+			// output must not draw random numbers, so that it cannot alter the simulation
+			float envval = pPatch->getMeanEnvVal();
+			outPop << eps << envval << k;
 		}
 	}
-	outPop << "\t" << pSpecies->getSpNum();
+	outPop << pSpecies->getSpNum();
 	if (dem.stageStruct) {
 		p = getStats();
-		outPop << "\t" << p.nNonJuvs;
+		outPop << p.nNonJuvs;
 		// non-juvenile stage totals from permanent array
 		for (int stg = 1; stg < nStages; stg++) {
 			for (int sex = 0; sex < nSexes; sex++) {
-				outPop << "\t" << nInds[stg][sex];
+				outPop << nInds[stg][sex];
 			}
 		}
 		// juveniles from permanent array
 		for (int sex = 0; sex < nSexes; sex++) {
-			outPop << "\t" << nInds[0][sex];
+			outPop << nInds[0][sex];
 		}
 	}
 	else { // non-structured population
-		outPop << "\t" << totalPop();
+		outPop << totalPop();
 		if (dem.repType != 0)
 		{ // sexual model
-			outPop << "\t" << nInds[1][0] << "\t" << nInds[1][1];
+			outPop << nInds[1][0] << nInds[1][1];
 		}
 	}
-	outPop << endl;
+	outPop.endRow();
 }
 
 //---------------------------------------------------------------------------
@@ -1432,9 +1485,7 @@ void Population::outIndsHeaders(int rep, int landNr, bool patchModel)
 {
 
 	if (landNr == -999) { // close file
-		if (outInds.is_open()) {
-			outInds.close(); outInds.clear();
-		}
+		if (outInds.is_open()) outInds.close();
 		return;
 	}
 
@@ -1444,53 +1495,62 @@ void Population::outIndsHeaders(int rep, int landNr, bool patchModel)
 	trfrRules trfr = pSpecies->getTrfr();
 	settleType sett = pSpecies->getSettle();
 	simParams sim = paramsSim->getSim();
+	simEngine eng = paramsSim->getEngine();
 
 	if (sim.batchMode) {
 		name = paramsSim->getDir(2)
 			+ "Batch" + Int2Str(sim.batchNum) + "_"
 			+ "Sim" + Int2Str(sim.simulation)
-			+ "_Land" + Int2Str(landNr) + "_Rep" + Int2Str(rep) + "_Inds.txt";
+			+ "_Land" + Int2Str(landNr) + "_Rep" + Int2Str(rep) + "_Inds";
 	}
 	else {
 		name = paramsSim->getDir(2) + "Sim" + Int2Str(sim.simulation)
-			+ "_Rep" + Int2Str(rep) + "_Inds.txt";
+			+ "_Rep" + Int2Str(rep) + "_Inds";
 	}
-	outInds.open(name.c_str());
+	outInds.open(name, eng.outFormat == 1, eng.compInds);
 
-	outInds << "Rep\tYear\tRepSeason\tSpecies\tIndID\tStatus";
-	if (patchModel) outInds << "\tNatal_patch\tPatchID";
-	else outInds << "\tNatal_X\tNatal_Y\tX\tY";
-	if (dem.repType != 0) outInds << "\tSex";
-	if (dem.stageStruct) outInds << "\tAge\tStage";
+	// column types must match the types of the values written by outIndividual()
+	outInds.column("Rep", 'i'); outInds.column("Year", 'i'); outInds.column("RepSeason", 'i');
+	outInds.column("Species", 'h'); outInds.column("IndID", 'i'); outInds.column("Status", 'h');
+	if (patchModel) { outInds.column("Natal_patch", 'i'); outInds.column("PatchID", 'i'); }
+	else {
+		outInds.column("Natal_X", 'f'); outInds.column("Natal_Y", 'i');
+		outInds.column("X", 'f'); outInds.column("Y", 'f');
+	}
+	if (dem.repType != 0) outInds.column("Sex", 'h');
+	if (dem.stageStruct) { outInds.column("Age", 'h'); outInds.column("Stage", 'h'); }
 	if (emig.indVar) {
-		if (emig.densDep) outInds << "\tD0\tAlpha\tBeta";
-		else outInds << "\tEP";
+		if (emig.densDep) {
+			outInds.column("D0", 'f'); outInds.column("Alpha", 'f'); outInds.column("Beta", 'f');
+		}
+		else outInds.column("EP", 'f');
 	}
 	if (trfr.indVar) {
 		if (trfr.moveModel) {
 			if (trfr.moveType == 1) { // SMS
-				outInds << "\tDP\tGB\tAlphaDB\tBetaDB";
+				outInds.column("DP", 'f'); outInds.column("GB", 'f');
+				outInds.column("AlphaDB", 'f'); outInds.column("BetaDB", 'i');
 			}
 			if (trfr.moveType == 2) { // CRW
-				outInds << "\tStepLength\tRho";
+				outInds.column("StepLength", 'f'); outInds.column("Rho", 'f');
 			}
 		}
 		else { // kernel
-			outInds << "\tMeanDistI";
-			if (trfr.twinKern) outInds << "\tMeanDistII\tPKernelI";
+			outInds.column("MeanDistI", 'f');
+			if (trfr.twinKern) { outInds.column("MeanDistII", 'f'); outInds.column("PKernelI", 'f'); }
 		}
 	}
 	if (sett.indVar) {
-		outInds << "\tS0\tAlphaS\tBetaS";
+		outInds.column("S0", 'f'); outInds.column("AlphaS", 'f'); outInds.column("BetaS", 'f');
 	}
-	outInds << "\tDistMoved";
+	outInds.column("DistMoved", 'f');
 #if RSDEBUG
 	// ALWAYS WRITE NO. OF STEPS
-	outInds << "\tNsteps";
+	outInds.column("Nsteps", 'i');
 #else
-	if (trfr.moveModel) outInds << "\tNsteps";
+	if (trfr.moveModel) outInds.column("Nsteps", 'i');
 #endif
-	outInds << endl;
+	outInds.endHeader();
 }
 
 //---------------------------------------------------------------------------
@@ -1516,26 +1576,26 @@ void Population::outIndividual(Landscape* pLandscape, int rep, int yr, int gen,
 		indStats ind = inds[i]->getStats();
 		if (yr == -1) { // write all initialised individuals
 			writeInd = true;
-			outInds << rep << "\t" << yr << "\t" << dem.repSeasons - 1;
+			outInds << rep << yr << dem.repSeasons - 1;
 		}
 		else {
 			if (dem.stageStruct && gen < 0) { // write status 9 individuals only
 				if (ind.status == 9) {
 					writeInd = true;
-					outInds << rep << "\t" << yr << "\t" << dem.repSeasons - 1;
+					outInds << rep << yr << dem.repSeasons - 1;
 				}
 				else writeInd = false;
 			}
 			else {
 				writeInd = true;
-				outInds << rep << "\t" << yr << "\t" << gen;
+				outInds << rep << yr << gen;
 			}
 		}
 		if (writeInd) {
-			outInds << "\t" << spNum << "\t" << inds[i]->getId();
-			if (dem.stageStruct) outInds << "\t" << ind.status;
+			outInds << spNum << inds[i]->getId();
+			if (dem.stageStruct) outInds << ind.status;
 			else { // non-structured population
-				outInds << "\t" << ind.status;
+				outInds << ind.status;
 			}
 			pCell = inds[i]->getLocn(1);
 			locn loc;
@@ -1544,24 +1604,24 @@ void Population::outIndividual(Landscape* pLandscape, int rep, int yr, int gen,
 			pCell = inds[i]->getLocn(0);
 			locn natalloc = pCell->getLocn();
 			if (ppLand.patchModel) {
-				outInds << "\t" << inds[i]->getNatalPatch()->getPatchNum();
-				if (loc.x == -1) outInds << "\t-1";
-				else outInds << "\t" << patchNum;
+				outInds << inds[i]->getNatalPatch()->getPatchNum();
+				if (loc.x == -1) outInds << -1;
+				else outInds << patchNum;
 			}
 			else { // cell-based model
-				outInds << "\t" << (float)natalloc.x << "\t" << natalloc.y;
-				outInds << "\t" << (float)loc.x << "\t" << (float)loc.y;
+				outInds << (float)natalloc.x << natalloc.y;
+				outInds << (float)loc.x << (float)loc.y;
 			}
-			if (dem.repType != 0) outInds << "\t" << ind.sex;
-			if (dem.stageStruct) outInds << "\t" << ind.age << "\t" << ind.stage;
+			if (dem.repType != 0) outInds << ind.sex;
+			if (dem.stageStruct) outInds << ind.age << ind.stage;
 
 			if (emig.indVar) {
 				emigTraits e = inds[i]->getEmigTraits();
 				if (emig.densDep) {
-					outInds << "\t" << e.d0 << "\t" << e.alpha << "\t" << e.beta;
+					outInds << e.d0 << e.alpha << e.beta;
 				}
 				else {
-					outInds << "\t" << e.d0;
+					outInds << e.d0;
 				}
 			} // end of if (emig.indVar)
 
@@ -1569,49 +1629,49 @@ void Population::outIndividual(Landscape* pLandscape, int rep, int yr, int gen,
 				if (trfr.moveModel) {
 					if (trfr.moveType == 1) { // SMS
 						trfrSMSTraits s = inds[i]->getSMSTraits();
-						outInds << "\t" << s.dp << "\t" << s.gb;
-						outInds << "\t" << s.alphaDB << "\t" << s.betaDB;
+						outInds << s.dp << s.gb;
+						outInds << s.alphaDB << s.betaDB;
 					} // end of SMS
 					if (trfr.moveType == 2) { // CRW
 						trfrCRWTraits c = inds[i]->getCRWTraits();
-						outInds << "\t" << c.stepLength << "\t" << c.rho;
+						outInds << c.stepLength << c.rho;
 					} // end of CRW
 				}
 				else { // kernel
 					trfrKernTraits k = inds[i]->getKernTraits();
 					if (trfr.twinKern)
 					{
-						outInds << "\t" << k.meanDist1 << "\t" << k.meanDist2 << "\t" << k.probKern1;
+						outInds << k.meanDist1 << k.meanDist2 << k.probKern1;
 					}
 					else {
-						outInds << "\t" << k.meanDist1;
+						outInds << k.meanDist1;
 					}
 				}
 			}
 
 			if (sett.indVar) {
 				settleTraits s = inds[i]->getSettTraits();
-				outInds << "\t" << s.s0 << "\t" << s.alpha << "\t" << s.beta;
+				outInds << s.s0 << s.alpha << s.beta;
 			}
 
 			// distance moved (metres)
-			if (loc.x == -1) outInds << "\t-1";
+			if (loc.x == -1) outInds << -1.0f;
 			else {
 				float d = ppLand.resol * sqrt((float)((natalloc.x - loc.x) * (natalloc.x - loc.x)
 					+ (natalloc.y - loc.y) * (natalloc.y - loc.y)));
-				outInds << "\t" << d;
+				outInds << d;
 			}
 #if RSDEBUG
 			// ALWAYS WRITE NO. OF STEPS
 			steps = inds[i]->getSteps();
-			outInds << "\t" << steps.year;
+			outInds << steps.year;
 #else
 			if (trfr.moveModel) {
 				steps = inds[i]->getSteps();
-				outInds << "\t" << steps.year;
+				outInds << steps.year;
 			}
 #endif
-			outInds << endl;
+			outInds.endRow();
 		} // end of writeInd condition
 	}
 }
@@ -1620,12 +1680,17 @@ void Population::outIndividual(Landscape* pLandscape, int rep, int yr, int gen,
 
 //---------------------------------------------------------------------------
 // Write records to genetics file
-void Population::outGenetics(const int rep, const int year, const int landNr)
+void Population::outGenetics(const int rep, const int year, const int landNr,
+	const bool patchModel)
 {
 
 	simParams sim = paramsSim->getSim();
 
 	if (landNr >= 0) { // open file
+		if (sim.outGenForm == 3) {
+			outGenFreqHeaders(rep, landNr, patchModel);
+			return;
+		}
 		Genome* pGenome;
 		genomeData gen = pSpecies->getGenomeData();
 		if (gen.trait1Chromosome) {
@@ -1635,14 +1700,15 @@ void Population::outGenetics(const int rep, const int year, const int landNr)
 		else {
 			pGenome = new Genome(pSpecies);
 		}
-		pGenome->outGenHeaders(rep, landNr, sim.outGenXtab);
+		pGenome->outGenHeaders(rep, landNr, sim.outGenForm);
 		delete pGenome;
 		return;
 	}
 
 	if (landNr == -999) { // close file
+		if (outGenFreq.is_open()) outGenFreq.close();
 		Genome* pGenome = new Genome();
-		pGenome->outGenHeaders(rep, landNr, sim.outGenXtab);
+		pGenome->outGenHeaders(rep, landNr, sim.outGenForm);
 		delete pGenome;
 		return;
 	}
@@ -1654,16 +1720,106 @@ void Population::outGenetics(const int rep, const int year, const int landNr)
 		nstages = sstruct.nStages;
 	}
 
+	// for allele frequencies, the alleles of all selected individuals are gathered
+	// into one vector, each individual occupying nvals consecutive values
+	std::vector <short> values;
+	int nvals = (int)genFreqLoci.size() * genFreqPloidy;
+	int nsel = 0;
+
 	int ninds = (int)inds.size();
 	for (int i = 0; i < ninds; i++) {
 		indStats ind = inds[i]->getStats();
 		if (year == 0 || sim.outGenType == 1
 			|| (sim.outGenType == 0 && ind.stage == 0)
 			|| (sim.outGenType == 2 && ind.stage == nstages - 1)) {
-			inds[i]->outGenetics(rep, year, spNum, landNr, sim.outGenXtab);
+			if (sim.outGenForm == 3) {
+				inds[i]->alleleValues(values);
+				int nnew = (int)values.size() - nsel * nvals;
+				if (nnew == 0) continue; // individual has no genome
+				// every genome holds the selected loci of the species' ploidy
+				assert(nnew == nvals);
+				if (nnew == nvals) nsel++;
+				else values.resize(nsel * nvals);
+			}
+			else inds[i]->outGenetics(rep, year, spNum, landNr, sim.outGenForm);
+		}
+	}
+
+	if (sim.outGenForm == 3 && nsel > 0) {
+		std::vector <short> locus(nsel * genFreqPloidy);
+		int nloci = (int)genFreqLoci.size();
+		for (int j = 0; j < nloci; j++) {
+			for (int i = 0; i < nsel; i++) {
+				for (int k = 0; k < genFreqPloidy; k++)
+					locus[i * genFreqPloidy + k] = values[i * nvals + j * genFreqPloidy + k];
+			}
+			std::sort(locus.begin(), locus.end());
+			int nalleles = (int)locus.size();
+			int a = 0;
+			while (a < nalleles) {
+				int b = a;
+				while (b < nalleles && locus[b] == locus[a]) b++;
+				outGenFreq << rep << year << spNum;
+				if (patchModel) outGenFreq << pPatch->getPatchNum();
+				else {
+					locn loc = pPatch->getCellLocn(0);
+					outGenFreq << loc.x << loc.y;
+				}
+				outGenFreq << nsel << genFreqLoci[j].x << genFreqLoci[j].y << locus[a]
+					<< b - a << (float)(b - a) / (float)nalleles;
+				outGenFreq.endRow();
+				a = b;
+			}
+		}
+	}
+
+}
+
+//---------------------------------------------------------------------------
+// Open allele frequencies file and write header record
+void Population::outGenFreqHeaders(const int rep, const int landNr, const bool patchModel)
+{
+	string name;
+	simParams sim = paramsSim->getSim();
+	simEngine eng = paramsSim->getEngine();
+
+	if (sim.batchMode) {
+		name = paramsSim->getDir(2)
+			+ "Batch" + Int2Str(sim.batchNum) + "_"
+			+ "Sim" + Int2Str(sim.simulation)
+			+ "_Land" + Int2Str(landNr) + "_Rep" + Int2Str(rep) + "_AlleleFreqs";
+	}
+	else {
+		name = paramsSim->getDir(2) + "Sim" + Int2Str(sim.simulation)
+			+ "_Rep" + Int2Str(rep) + "_AlleleFreqs";
+	}
+
+	// record the chromosome and locus of each allele column in the order in which
+	// Genome::alleleValues() returns them
+	genFreqLoci.clear();
+	genFreqPloidy = pSpecies->isDiploid() ? 2 : 1;
+	genomeData gen = pSpecies->getGenomeData();
+	int nchromosomes = pSpecies->getNChromosomes();
+	if (nchromosomes < 1) nchromosomes = 1;
+	for (int i = 0; i < nchromosomes; i++) {
+		int nloci = gen.trait1Chromosome ? pSpecies->getNLoci(0) : pSpecies->getNLoci(i);
+		for (int j = 0; j < nloci; j++) {
+			locn loc; loc.x = i; loc.y = j;
+			genFreqLoci.push_back(loc);
 		}
 	}
 
+	outGenFreq.open(name, eng.outFormat == 1, eng.compGenetics);
+	// column types must match the types of the values written by outGenetics()
+	outGenFreq.column("Rep", 'i'); outGenFreq.column("Year", 'i');
+	outGenFreq.column("Species", 'h');
+	if (patchModel) outGenFreq.column("PatchID", 'i');
+	else { outGenFreq.column("x", 'i'); outGenFreq.column("y", 'i'); }
+	outGenFreq.column("NInds", 'i');
+	outGenFreq.column("Chromosome", 'i'); outGenFreq.column("Locus", 'i');
+	outGenFreq.column("Allele", 'h'); outGenFreq.column("Count", 'i');
+	outGenFreq.column("Frequency", 'f');
+	outGenFreq.endHeader();
 }
 
 //---------------------------------------------------------------------------
@@ -58,6 +58,7 @@ using namespace std;
 #include "Landscape.h"
 #include "Patch.h"
 #include "Cell.h"
+#include "DispersalStats.h"
 
 //---------------------------------------------------------------------------
 
@@ -101,6 +102,14 @@ struct traitsums { // sums of trait genes for dispersal
 	double ssqBetaS[NSEXES]; 	// sum of squares of inflection point of settlement reaction norm
 };
 
+void clearTraits( // Set all sums of trait genes to zero
+	traitsums&
+);
+void addTraits( // Add the second set of sums of trait genes to the first
+	traitsums&,
+	const traitsums&
+);
+
 class Population {
 
 public:
@@ -112,7 +121,10 @@ public:
 		int				// Landscape resolution
 	);
 	~Population(void);
-	traitsums getTraits(Species*);
+	void getTraits( // Add the trait genes of all Individuals to the sums
+		Species*,		// pointer to Species
+		traitsums&	// sums of trait genes (see above)
+	);
 	popStats getStats(void);
 	Species* getSpecies(void);
 	int getNInds(void);
@@ -211,9 +223,19 @@ public:
 	void outGenetics( // Write records to genetics file
 		const int,		// replicate
 		const int,		// year
-		const int	 		// landscape number
+		const int,		// landscape number
+		const bool		// TRUE for a patch-based model, FALSE for a cell-based model
+	);
+	void outGenFreqHeaders( // Open allele frequencies file and write header record
+		const int,		// replicate
+		const int,		// landscape number
+		const bool		// TRUE for a patch-based model, FALSE for a cell-based model
 	);
 	void clean(void); // Remove zero pointers to dead or dispersed individuals
+	void recordDispersal(void); // Record the outcome of dispersal of all individuals
+	void memory( // Add the memory held by the population and its individuals to a census
+		memUsage&
+	);
 
 private:
 	short nStages;
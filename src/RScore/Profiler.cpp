@@ -0,0 +1,249 @@
+/*----------------------------------------------------------------------------
+ *	
+ *	Copyright (C) 2020 Greta Bocedi, Stephen C.F. Palmer, Justin M.J. Travis, Anne-Kathleen Malchow, Damaris Zurell 
+ *	
+ *	This file is part of RangeShifter.
+ *	
+ *	RangeShifter is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *	
+ *	RangeShifter is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *	GNU General Public License for more details.
+ *	
+ *	You should have received a copy of the GNU General Public License
+ *	along with RangeShifter. If not, see <https://www.gnu.org/licenses/>.
+ *	
+ --------------------------------------------------------------------------*/
+ 
+ 
+//---------------------------------------------------------------------------
+
+#include "Profiler.h"
+
+#if RS_PERF
+#include <cerrno>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+//---------------------------------------------------------------------------
+
+Profiler profiler;
+
+outTable outProf;
+
+thread_local long long eventCounts[NEVENTS];
+
+// Names of the phases, in the order of their numbers
+static const char* phaseNames[NPROFPHASES] = {
+	"LandChange", "UpdateK", "Extinction", "Reproduction", "Emigration",
+	"DispInit", "Transfer", "Settlement", "Survival",
+	"OutRange", "OutPop", "OutInds", "OutGenetics", "OutTraits", "OutOccupancy",
+	"OutConnect", "OutDispStats", "OutWrite"
+};
+
+// Names of the events, in the order of their numbers
+static const char* eventNames[NEVENTS] = {
+	"KernelDraws", "KernelRetries", "MoveInds", "MoveSteps",
+	"HabMatrixComputed", "HabMatrixReused", "IndsCreated", "IndsDeleted"
+};
+
+//---------------------------------------------------------------------------
+
+Profiler::Profiler(void) {
+	on = false;
+	for (int i = 0; i < NPROFPHASES; i++) { ns[i] = 0; calls[i] = 0; }
+	for (int i = 0; i < NEVENTS; i++) events[i] = 0;
+#if RS_PERF
+	perfOn = false;
+	for (int i = 0; i < NPERFCOUNTERS; i++) perfFd[i] = -1;
+#endif
+}
+
+Profiler::~Profiler(void) {
+#if RS_PERF
+	closeCounters();
+#endif
+}
+
+bool Profiler::outHeaders(const int landNr) {
+	if (landNr == -999) { // close file
+		if (outProf.is_open()) outProf.close();
+		on = false;
+#if RS_PERF
+		closeCounters();
+#endif
+		return true;
+	}
+
+	string name;
+	simParams sim = paramsSim->getSim();
+	if (sim.batchMode) {
+		name = paramsSim->getDir(2)
+			+ "Batch" + Int2Str(sim.batchNum) + "_"
+			+ "Sim" + Int2Str(sim.simulation) + "_Land" + Int2Str(landNr);
+	}
+	else {
+		name = paramsSim->getDir(2) + "Sim" + Int2Str(sim.simulation);
+	}
+
+#if RS_PERF
+	openCounters();
+#endif
+
+	// column types must match the types of the values written by outProfile()
+	outProf.open(name + "_Profile", false, OUTNOCOMP, true);
+	outProf.column("Rep", 'i'); outProf.column("Year", 'i');
+	outProf.column("Time", 'd');
+	for (int i = 0; i < NPROFPHASES; i++) {
+		outProf.column(string(phaseNames[i]) + "Calls", 'i');
+		outProf.column(string(phaseNames[i]) + "Time", 'd');
+#if RS_PERF
+		if (perfOn) {
+			outProf.column(string(phaseNames[i]) + "Cycles", 'l');
+			outProf.column(string(phaseNames[i]) + "IPC", 'd');
+			outProf.column(string(phaseNames[i]) + "CacheMPKI", 'd');
+			outProf.column(string(phaseNames[i]) + "BranchMPKI", 'd');
+		}
+#endif
+	}
+	for (int i = 0; i < NEVENTS; i++) outProf.column(eventNames[i], 'l');
+	outProf.endHeader();
+
+	on = outProf.is_open();
+	for (int i = 0; i < NPROFPHASES; i++) {
+		ns[i] = 0; calls[i] = 0;
+#if RS_PERF
+		for (int j = 0; j < NPERFCOUNTERS; j++) perf[i][j] = 0;
+#endif
+	}
+	resetEvents();
+	last = std::chrono::steady_clock::now();
+	return on;
+}
+
+void Profiler::add(const short phase, const long long t) {
+	ns[phase] += t;
+	calls[phase]++;
+}
+
+void Profiler::mergeEvents(void) {
+	std::lock_guard<std::mutex> lock(eventMutex);
+	for (int i = 0; i < NEVENTS; i++) {
+		events[i] += eventCounts[i]; eventCounts[i] = 0;
+	}
+}
+
+void Profiler::resetEvents(void) {
+	std::lock_guard<std::mutex> lock(eventMutex);
+	for (int i = 0; i < NEVENTS; i++) { events[i] = 0; eventCounts[i] = 0; }
+}
+
+// Must be called by the simulation thread, whose counts are included
+void Profiler::outProfile(const int rep, const int yr) {
+	if (!on) return;
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	long long total = (long long)std::chrono::duration_cast<std::chrono::nanoseconds>
+		(now - last).count();
+	outProf << rep << yr << (double)total * 1.0e-9;
+	for (int i = 0; i < NPROFPHASES; i++) {
+		outProf << calls[i] << (double)ns[i] * 1.0e-9;
+		ns[i] = 0; calls[i] = 0;
+#if RS_PERF
+		if (perfOn) {
+			// ratios are zero for a phase which has not run
+			double cycles = (double)perf[i][PERFCYCLES];
+			double instrs = (double)perf[i][PERFINSTRS];
+			outProf << (long long)perf[i][PERFCYCLES];
+			if (cycles > 0.0) outProf << instrs / cycles; else outProf << 0.0;
+			if (instrs > 0.0) {
+				outProf << 1000.0 * (double)perf[i][PERFCACHEMISSES] / instrs
+					<< 1000.0 * (double)perf[i][PERFBRANCHMISSES] / instrs;
+			}
+			else outProf << 0.0 << 0.0;
+		}
+		for (int j = 0; j < NPERFCOUNTERS; j++) perf[i][j] = 0;
+#endif
+	}
+	mergeEvents();
+	for (int i = 0; i < NEVENTS; i++) outProf << events[i];
+	outProf.endRow();
+	resetEvents();
+	last = now;
+}
+
+#if RS_PERF
+
+// Open the hardware counters of the current thread as a group, led by the cycles
+// counter; if any cannot be opened, none is used
+bool Profiler::openCounters(void) {
+	static bool reported = false;
+	const unsigned long long config[NPERFCOUNTERS] = {
+		PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+		PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+	};
+	closeCounters();
+	for (int i = 0; i < NPERFCOUNTERS; i++) {
+		struct perf_event_attr attr;
+		memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.config = config[i];
+		attr.read_format = PERF_FORMAT_GROUP;
+		attr.disabled = (i == 0);
+		attr.exclude_kernel = 1; attr.exclude_hv = 1;
+		perfFd[i] = (int)syscall(SYS_perf_event_open, &attr, 0, -1,
+			i == 0 ? -1 : perfFd[0], 0);
+		if (perfFd[i] < 0) {
+			if (!reported) {
+				cout << "Hardware counters are unavailable (" << strerror(errno)
+					<< "); the profile will not include them" << endl;
+				reported = true;
+			}
+			closeCounters();
+			return false;
+		}
+	}
+	ioctl(perfFd[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+	ioctl(perfFd[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+	perfOn = true;
+	return true;
+}
+
+void Profiler::closeCounters(void) {
+	for (int i = 0; i < NPERFCOUNTERS; i++) {
+		if (perfFd[i] >= 0) close(perfFd[i]);
+		perfFd[i] = -1;
+	}
+	perfOn = false;
+}
+
+void Profiler::readCounters(unsigned long long* c) {
+	// group record: no. of counters followed by their values
+	unsigned long long buf[1 + NPERFCOUNTERS];
+	if (perfOn && read(perfFd[0], buf, sizeof(buf)) == (ssize_t)sizeof(buf)) {
+		for (int i = 0; i < NPERFCOUNTERS; i++) c[i] = buf[1 + i];
+	}
+	else {
+		for (int i = 0; i < NPERFCOUNTERS; i++) c[i] = 0;
+	}
+}
+
+void Profiler::addCounters(const short phase, const unsigned long long* c0) {
+	if (!perfOn) return;
+	unsigned long long c[NPERFCOUNTERS];
+	readCounters(c);
+	for (int i = 0; i < NPERFCOUNTERS; i++) {
+		if (c[i] >= c0[i]) perf[phase][i] += c[i] - c0[i];
+	}
+}
+
+#endif
+
+//---------------------------------------------------------------------------
@@ -0,0 +1,211 @@
+/*----------------------------------------------------------------------------
+ *	
+ *	Copyright (C) 2020 Greta Bocedi, Stephen C.F. Palmer, Justin M.J. Travis, Anne-Kathleen Malchow, Damaris Zurell 
+ *	
+ *	This file is part of RangeShifter.
+ *	
+ *	RangeShifter is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *	
+ *	RangeShifter is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *	GNU General Public License for more details.
+ *	
+ *	You should have received a copy of the GNU General Public License
+ *	along with RangeShifter. If not, see <https://www.gnu.org/licenses/>.
+ *	
+ --------------------------------------------------------------------------*/
+ 
+ 
+/*------------------------------------------------------------------------------
+
+RangeShifter v2.0 Profiler
+
+Implements the Profiler class
+
+Times the phases of each year of a simulation: landscape change, updating of the
+carrying capacity, local extinction, reproduction, emigration, dispersal (initiation,
+each iteration of transfer and settlement), survival and development, and each of
+the outputs. A phase is timed by a profScope, an object which reads the (steady)
+clock when it is created and adds the time elapsed, in nanoseconds, and one call to
+the phase when it is destroyed or stopped. When profiling is not enabled, a
+profScope only tests a flag, so that the scopes may be left in place in every build.
+
+Events within the phases (draws and rejected draws of kernel destinations, movement
+steps and the individuals taking them, effective cost matrices of SMS computed or
+reused, and individuals created and deleted) are counted by countEvent() in every
+build, as the increment of a thread-local counter. The counts of the simulation
+thread are read at the end of each year, and any other thread which counts events
+adds its counts to the Profiler by mergeEvents() before it finishes.
+
+If RangeShifter is built with RS_PERF defined (on Linux only), each profScope also
+reads the hardware counters of cycles, instructions, cache misses and branch misses
+of the simulation thread (by perf_event_open(), as one group, so that they are read
+by a single system call and ratios between them are not distorted if the counters
+are multiplexed), and the profile gives for each phase its cycles, instructions per
+cycle and cache and branch misses per thousand instructions. If the counters cannot
+be opened (as is usual in containers, or if perf_event_paranoid forbids them), the
+profile is written without them.
+
+The times and calls of each phase in each year are written at the end of the year
+to a profile file (_Profile), with one row per replicate and year, in which the
+total time is the time elapsed since the previous row (so that the first row of a
+replicate includes setting it up, and the final row includes the final summary
+output), followed by the counts of events. Times are in seconds.
+
+For full details of RangeShifter, please see:
+Bocedi G., Palmer S.C.F., Peer G., Heikkinen R.K., Matsinos Y.G., Watts K.
+and Travis J.M.J. (2014). RangeShifter: a platform for modelling spatial
+eco-evolutionary dynamics and species responses to environmental changes.
+Methods in Ecology and Evolution, 5, 388-396. doi: 10.1111/2041-210X.12162
+
+------------------------------------------------------------------------------*/
+
+#ifndef ProfilerH
+#define ProfilerH
+
+#include <chrono>
+#include <mutex>
+using namespace std;
+
+#include "Parameters.h"
+#include "OutputTable.h"
+
+// Phases of a year which are timed
+#define PROFLANDCHANGE 0		// range restriction and landscape change
+#define PROFUPDATEK 1				// updating of carrying capacity
+#define PROFEXTINCTION 2		// local extinction
+#define PROFREPRODUCTION 3
+#define PROFEMIGRATION 4
+#define PROFDISPINIT 5			// initiation of dispersal
+#define PROFTRANSFER 6			// each iteration of transfer
+#define PROFSETTLEMENT 7		// completion of each iteration of dispersal
+#define PROFSURVIVAL 8			// survival, development and ageing
+#define PROFOUTRANGE 9
+#define PROFOUTPOP 10
+#define PROFOUTINDS 11
+#define PROFOUTGENETICS 12
+#define PROFOUTTRAITS 13
+#define PROFOUTOCCUPANCY 14
+#define PROFOUTCONNECT 15
+#define PROFOUTDISPSTATS 16
+#define PROFOUTWRITE 17			// handing records to the writer thread and flushing files
+#define NPROFPHASES 18
+
+// Events which are counted
+#define EVKERNELDRAW 0			// dispersal kernel destinations drawn by rejection
+#define EVKERNELRETRY 1			// rejected draws of kernel destinations
+#define EVMOVEINDS 2				// individuals taking a movement step in the year
+#define EVMOVESTEPS 3				// movement steps taken
+#define EVHABCOMPUTED 4			// SMS effective cost matrices computed
+#define EVHABREUSED 5				// SMS effective cost matrices reused from the cell
+#define EVINDNEW 6					// individuals created
+#define EVINDDELETE 7				// individuals deleted
+#define NEVENTS 8
+
+#if RS_PERF
+// Hardware counters read in each phase
+#define PERFCYCLES 0
+#define PERFINSTRS 1
+#define PERFCACHEMISSES 2
+#define PERFBRANCHMISSES 3
+#define NPERFCOUNTERS 4
+#endif
+
+extern thread_local long long eventCounts[NEVENTS]; // counts of the current thread
+
+inline void countEvent(const short ev) { eventCounts[ev]++; }
+inline void countEvent(const short ev, const long long n) { eventCounts[ev] += n; }
+
+//---------------------------------------------------------------------------
+
+class Profiler {
+public:
+	Profiler(void);
+	~Profiler(void);
+	bool outHeaders( // Open the profile file and write the header record
+		const int		// landscape number (-999 to close the file)
+	);
+	bool active(void) { return on; } // Are phases to be timed?
+	void add( // Add a call to a phase
+		const short,		// phase
+		const long long	// time taken (ns)
+	);
+	void mergeEvents(void); // Add the event counts of the current thread and reset them
+#if RS_PERF
+	void readCounters( // Read the hardware counters (or zeroes if they are not open)
+		unsigned long long*	// values of the counters (NPERFCOUNTERS)
+	);
+	void addCounters( // Add the counts of a phase since the counters were read
+		const short,								// phase
+		const unsigned long long*		// values of the counters when read
+	);
+#endif
+	void outProfile( // Write the times and counts of the year and begin the next year
+		const int,	// replicate
+		const int		// year
+	);
+
+private:
+	void resetEvents(void);
+#if RS_PERF
+	bool openCounters(void);
+	void closeCounters(void);
+#endif
+
+	bool on;
+	long long ns[NPROFPHASES];		// time taken by each phase (ns)
+	int calls[NPROFPHASES];				// no. of calls of each phase
+	long long events[NEVENTS];		// counts of events merged from other threads
+	std::mutex eventMutex;
+	std::chrono::steady_clock::time_point last; // time at which the previous row was written
+#if RS_PERF
+	int perfFd[NPERFCOUNTERS];		// counter file descriptors, the first leading the group
+	bool perfOn;									// are the counters open?
+	unsigned long long perf[NPROFPHASES][NPERFCOUNTERS]; // counts of each phase
+#endif
+
+};
+
+extern Profiler profiler;
+
+// Times a phase from its creation until it is destroyed or stopped
+class profScope {
+public:
+	profScope(const short ph) {
+		phase = ph; on = profiler.active();
+		if (on) {
+#if RS_PERF
+			profiler.readCounters(c0);
+#endif
+			t0 = std::chrono::steady_clock::now();
+		}
+	}
+	~profScope(void) { stop(); }
+	void stop(void) {
+		if (on) {
+			long long t = (long long)std::chrono::duration_cast<std::chrono::nanoseconds>
+				(std::chrono::steady_clock::now() - t0).count();
+#if RS_PERF
+			profiler.addCounters(phase, c0);
+#endif
+			profiler.add(phase, t);
+			on = false;
+		}
+	}
+private:
+	bool on;
+	short phase;
+	std::chrono::steady_clock::time_point t0;
+#if RS_PERF
+	unsigned long long c0[NPERFCOUNTERS];
+#endif
+};
+
+extern paramSim *paramsSim;
+
+//---------------------------------------------------------------------------
+#endif
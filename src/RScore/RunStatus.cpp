@@ -0,0 +1,163 @@
+/*----------------------------------------------------------------------------
+ *	
+ *	Copyright (C) 2020 Greta Bocedi, Stephen C.F. Palmer, Justin M.J. Travis, Anne-Kathleen Malchow, Damaris Zurell 
+ *	
+ *	This file is part of RangeShifter.
+ *	
+ *	RangeShifter is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *	
+ *	RangeShifter is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *	GNU General Public License for more details.
+ *	
+ *	You should have received a copy of the GNU General Public License
+ *	along with RangeShifter. If not, see <https://www.gnu.org/licenses/>.
+ *	
+ --------------------------------------------------------------------------*/
+ 
+ 
+//---------------------------------------------------------------------------
+
+#include "RunStatus.h"
+
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#if LINUX_CLUSTER
+#include <sys/resource.h>
+#endif
+//---------------------------------------------------------------------------
+
+RunStatus runStatus;
+
+// Peak resident memory of the process (MB), or -1 if it is not known
+static double peakRSS(void) {
+#if LINUX_CLUSTER
+	struct rusage ru;
+	if (getrusage(RUSAGE_SELF, &ru) != 0) return -1.0;
+#if defined(__APPLE__)
+	return (double)ru.ru_maxrss / (1024.0 * 1024.0); // bytes
+#else
+	return (double)ru.ru_maxrss / 1024.0; // KB
+#endif
+#else
+	return -1.0;
+#endif
+}
+
+//---------------------------------------------------------------------------
+
+RunStatus::RunStatus(void) {
+	on = false; interval = 0;
+	batch = nSims = nLands = 0;
+	simIx = landIx = simNr = landNr = reps = years = 0;
+	rep = year = inds = inTransit = 0;
+	simFraction = 0.0;
+}
+
+RunStatus::~RunStatus(void) { }
+
+void RunStatus::start(const string filename, const int secs, const int batchnum,
+	const int nsims, const int nlands)
+{
+	on = secs > 0;
+	if (!on) return;
+	name = filename; interval = secs;
+	batch = batchnum; nSims = nsims; nLands = nlands;
+	simIx = landIx = simNr = landNr = reps = years = 0;
+	rep = year = inds = inTransit = 0;
+	simFraction = 0.0;
+	batchStart = simStart = std::chrono::steady_clock::now();
+	next = batchStart + std::chrono::seconds(interval);
+	write("starting");
+}
+
+void RunStatus::startSim(const int simix, const int landix, const int simnr, const int landnr,
+	const int nreps, const int nyears)
+{
+	if (!on) return;
+	simIx = simix; landIx = landix; simNr = simnr; landNr = landnr;
+	reps = nreps; years = nyears;
+	rep = year = inds = inTransit = 0;
+	simFraction = 0.0;
+	simStart = std::chrono::steady_clock::now();
+}
+
+void RunStatus::update(const int r, const int yr, const int ninds, const int ntransit) {
+	if (!on) return;
+	rep = r; year = yr; inds = ninds; inTransit = ntransit;
+	if (reps > 0 && years > 0)
+		simFraction = ((double)r * years + yr + 1) / ((double)reps * years);
+	write("running");
+	next = std::chrono::steady_clock::now() + std::chrono::seconds(interval);
+}
+
+void RunStatus::endReplicate(const int r, const int yr, const int ninds, const int ntransit) {
+	if (!on) return;
+	rep = r; year = yr; inds = ninds; inTransit = ntransit;
+	if (reps > 0) simFraction = (double)(r + 1) / (double)reps;
+}
+
+void RunStatus::finish(const bool completed) {
+	if (!on) return;
+	if (completed) {
+		simIx = nSims - 1; landIx = nLands - 1;
+		simFraction = 1.0;
+	}
+	write(completed ? "finished" : "aborted");
+	on = false;
+}
+
+bool RunStatus::write(const string state) {
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	double batchSecs = std::chrono::duration<double>(now - batchStart).count();
+	double simSecs = std::chrono::duration<double>(now - simStart).count();
+	double simYears = simFraction * reps * years;
+	double rate = simSecs > 0.0 ? simYears / simSecs : 0.0;
+	double simEta = -1.0, batchEta = -1.0;
+	if (rate > 0.0) simEta = ((double)reps * years - simYears) / rate;
+	int nruns = nSims * nLands;
+	double done = nruns > 0 ? ((double)landIx * nSims + simIx + simFraction) / (double)nruns : 0.0;
+	if (done > 0.0) batchEta = batchSecs * (1.0 - done) / done;
+
+	char stamp[32];
+	time_t t = time(0);
+	strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%SZ", gmtime(&t));
+
+	string tmpname = name + ".tmp";
+	ofstream out(tmpname.c_str());
+	out << "{" << endl
+		<< "  \"state\": \"" << state << "\"," << endl
+		<< "  \"updated\": \"" << stamp << "\"," << endl
+		<< "  \"elapsed\": " << batchSecs << "," << endl
+		<< "  \"batch\": " << batch << "," << endl
+		<< "  \"simulation\": " << simNr << "," << endl
+		<< "  \"simulationIndex\": " << simIx + 1 << "," << endl
+		<< "  \"simulations\": " << nSims << "," << endl
+		<< "  \"landscape\": " << landNr << "," << endl
+		<< "  \"landscapeIndex\": " << landIx + 1 << "," << endl
+		<< "  \"landscapes\": " << nLands << "," << endl
+		<< "  \"replicate\": " << rep << "," << endl
+		<< "  \"replicates\": " << reps << "," << endl
+		<< "  \"year\": " << year << "," << endl
+		<< "  \"years\": " << years << "," << endl
+		<< "  \"individuals\": " << inds << "," << endl
+		<< "  \"inTransit\": " << inTransit << "," << endl
+		<< "  \"yearsPerSec\": " << rate << "," << endl
+		<< "  \"etaSimulation\": " << simEta << "," << endl
+		<< "  \"etaBatch\": " << batchEta << "," << endl
+		<< "  \"peakRSS_MB\": " << peakRSS() << endl
+		<< "}" << endl;
+	out.close();
+	if (!out) return false;
+#if !LINUX_CLUSTER
+	std::remove(name.c_str()); // rename() does not replace a file on Windows
+#endif
+	return std::rename(tmpname.c_str(), name.c_str()) == 0;
+}
+
+//---------------------------------------------------------------------------
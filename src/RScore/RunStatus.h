@@ -0,0 +1,118 @@
+/*----------------------------------------------------------------------------
+ *	
+ *	Copyright (C) 2020 Greta Bocedi, Stephen C.F. Palmer, Justin M.J. Travis, Anne-Kathleen Malchow, Damaris Zurell 
+ *	
+ *	This file is part of RangeShifter.
+ *	
+ *	RangeShifter is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *	
+ *	RangeShifter is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *	GNU General Public License for more details.
+ *	
+ *	You should have received a copy of the GNU General Public License
+ *	along with RangeShifter. If not, see <https://www.gnu.org/licenses/>.
+ *	
+ --------------------------------------------------------------------------*/
+ 
+ 
+/*------------------------------------------------------------------------------
+
+RangeShifter v2.0 RunStatus
+
+Implements the RunStatus class
+
+Writes a small JSON file giving the progress of a batch, so that a long run may
+be monitored without reading its outputs: the current simulation, landscape,
+replicate and year, the total no. of individuals and the no. of dispersers in
+transit (in the matrix) at the end of the year, the rate of the simulation in
+years per second, estimates of the time remaining for the simulation and for the
+batch, and the peak resident memory of the process.
+
+The file is written at the end of a year once a set interval of wall-clock time
+has passed since it was last written (and at the start and end of the batch), so
+a run which has stalled, or which is taking much longer than expected, may be
+recognised from the time of the latest update. It is written to a temporary file
+which is then renamed, so that a reader never sees a partial file (the rename is
+atomic on Linux and macOS only).
+
+The time remaining for the simulation assumes that its remaining years run at its
+rate so far (so it is an overestimate if populations may go extinct), and that for
+the batch assumes that every simulation on every landscape takes as long as those
+so far.
+
+For full details of RangeShifter, please see:
+Bocedi G., Palmer S.C.F., Peer G., Heikkinen R.K., Matsinos Y.G., Watts K.
+and Travis J.M.J. (2014). RangeShifter: a platform for modelling spatial
+eco-evolutionary dynamics and species responses to environmental changes.
+Methods in Ecology and Evolution, 5, 388-396. doi: 10.1111/2041-210X.12162
+
+------------------------------------------------------------------------------*/
+
+#ifndef RunStatusH
+#define RunStatusH
+
+#include <string>
+#include <chrono>
+using namespace std;
+
+//---------------------------------------------------------------------------
+
+class RunStatus {
+public:
+	RunStatus(void);
+	~RunStatus(void);
+	void start( // Begin a batch, writing the status file at a given interval
+		const string,	// name of the status file
+		const int,		// interval (s), 0 = no status file
+		const int,		// batch number
+		const int,		// no. of simulations
+		const int			// no. of landscapes
+	);
+	void startSim( // Begin a simulation
+		const int,	// index of the simulation in the batch
+		const int,	// index of the landscape in the batch
+		const int,	// simulation number
+		const int,	// landscape number
+		const int,	// no. of replicates
+		const int		// no. of years
+	);
+	bool due(void) { // Is the status file due to be written?
+		return on && std::chrono::steady_clock::now() >= next;
+	}
+	void update( // Write the status at the end of a year
+		const int,	// replicate
+		const int,	// year
+		const int,	// total no. of individuals
+		const int		// no. of dispersers in transit
+	);
+	void endReplicate( // Record the position at the end of a replicate, without writing
+		const int,	// replicate
+		const int,	// last year run
+		const int,	// total no. of individuals
+		const int		// no. of dispersers in transit
+	);
+	void finish( // Write the final status of the batch
+		const bool	// completed? (false if aborted)
+	);
+
+private:
+	bool write(const string);	// write the status file, in a given state
+	bool on;
+	string name;
+	int interval;
+	int batch, nSims, nLands;
+	int simIx, landIx, simNr, landNr, reps, years;
+	int rep, year, inds, inTransit;
+	double simFraction;		// proportion of the current simulation completed
+	std::chrono::steady_clock::time_point batchStart, simStart, next;
+};
+
+extern RunStatus runStatus;
+
+//---------------------------------------------------------------------------
+#endif
@@ -105,6 +105,7 @@ Species::Species(void)
 	}
 	pr = 1; prMethod = 1; memSize = 1; goalType = 0;
 	dp = 1.0; gb = 1.0; alphaDB = 1.0; betaDB = 100000;
+	dpWts = calcSMSWeights(dp); dpInflWts = calcSMSWeights(10.0f * dp); gbWts = calcSMSWeights(gb);
 	stepMort = 0.0; stepLength = 10.0; rho = 0.9f;
 	habStepMort = 0; habCost = 0;
 	fixedMort = 0.0; mortAlpha = 0.0; mortBeta = 1.0;
@@ -1038,7 +1039,7 @@ trfrMortParams Species::getMortParams(void) {
 void Species::setMovtTraits(const trfrMovtTraits m) {
 	if (m.pr >= 1) pr = m.pr;
 	if (m.prMethod >= 1 && m.prMethod <= 3) prMethod = m.prMethod;
-	if (m.memSize >= 1 && m.memSize <= 14) memSize = m.memSize;
+	if (m.memSize >= 1 && m.memSize <= MAXMEMSIZE) memSize = m.memSize;
 	if (m.goalType >= 0 && m.goalType <= 2) goalType = m.goalType;
 	if (m.dp >= 1.0) dp = m.dp;
 	if (m.gb >= 1.0) gb = m.gb;
@@ -1048,6 +1049,9 @@ void Species::setMovtTraits(const trfrMovtTraits m) {
 	if (m.stepLength > 0.0) stepLength = m.stepLength;
 	if (m.rho > 0.0 && m.rho < 1.0) rho = m.rho;
 	straigtenPath = m.straigtenPath;
+	dpWts = calcSMSWeights(dp);
+	dpInflWts = calcSMSWeights(10.0f * dp);
+	gbWts = calcSMSWeights(gb);
 }
 
 trfrMovtTraits Species::getMovtTraits(void) {
@@ -1073,6 +1077,12 @@ trfrSMSTraits Species::getSMSTraits(void) {
 	return m;
 }
 
+const smsWeights* Species::getSMSWeights(const short option) {
+	if (option == 0) return &dpWts;
+	if (option == 1) return &dpInflWts;
+	return &gbWts;
+}
+
 void Species::setKernParams(const short stg, const short sex,
 	const trfrKernParams k, const double resol)
 {
@@ -1359,6 +1369,23 @@ settScales Species::getSettScales(void) {
 	return s;
 }
 
+//---------------------------------------------------------------------------
+
+// Calculate SMS weightings for a directional persistence or goal bias value
+// The lowest (unit) weighting applies in the preferred direction, and the weighting
+// is multiplied by the base for each octant further away from it
+smsWeights calcSMSWeights(const double base) {
+	smsWeights w;
+	double i2 = base * base;
+	double i3 = i2 * base;
+	w.wt[0] = (float)1.0;
+	w.wt[1] = (float)base;
+	w.wt[2] = (float)i2;
+	w.wt[3] = (float)i3;
+	w.wt[4] = (float)(i3 * base);
+	return w;
+}
+
 //---------------------------------------------------------------------------
 //---------------------------------------------------------------------------
 //---------------------------------------------------------------------------
@@ -137,6 +137,10 @@ struct trfrSMSTraits {
 	float	dp; float	gb; float alphaDB; int betaDB; float	stepMort;
 	bool straigtenPath;
 };
+struct smsWeights { // SMS weightings of neighbouring cells lying 0 to 4 octants away
+										// from the preferred direction (powers of dp or gb)
+	double wt[5];
+};
 struct trfrKernParams {
 	double dist1Mean; double dist1SD; double dist1Scale;
 	double dist2Mean; double dist2SD; double dist2Scale;
@@ -428,6 +432,10 @@ public:
 	trfrMovtTraits getMovtTraits(void); // Get transfer movement model traits
 	trfrCRWTraits getCRWTraits(void);		// Get CRW traits
 	trfrSMSTraits getSMSTraits(void);		// Get SMS traits
+	const smsWeights* getSMSWeights( // Get SMS directional weightings
+		const short	// option: 0 = directional persistence, 1 = inflated (10 * dp)
+								// directional persistence, 2 = goal bias
+	);
 	void setKernParams( // Set initial transfer by kernel parameter limits
 		const short,					// stage (NB implemented for stage 0 only)
 		const short,					// sex
@@ -662,6 +670,9 @@ private:
 	float gb;						// SMS goal bias
 	float alphaDB; 			// SMS dispersal bias decay rate
 	int betaDB; 				// SMS dispersal bias decay inflection point (no. of steps)
+	smsWeights dpWts;		// SMS weightings for directional persistence
+	smsWeights dpInflWts;	// SMS weightings for inflated directional persistence
+	smsWeights gbWts;		// SMS weightings for goal bias
 	float stepMort;			// constant per-step mortality probability for movement models
 	double* habStepMort;	// habitat-dependent per-step mortality probability
 	float stepLength;		// CRW step length (m)
@@ -739,6 +750,13 @@ rationale is justified remains to be tested!
 
 //---------------------------------------------------------------------------
 
+// Calculate SMS weightings for a directional persistence or goal bias value
+smsWeights calcSMSWeights(
+	const double	// base for power-law (directional persistence or goal bias value)
+);
+
+//---------------------------------------------------------------------------
+
 #if RSDEBUG
 //extern ofstream DEBUGLOG;
 extern void DebugGUI(string);
@@ -25,7 +25,7 @@
 #include "SubCommunity.h"
 //---------------------------------------------------------------------------
 
-ofstream outtraits;
+outFile outtraits;
 
 //---------------------------------------------------------------------------
 
@@ -35,7 +35,6 @@ SubCommunity::SubCommunity(Patch* pPch, int num) {
 	// record the new sub-community no. in the patch
 	pPatch->setSubComm((intptr)this);
 	initial = false;
-	occupancy = 0;
 }
 
 SubCommunity::~SubCommunity() {
@@ -45,7 +44,6 @@ SubCommunity::~SubCommunity() {
 		delete popns[i];
 	}
 	popns.clear();
-	if (occupancy != 0) delete[] occupancy;
 }
 
 intptr SubCommunity::getNum(void) { return subCommNum; }
@@ -388,6 +386,7 @@ void SubCommunity::completeDispersal(Landscape* pLandscape, bool connect)
 					pPop = pSubComm->newPopn(pLandscape, pSpecies, pNewPatch, 0);
 				}
 				pPop->recruit(settler.pInd);
+				if (dispStats.active()) dispStats.record(settler.pInd);
 				if (connect) { // increment connectivity totals
 					int newpatch = pNewPatch->getSeqNum();
 					pPrevCell = settler.pInd->getLocn(0); // previous cell
@@ -408,6 +407,13 @@ void SubCommunity::completeDispersal(Landscape* pLandscape, bool connect)
 
 }
 
+void SubCommunity::recordDispersal(void) {
+	int npops = (int)popns.size();
+	for (int i = 0; i < npops; i++) { // all populations
+		popns[i]->recordDispersal();
+	}
+}
+
 //---------------------------------------------------------------------------
 
 void SubCommunity::survival(short part, short option0, short option1)
@@ -458,34 +464,15 @@ Population* SubCommunity::findPop(Species* pSp, Patch* pPch) {
 
 //---------------------------------------------------------------------------
 
-void SubCommunity::createOccupancy(int nrows) {
-	if (occupancy != 0) deleteOccupancy();
-	if (nrows > 0) {
-		occupancy = new int[nrows];
-		for (int i = 0; i < nrows; i++) occupancy[i] = 0;
-	}
-}
-
-void SubCommunity::updateOccupancy(int row) {
+bool SubCommunity::occupied(void) {
 	popStats pop;
 	int npops = (int)popns.size();
 	for (int i = 0; i < npops; i++) {
+		if (popns[i]->getNInds() == 0) continue;
 		pop = popns[i]->getStats();
-		if (pop.nInds > 0 && pop.breeding) {
-			occupancy[row]++;
-			i = npops;
-		}
+		if (pop.nInds > 0 && pop.breeding) return true;
 	}
-}
-
-int SubCommunity::getOccupancy(int row) {
-	if (row >= 0) return occupancy[row];
-	else return 0;
-}
-
-void SubCommunity::deleteOccupancy(void) {
-	delete[] occupancy;
-	occupancy = 0;
+	return false;
 }
 
 //---------------------------------------------------------------------------
@@ -537,8 +524,8 @@ void SubCommunity::outPop(Landscape* pLandscape, int rep, int yr, int gen)
 	float localK;
 	float eps = 0.0;
 	if (env.stoch) {
-		if (env.local) {
-			pCell = pPatch->getRandomCell();
+		if (env.local) { // cell-based model only, so the first cell is the only cell
+			pCell = pPatch->getCell(0);
 			if (pCell != 0) eps = pCell->getEps();
 		}
 		else {
@@ -579,20 +566,20 @@ void SubCommunity::outInds(Landscape* pLandscape, int rep, int yr, int gen, int
 }
 
 // Write records to individuals file
-void SubCommunity::outGenetics(int rep, int yr, int gen, int landNr)
+void SubCommunity::outGenetics(int rep, int yr, int gen, int landNr, bool patchModel)
 {
 	if (landNr >= 0) { // open the file
-		popns[0]->outGenetics(rep, yr, landNr);
+		popns[0]->outGenetics(rep, yr, landNr, patchModel);
 		return;
 	}
 	if (landNr == -999) { // close the file
-		popns[0]->outGenetics(rep, yr, landNr);
+		popns[0]->outGenetics(rep, yr, landNr, patchModel);
 		return;
 	}
 	// generate output for each population within the sub-community (patch)
 	int npops = (int)popns.size();
 	for (int i = 0; i < npops; i++) { // all populations
-		popns[i]->outGenetics(rep, yr, landNr);
+		popns[i]->outGenetics(rep, yr, landNr, patchModel);
 	}
 }
 
@@ -606,6 +593,13 @@ int SubCommunity::stagePop(int stage) {
 	return popsize;
 }
 
+void SubCommunity::memory(memUsage& m) {
+	m.objects[MEMPOPNS]++;
+	m.bytes[MEMPOPNS] += sizeof(SubCommunity) + popns.capacity() * sizeof(Population*);
+	int npops = (int)popns.size();
+	for (int i = 0; i < npops; i++) popns[i]->memory(m);
+}
+
 // Open traits file and write header record
 bool SubCommunity::outTraitsHeaders(Landscape* pLandscape, Species* pSpecies, int landNr)
 {
@@ -645,7 +639,7 @@ bool SubCommunity::outTraitsHeaders(Landscape* pLandscape, Species* pSpecies, in
 			name = DirOut + "Sim" + Int2Str(sim.simulation) + "_TraitsXcell.txt";
 		}
 	}
-	outtraits.open(name.c_str());
+	outtraits.open(name.c_str(), false, paramsSim->getEngine().compTraits, true);
 
 	outtraits << "Rep\tYear\tRepSeason";
 	if (land.patchModel) outtraits << "\tPatchID";
@@ -715,31 +709,35 @@ bool SubCommunity::outTraitsHeaders(Landscape* pLandscape, Species* pSpecies, in
 	return outtraits.is_open();
 }
 
-// Write records to traits file and return aggregated sums
-traitsums SubCommunity::outTraits(traitCanvas tcanv,
-	Landscape* pLandscape, int rep, int yr, int gen, bool commlevel)
+// Sum trait genes of each population and of the sub-community
+void SubCommunity::getTraits(std::vector <traitsums>& poptraits, traitsums& ts)
+{
+	int npops = (int)popns.size();
+	poptraits.resize(npops);
+	clearTraits(ts);
+	// sum trait genes for each population within the sub-community (patch)
+	// provided that the patch is suitable (i.e. non-zero carrying capacity)
+	for (int i = 0; i < npops; i++) { // all populations
+		clearTraits(poptraits[i]);
+		if (pPatch->getK() > 0.0 && popns[i]->getNInds() > 0) {
+			popns[i]->getTraits(popns[i]->getSpecies(), poptraits[i]);
+			addTraits(ts, poptraits[i]);
+		}
+	}
+}
+
+// Write records to traits file from sums of each population
+void SubCommunity::outTraits(traitCanvas tcanv,
+	Landscape* pLandscape, int rep, int yr, int gen,
+	const std::vector <traitsums>& sums)
 {
 	int popsize, ngenes;
 	landParams land = pLandscape->getLandParams();
 	simParams sim = paramsSim->getSim();
 	bool writefile = false;
-	if (sim.outTraitsCells && yr % sim.outIntTraitCell == 0 && !commlevel)
+	if (sim.outTraitsCells && yr % sim.outIntTraitCell == 0)
 		writefile = true;
-	traitsums ts, poptraits;
-	for (int i = 0; i < NSEXES; i++) {
-		ts.ninds[i] = 0;
-		ts.sumD0[i] = ts.ssqD0[i] = 0.0;
-		ts.sumAlpha[i] = ts.ssqAlpha[i] = 0.0; ts.sumBeta[i] = ts.ssqBeta[i] = 0.0;
-		ts.sumDist1[i] = ts.ssqDist1[i] = 0.0; ts.sumDist2[i] = ts.ssqDist2[i] = 0.0;
-		ts.sumProp1[i] = ts.ssqProp1[i] = 0.0;
-		ts.sumDP[i] = ts.ssqDP[i] = 0.0;
-		ts.sumGB[i] = ts.ssqGB[i] = 0.0;
-		ts.sumAlphaDB[i] = ts.ssqAlphaDB[i] = 0.0;
-		ts.sumBetaDB[i] = ts.ssqBetaDB[i] = 0.0;
-		ts.sumStepL[i] = ts.ssqStepL[i] = 0.0; ts.sumRho[i] = ts.ssqRho[i] = 0.0;
-		ts.sumS0[i] = ts.ssqS0[i] = 0.0;
-		ts.sumAlphaS[i] = ts.ssqAlphaS[i] = 0.0; ts.sumBetaS[i] = ts.ssqBetaS[i] = 0.0;
-	}
+	if (!writefile) return;
 
 	// generate output for each population within the sub-community (patch)
 	// provided that the patch is suitable (i.e. non-zero carrying capacity)
@@ -755,7 +753,7 @@ traitsums SubCommunity::outTraits(traitCanvas tcanv,
 			emigRules emig = pSpecies->getEmig();
 			trfrRules trfr = pSpecies->getTrfr();
 			settleType sett = pSpecies->getSettle();
-			poptraits = popns[i]->getTraits(pSpecies);
+			const traitsums& poptraits = sums[i];
 
 			if (writefile) {
 				outtraits << rep << "\t" << yr << "\t" << gen;
@@ -975,28 +973,8 @@ traitsums SubCommunity::outTraits(traitCanvas tcanv,
 			}
 
 			if (writefile) outtraits << endl;
-
-			for (int s = 0; s < NSEXES; s++) {
-				ts.ninds[s] += poptraits.ninds[s];
-				ts.sumD0[s] += poptraits.sumD0[s];     ts.ssqD0[s] += poptraits.ssqD0[s];
-				ts.sumAlpha[s] += poptraits.sumAlpha[s];  ts.ssqAlpha[s] += poptraits.ssqAlpha[s];
-				ts.sumBeta[s] += poptraits.sumBeta[s];   ts.ssqBeta[s] += poptraits.ssqBeta[s];
-				ts.sumDist1[s] += poptraits.sumDist1[s];  ts.ssqDist1[s] += poptraits.ssqDist1[s];
-				ts.sumDist2[s] += poptraits.sumDist2[s];  ts.ssqDist2[s] += poptraits.ssqDist2[s];
-				ts.sumProp1[s] += poptraits.sumProp1[s];  ts.ssqProp1[s] += poptraits.ssqProp1[s];
-				ts.sumDP[s] += poptraits.sumDP[s];     ts.ssqDP[s] += poptraits.ssqDP[s];
-				ts.sumGB[s] += poptraits.sumGB[s];     ts.ssqGB[s] += poptraits.ssqGB[s];
-				ts.sumAlphaDB[s] += poptraits.sumAlphaDB[s]; ts.ssqAlphaDB[s] += poptraits.ssqAlphaDB[s];
-				ts.sumBetaDB[s] += poptraits.sumBetaDB[s];  ts.ssqBetaDB[s] += poptraits.ssqBetaDB[s];
-				ts.sumStepL[s] += poptraits.sumStepL[s];  ts.ssqStepL[s] += poptraits.ssqStepL[s];
-				ts.sumRho[s] += poptraits.sumRho[s];    ts.ssqRho[s] += poptraits.ssqRho[s];
-				ts.sumS0[s] += poptraits.sumS0[s];     ts.ssqS0[s] += poptraits.ssqS0[s];
-				ts.sumAlphaS[s] += poptraits.sumAlphaS[s]; ts.ssqAlphaS[s] += poptraits.ssqAlphaS[s];
-				ts.sumBetaS[s] += poptraits.sumBetaS[s];  ts.ssqBetaS[s] += poptraits.ssqBetaS[s];
-			}
 		}
 	}
-	return ts;
 }
 
 //---------------------------------------------------------------------------
@@ -121,6 +121,9 @@ public:
 		Landscape*,	// pointer to Landscape
 		bool				// TRUE to increment connectivity totals
 	);
+	// Record the outcome of dispersal of individuals which have not settled
+	// (executed for the matrix patch only, once dispersal is complete)
+	void recordDispersal(void);
 	void survival(
 		short,	// part:		0 = determine survival & development,
 						//		 			1 = apply survival changes to the population
@@ -133,16 +136,7 @@ public:
 	void ageIncrement(void);
 	// Find the population of a given species in a given patch
 	Population* findPop(Species*,Patch*);
-	void createOccupancy(
-		int	// no. of rows = (no. of years / interval) + 1
-	);
-	void updateOccupancy(
-		int	// row = (no. of years / interval)
-	);
-	int getOccupancy(
-		int	// row = (no. of years / interval)
-	);
-	void deleteOccupancy(void);
+	bool occupied(void); // Is there a breeding population in the sub-community?
 
 	bool outPopHeaders( // Open population file and write header record
 		Landscape*,	// pointer to Landscape
@@ -168,32 +162,41 @@ public:
 		int,				// replicate
 		int,				// year
 		int,				// generation
-		int					// Landscape number (>= 0 to open the file, -999 to close the file
+		int,				// Landscape number (>= 0 to open the file, -999 to close the file
 								//									 -1 to write data records)
+		bool				// TRUE for a patch-based model, FALSE for a cell-based model
 	);
 	bool outTraitsHeaders( // Open traits file and write header record
 		Landscape*,	// pointer to Landscape
 		Species*,		// pointer to Species
 		int					// Landscape number (-999 to close the file)
 	);
-	traitsums outTraits( // Write records to traits file and return aggregated sums
+	void getTraits( // Sum trait genes of each population and of the sub-community
+									// only reads the populations, so may be called concurrently
+									// for different sub-communities
+		std::vector <traitsums>&,	// sums for each population (zero if patch is unsuitable)
+		traitsums&		// sums for the sub-community
+	);
+	void outTraits( // Write records to traits file from sums of each population
 		traitCanvas,	// pointers to canvases for drawing variable traits		
 									// in the batch version, these are replaced by integers set to zero
 		Landscape*, 	// pointer to Landscape
 		int,					// replicate
 		int,					// year
 		int,					// generation
-		bool					// true if called to summarise data at community level
+		const std::vector <traitsums>&	// sums for each population, from getTraits()
 	);
 	int stagePop( // Population size of a specified stage
 		int	// stage
 	);
+	void memory( // Add the memory held by the sub-community and its populations to a census
+		memUsage&
+	);
 
 private:
 	intptr subCommNum;	// SubCommunity number
 		// 0 is reserved for the SubCommunity in the inter-patch matrix
 	Patch *pPatch;
-	int *occupancy;	// pointer to occupancy array
 	std::vector <Population*> popns;
 	bool initial; 	// WILL NEED TO BE CHANGED FOR MULTIPLE SPECIES ...
 
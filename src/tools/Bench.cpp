@@ -0,0 +1,562 @@
+/*----------------------------------------------------------------------------
+ *	
+ *	Copyright (C) 2020 Greta Bocedi, Stephen C.F. Palmer, Justin M.J. Travis, Anne-Kathleen Malchow, Damaris Zurell 
+ *	
+ *	This file is part of RangeShifter.
+ *	
+ *	RangeShifter is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *	
+ *	RangeShifter is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *	GNU General Public License for more details.
+ *	
+ *	You should have received a copy of the GNU General Public License
+ *	along with RangeShifter. If not, see <https://www.gnu.org/licenses/>.
+ *	
+ --------------------------------------------------------------------------*/
+ 
+/*------------------------------------------------------------------------------
+
+RangeShifter v2.0 Bench
+
+Entry level function for the RangeShifter_bench tool, which times the routines of
+RScore which dominate the run time of a simulation, on synthetic species and
+landscapes, so that their performance can be tracked across releases. Each
+benchmark is repeated, and the median, minimum and maximum time per unit of work
+(ns) are written as JSON, in a fixed layout identified by its format no.
+
+Usage: RangeShifter_bench [-quick] [-reps n] [-filter name] [-out file.json] [-dir folder]
+
+-quick runs fewer operations on smaller landscapes, -filter runs only benchmarks
+whose names contain the given text, and -dir is the folder in which synthetic
+rasters are written (default: current folder). Results are written to the
+standard output unless -out is given.
+
+For full details of RangeShifter, please see:
+Bocedi G., Palmer S.C.F., Peer G., Heikkinen R.K., Matsinos Y.G., Watts K.
+and Travis J.M.J. (2014). RangeShifter: a platform for modelling spatial
+eco-evolutionary dynamics and species responses to environmental changes.
+Methods in Ecology and Evolution, 5, 388-396. doi: 10.1111/2041-210X.12162
+
+------------------------------------------------------------------------------*/
+
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <utility>
+
+using namespace std;
+
+#include "../RScore/Parameters.h"
+#include "../RScore/Landscape.h"
+#include "../RScore/Species.h"
+#include "../RScore/Community.h"
+#include "../RScore/Population.h"
+#include "../RScore/Individual.h"
+#include "../RScore/Genome.h"
+#include "../RScore/RSrandom.h"
+
+#ifndef RS_VERSION
+#define RS_VERSION "unknown"
+#endif
+
+// format of the results file, to be incremented whenever its layout changes
+const int benchFormat = 1;
+
+//---------------------------------------------------------------------------
+
+// Globals required by RScore (see Main.cpp)
+
+void MemoLine(string msg) {
+}
+
+#if RSDEBUG
+void DebugGUI(string msg) {
+}
+ofstream DEBUGLOG;
+ofstream MUTNLOG;
+#endif
+
+string habmapname,patchmapname,distnmapname;	// req'd for compilation, but not used
+string costmapname,genfilename;					 			// ditto
+vector <string> hfnames;											// ditto
+
+paramGrad *paramsGrad;			// pointer to environmental gradient parameters
+paramStoch *paramsStoch;		// pointer to environmental stochasticity parameters
+paramInit *paramsInit;			// pointer to initialisation parameters
+paramSim *paramsSim;				// pointer to simulation parameters
+
+Species *pSpecies;  				// pointer to species
+Community *pComm;						// pointer to community
+RSrandom *pRandom;          // pointer to random number routines
+
+//---------------------------------------------------------------------------
+
+// Timing of benchmarks
+
+typedef chrono::steady_clock benchClock;
+typedef vector <pair <string, int> > benchParams;
+
+struct benchResult {
+	string name;				// routine benchmarked
+	benchParams params;	// parameters of the benchmark, in a fixed order
+	string per;					// unit of work timed, e.g. "call", "step", "individual"
+	long long ops;			// no. of units of work in each repetition
+	vector <double> ns;	// time per unit of work (ns) of each repetition
+};
+
+static vector <benchResult> results;
+static int nReps = 5;					// no. of timed repetitions of each benchmark
+static bool quick = false;		// fewer operations and smaller landscapes
+static string filter;					// run only the benchmarks whose names contain it
+static volatile double sink;	// consumes results, so that timed work is not optimised away
+
+static bool selected(const string name) {
+	return filter.empty() || name.find(filter) != string::npos;
+}
+
+// Scale the no. of operations of a benchmark for a quick run
+static long long scaled(const long long ops) {
+	if (quick) return ops / 10 > 0 ? ops / 10 : 1;
+	return ops;
+}
+
+// Run a benchmark: setup() is called untimed before each repetition, and body() is
+// timed and must perform the given no. of units of work
+template <typename Setup, typename Body>
+static void runBench(const string name, const benchParams params, const string per,
+	const long long ops, Setup setup, Body body)
+{
+	if (!selected(name)) return;
+	benchResult r;
+	r.name = name; r.params = params; r.per = per; r.ops = ops;
+	for (int rep = 0; rep < nReps; rep++) {
+		setup();
+		benchClock::time_point t0 = benchClock::now();
+		body();
+		double ns = chrono::duration<double, nano>(benchClock::now() - t0).count();
+		r.ns.push_back(ns / (double)ops);
+	}
+	results.push_back(r);
+	cerr << name;
+	for (int i = 0; i < (int)params.size(); i++)
+		cerr << " " << params[i].first << "=" << params[i].second;
+	cerr << endl;
+}
+
+static void noSetup(void) { }
+
+//---------------------------------------------------------------------------
+
+// Species and landscape
+
+const int benchResol = 10;			// landscape resolution (m)
+const float benchK = 10.0;			// carrying capacity of a suitable cell (inds.)
+
+// Set up the species as a non-structured asexual species dispersing by the given method
+// (0 = kernel, 1 = SMS, 2 = CRW), which does not settle, so that it keeps moving
+static void setSpecies(const short moveType, const short pr) {
+	trfrRules trfr = pSpecies->getTrfr();
+	trfr.moveModel = moveType > 0;
+	if (moveType > 0) trfr.moveType = moveType;
+	pSpecies->setTrfr(trfr);
+
+	trfrKernTraits kern;
+	kern.meanDist1 = 100.0; kern.meanDist2 = 1000.0; kern.probKern1 = 0.99f;
+	pSpecies->setKernTraits(0, 0, kern, benchResol);
+
+	trfrMovtTraits movt = pSpecies->getMovtTraits();
+	movt.pr = pr; movt.prMethod = 1; movt.memSize = 5; movt.goalType = 0;
+	movt.dp = 5.0; movt.gb = 1.0; movt.stepMort = 0.0;
+	movt.stepLength = 10.0; movt.rho = 0.7f; movt.straigtenPath = false;
+	pSpecies->setMovtTraits(movt);
+
+	// suitable cells (habitat index 1) are cheaper to cross than the matrix
+	pSpecies->createHabCostMort(2);
+	pSpecies->setHabCost(0, 10); pSpecies->setHabCost(1, 1);
+	pSpecies->setHabMort(0, 0.0); pSpecies->setHabMort(1, 0.0);
+
+	// a disperser may not settle before taking a very large no. of steps
+	settleSteps steps;
+	steps.minSteps = 99999999; steps.maxSteps = 99999999; steps.maxStepsYr = 99999999;
+	pSpecies->setSteps(0, 0, steps);
+}
+
+// Generate a random cell-based landscape of the given dimensions, half of which is suitable
+static Landscape* generateLandscape(const int dimX, const int dimY) {
+	Landscape* pLandscape = new Landscape;
+	landParams ppLand = pLandscape->getLandParams();
+	ppLand.patchModel = false; ppLand.spDist = false; ppLand.generated = true;
+	ppLand.dynamic = false; ppLand.landNum = 1; ppLand.resol = benchResol;
+	ppLand.spResol = benchResol; ppLand.nHab = 1; ppLand.nHabMax = 1;
+	ppLand.dimX = dimX; ppLand.dimY = dimY;
+	ppLand.minX = ppLand.minY = 0; ppLand.maxX = dimX - 1; ppLand.maxY = dimY - 1;
+	ppLand.rasterType = 9;
+	pLandscape->setLandParams(ppLand, true);
+	genLandParams ppGenLand = pLandscape->getGenLandParams();
+	ppGenLand.fractal = false; ppGenLand.continuous = false;
+	ppGenLand.minPct = 1.0; ppGenLand.maxPct = 100.0; ppGenLand.propSuit = 0.5;
+	ppGenLand.hurst = 0.5; ppGenLand.maxCells = 100;
+	pLandscape->setGenLandParams(ppGenLand);
+	pLandscape->generatePatches();
+	pLandscape->updateCarryingCapacity(pSpecies, 0, 0);
+	return pLandscape;
+}
+
+// Create dispersers of the current transfer method in random suitable cells
+static void createDispersers(Landscape* pLandscape, const int n, vector <Individual*>& inds) {
+	trfrRules trfr = pSpecies->getTrfr();
+	int npatches = pLandscape->patchCount();
+	for (int i = 0; i < n; i++) {
+		// patch 0 is the matrix
+		Patch* pPatch = pLandscape->getPatchData(pRandom->IRandom(1, npatches - 1)).pPatch;
+		Individual* pInd = new Individual(pPatch->getRandomCell(), pPatch, 1, 0, 0, 0.0,
+			trfr.moveModel, trfr.moveType);
+		pInd->setStatus(1);
+		inds.push_back(pInd);
+	}
+}
+
+static void deleteDispersers(vector <Individual*>& inds) {
+	for (int i = 0; i < (int)inds.size(); i++) delete inds[i];
+	inds.clear();
+}
+
+//---------------------------------------------------------------------------
+
+// Benchmarks
+
+static void benchRandom(void) {
+	long long n = scaled(1000000);
+	runBench("RSrandom::Random", benchParams(), "call", n, noSetup, [n]() {
+		double sum = 0.0;
+		for (long long i = 0; i < n; i++) sum += pRandom->Random();
+		sink = sum;
+	});
+	runBench("RSrandom::IRandom", benchParams(), "call", n, noSetup, [n]() {
+		long long sum = 0;
+		for (long long i = 0; i < n; i++) sum += pRandom->IRandom(0, 999);
+		sink = (double)sum;
+	});
+	runBench("RSrandom::Bernoulli", benchParams(), "call", n, noSetup, [n]() {
+		long long sum = 0;
+		for (long long i = 0; i < n; i++) sum += pRandom->Bernoulli(0.3);
+		sink = (double)sum;
+	});
+	runBench("RSrandom::Normal", benchParams(), "call", n, noSetup, [n]() {
+		double sum = 0.0;
+		for (long long i = 0; i < n; i++) sum += pRandom->Normal(0.0, 1.0);
+		sink = sum;
+	});
+	const int means[2] = { 2, 50 };
+	for (int m = 0; m < 2; m++) {
+		double mean = means[m];
+		runBench("RSrandom::Poisson", benchParams{ { "mean", means[m] } }, "call", n, noSetup,
+			[n, mean]() {
+			long long sum = 0;
+			for (long long i = 0; i < n; i++) sum += pRandom->Poisson(mean);
+			sink = (double)sum;
+		});
+	}
+}
+
+// Write a synthetic habitat raster (codes 1 and 2) and, for a patch-based model, a patch
+// raster in which the cells of habitat 2 form patches of up to 10 x 10 cells
+static void writeRasters(const string habfile, const string pchfile, const int dim,
+	const bool patchModel)
+{
+	ofstream hfile(habfile.c_str());
+	ofstream pfile;
+	if (patchModel) pfile.open(pchfile.c_str());
+	string header = "ncols " + to_string(dim) + "\nnrows " + to_string(dim)
+		+ "\nxllcorner 0\nyllcorner 0\ncellsize " + to_string(benchResol) + "\nNODATA_value -9\n";
+	hfile << header;
+	if (patchModel) pfile << header;
+	int npatchcols = (dim + 9) / 10;
+	for (int y = dim - 1; y >= 0; y--) {
+		for (int x = 0; x < dim; x++) {
+			int h = 1 + pRandom->Bernoulli(0.5);
+			hfile << h << (x < dim - 1 ? " " : "\n");
+			if (patchModel) {
+				int p = h == 2 ? 1 + (y / 10) * npatchcols + x / 10 : 0;
+				pfile << p << (x < dim - 1 ? " " : "\n");
+			}
+		}
+	}
+}
+
+static void benchReadLandscape(const string dir) {
+	const int dims[2] = { 100, 500 };
+	for (int d = 0; d < 2; d++) {
+		int dim = quick ? dims[d] / 3 : dims[d];
+		for (int patchModel = 0; patchModel < 2; patchModel++) {
+			if (!selected("Landscape::readLandscape")) return;
+			string habfile = dir + "RangeShifter_bench_hab.txt";
+			string pchfile = dir + "RangeShifter_bench_patch.txt";
+			writeRasters(habfile, pchfile, dim, patchModel);
+			Landscape* pLandscape = 0;
+			runBench("Landscape::readLandscape",
+				benchParams{ { "cells", dim * dim }, { "patch", patchModel } }, "cell",
+				(long long)dim * dim,
+				[&]() {
+				if (pLandscape != 0) delete pLandscape;
+				pLandscape = new Landscape;
+				landParams ppLand = pLandscape->getLandParams();
+				ppLand.patchModel = patchModel; ppLand.spDist = false; ppLand.generated = false;
+				ppLand.dynamic = false; ppLand.landNum = 1; ppLand.resol = benchResol;
+				ppLand.spResol = benchResol; ppLand.nHab = 2; ppLand.nHabMax = 2;
+				ppLand.rasterType = 0;
+				pLandscape->setLandParams(ppLand, true);
+			},
+				[&]() {
+				int error = pLandscape->readLandscape(0, habfile, patchModel ? pchfile : " ", "NULL");
+				if (error != 0) {
+					cerr << "*** Error " << error << " reading " << habfile << endl;
+					exit(1);
+				}
+			});
+			if (pLandscape != 0) delete pLandscape;
+			remove(habfile.c_str());
+			if (patchModel) remove(pchfile.c_str());
+		}
+	}
+}
+
+static void benchHabMatrix(Landscape* pLandscape) {
+	if (!selected("Individual::getHabMatrix")) return;
+	setSpecies(1, 1);
+	vector <Individual*> inds;
+	createDispersers(pLandscape, 1, inds);
+	landData land = pLandscape->getLandData();
+	// evaluate the matrix in a fixed sequence of random cells
+	const int nlocns = 4096;
+	vector <locn> locns(nlocns);
+	for (int i = 0; i < nlocns; i++) {
+		locns[i].x = pRandom->IRandom(0, land.maxX);
+		locns[i].y = pRandom->IRandom(0, land.maxY);
+	}
+	const short prs[4] = { 1, 2, 4, 8 };
+	for (int i = 0; i < 4; i++) {
+		short pr = prs[i];
+		long long n = scaled(pr > 2 ? 10000 : 100000);
+		for (short method = 1; method <= 3; method++) {
+			if (pr == 1 && method > 1) continue; // mean of a single cell
+			runBench("Individual::getHabMatrix", benchParams{ { "pr", pr }, { "prmethod", method } },
+				"call", n, noSetup, [&]() {
+				double sum = 0.0;
+				for (long long j = 0; j < n; j++) {
+					const locn& loc = locns[j % nlocns];
+					array3x3f w = inds[0]->getHabMatrix(pLandscape, pSpecies, loc.x, loc.y,
+						pr, method, 0, false);
+					sum += w.cell[0][0];
+				}
+				sink = sum;
+			});
+		}
+	}
+	deleteDispersers(inds);
+}
+
+// Time the transfer routine selected for the current species, as called by
+// Population::transfer(), for a pool of dispersers
+static void benchTransfer(Landscape* pLandscape, const string name, const benchParams params,
+	const int ninds, const int nrounds)
+{
+	if (!selected(name)) return;
+	trfrRules trfr = pSpecies->getTrfr();
+	Individual::selectTransfer(pLandscape, pSpecies, false);
+	Individual::trfrStep moveInd = Individual::getTransfer();
+	vector <Individual*> inds;
+	createDispersers(pLandscape, ninds, inds);
+	// each repetition starts without any SMS effective costs of cells
+	runBench(name, params, "step", (long long)ninds * nrounds,
+		[&]() { pLandscape->resetEffCosts(); }, [&]() {
+		int ndispersing = 0;
+		for (int round = 0; round < nrounds; round++) {
+			for (int i = 0; i < ninds; i++) {
+				// a kernel disperser makes a single move, after which it is set to disperse again
+				if (!trfr.moveModel) inds[i]->setStatus(1);
+				ndispersing += (inds[i]->*moveInd)(pLandscape, pSpecies, 0);
+			}
+		}
+		sink = ndispersing;
+	});
+	deleteDispersers(inds);
+}
+
+static void benchMovement(Landscape* pLandscape) {
+	int ninds = quick ? 100 : 1000;
+	simEngine eng = paramsSim->getEngine();
+	for (short sampler = 0; sampler < 2; sampler++) {
+		eng.kernSampler = sampler;
+		paramsSim->setEngine(eng);
+		setSpecies(0, 1);
+		benchTransfer(pLandscape, "Individual::moveKernel", benchParams{ { "sampler", sampler } },
+			ninds, 100);
+	}
+	eng.kernSampler = 0;
+	paramsSim->setEngine(eng);
+	const short prs[2] = { 1, 4 };
+	for (int i = 0; i < 2; i++) {
+		setSpecies(1, prs[i]);
+		benchTransfer(pLandscape, "Individual::smsMove", benchParams{ { "pr", prs[i] } },
+			ninds, 100);
+	}
+	setSpecies(2, 1);
+	benchTransfer(pLandscape, "Individual::moveStep", benchParams{ { "movetype", 2 } },
+		ninds, 100);
+}
+
+static void benchInherit(void) {
+	const int loci[2] = { 10, 100 };
+	for (int i = 0; i < 2; i++) {
+		int nloci = loci[i];
+		Chromosome mother(nloci), child(nloci);
+		mother.initialise(0.0, 1.0, true);
+		long long n = scaled(nloci > 10 ? 100000 : 1000000);
+		runBench("Chromosome::inherit", benchParams{ { "loci", nloci } }, "call", n, noSetup,
+			[&]() {
+			for (long long j = 0; j < n; j++) {
+				child.inherit(&mother, (short)(j & 1), (short)nloci, 0.001, 0.01, 0.1, true);
+			}
+			sink = child.additive(true);
+		});
+	}
+}
+
+// Time a routine of Population for a new population of each size at carrying capacity
+static void benchPopulation(Landscape* pLandscape) {
+	setSpecies(0, 1);
+	emigTraits emig; emig.d0 = 0.2f; emig.alpha = 0.0; emig.beta = 1.0;
+	pSpecies->setEmigTraits(0, 0, emig);
+	Patch* pPatch = pLandscape->getPatchData(1).pPatch;
+	const int sizes[2] = { 1000, 10000 };
+	for (int i = 0; i < 2; i++) {
+		int ninds = quick ? sizes[i] / 10 : sizes[i];
+		float localK = (float)ninds;
+		Population* pPop = 0;
+		auto newPop = [&]() {
+			if (pPop != 0) { delete pPop; pPatch->resetPopn(); }
+			pPop = new Population(pSpecies, pPatch, ninds, benchResol);
+		};
+		benchParams params{ { "inds", ninds } };
+		runBench("Population::reproduction", params, "individual", ninds, newPop,
+			[&]() { pPop->reproduction(localK, 1.0, benchResol); });
+		runBench("Population::emigration", params, "individual", ninds, newPop,
+			[&]() { pPop->emigration(localK); });
+		runBench("Population::survival0", params, "individual", ninds, newPop,
+			[&]() { pPop->survival0(localK, 1, 1); });
+		if (pPop != 0) { delete pPop; pPatch->resetPopn(); }
+	}
+}
+
+//---------------------------------------------------------------------------
+
+// Write the results as JSON, with the keys of each object in a fixed order
+static void writeResults(ostream& out) {
+	out << "{" << endl;
+	out << "\t\"format\": " << benchFormat << "," << endl;
+	out << "\t\"version\": \"" << RS_VERSION << "\"," << endl;
+#if RSDEBUG
+	out << "\t\"build\": \"debug\"," << endl;
+#else
+	out << "\t\"build\": \"release\"," << endl;
+#endif
+	out << "\t\"quick\": " << (quick ? "true" : "false") << "," << endl;
+	out << "\t\"repetitions\": " << nReps << "," << endl;
+	out << "\t\"unit\": \"ns\"," << endl;
+	out << "\t\"results\": [";
+	out << fixed << setprecision(2);
+	for (int i = 0; i < (int)results.size(); i++) {
+		const benchResult& r = results[i];
+		vector <double> ns = r.ns;
+		sort(ns.begin(), ns.end());
+		double median = ns.size() % 2 == 1 ? ns[ns.size() / 2]
+			: 0.5 * (ns[ns.size() / 2 - 1] + ns[ns.size() / 2]);
+		out << (i > 0 ? "," : "") << endl;
+		out << "\t\t{ \"name\": \"" << r.name << "\", \"params\": {";
+		for (int j = 0; j < (int)r.params.size(); j++) {
+			out << (j > 0 ? ", " : " ") << "\"" << r.params[j].first << "\": " << r.params[j].second;
+		}
+		out << (r.params.size() > 0 ? " }" : "}");
+		out << ", \"per\": \"" << r.per << "\", \"ops\": " << r.ops
+			<< ", \"median\": " << median << ", \"min\": " << ns.front()
+			<< ", \"max\": " << ns.back() << " }";
+	}
+	out << endl << "\t]" << endl << "}" << endl;
+}
+
+int main(int argc, char* argv[])
+{
+	string outname, dir = "./";
+	for (int i = 1; i < argc; i++) {
+		string arg = argv[i];
+		if (arg == "-quick") quick = true;
+		else if (arg == "-reps" && i + 1 < argc) nReps = atoi(argv[++i]);
+		else if (arg == "-filter" && i + 1 < argc) filter = argv[++i];
+		else if (arg == "-out" && i + 1 < argc) outname = argv[++i];
+		else if (arg == "-dir" && i + 1 < argc) {
+			dir = argv[++i];
+			if (dir.back() != '/' && dir.back() != '\\') dir += "/";
+		}
+		else {
+			cout << "Usage: RangeShifter_bench [-quick] [-reps n] [-filter name] [-out file.json]"
+				<< " [-dir folder]" << endl;
+			return 1;
+		}
+	}
+	if (nReps < 1) nReps = 1;
+
+	paramsGrad = new paramGrad;
+	paramsStoch = new paramStoch;
+	paramsInit = new paramInit;
+	paramsSim = new paramSim;
+	simParams sim = paramsSim->getSim();
+	sim.batchMode = true;
+	paramsSim->setSim(sim);
+	pSpecies = new Species;
+	pComm = 0;
+	pRandom = new RSrandom();
+
+	// a suitable cell holds benchK individuals
+	pSpecies->createHabK(2);
+	pSpecies->setHabK(0, 0.0); pSpecies->setHabK(1, benchK);
+
+	benchRandom();
+	benchReadLandscape(dir);
+	if (selected("Individual::") || selected("Chromosome::") || selected("Population::")) {
+		int dim = quick ? 200 : 500;
+		Landscape* pLandscape = generateLandscape(dim, dim);
+		benchHabMatrix(pLandscape);
+		benchMovement(pLandscape);
+		benchInherit();
+		benchPopulation(pLandscape);
+		delete pLandscape;
+	}
+
+	if (outname.empty()) writeResults(cout);
+	else {
+		ofstream out(outname.c_str());
+		writeResults(out);
+		if (!out.good()) {
+			cerr << "*** Unable to write " << outname << endl;
+			return 1;
+		}
+	}
+
+	delete pRandom;
+	delete pSpecies;
+	delete paramsSim; delete paramsInit; delete paramsStoch; delete paramsGrad;
+	return 0;
+}
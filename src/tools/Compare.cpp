@@ -0,0 +1,369 @@
+/*----------------------------------------------------------------------------
+ *	
+ *	Copyright (C) 2020 Greta Bocedi, Stephen C.F. Palmer, Justin M.J. Travis, Anne-Kathleen Malchow, Damaris Zurell 
+ *	
+ *	This file is part of RangeShifter.
+ *	
+ *	RangeShifter is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *	
+ *	RangeShifter is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *	GNU General Public License for more details.
+ *	
+ *	You should have received a copy of the GNU General Public License
+ *	along with RangeShifter. If not, see <https://www.gnu.org/licenses/>.
+ *	
+ --------------------------------------------------------------------------*/
+ 
+/*------------------------------------------------------------------------------
+
+RangeShifter v2.0 Compare
+
+Entry level function for the RangeShifter_compare tool, which checks that the
+range, population and occupancy outputs of a run under optional engine settings
+are equivalent to those of the reference code path (see
+run_on_gha/check_equivalence.bash).
+
+Usage: RangeShifter_compare [-stats [-reps n] [-alpha 0.01] [-tol 0.05]]
+         reference.txt alternative.txt [...]
+
+By default, each pair of files must be identical, as they are when the settings
+preserve the order of random numbers. With -stats, they are compared over their
+replicates: range and population files by two-sample Kolmogorov-Smirnov tests of
+each column in each year (pooling patches or cells), occupancy files by
+chi-squared tests of the no. of replicates in which each patch or cell is
+occupied in each year (which needs the no. of replicates), and occupancy
+statistics by the standard errors of their means. A test fails if it is
+significant at level alpha, Bonferroni-corrected for the no. of tests of the
+file, and its means differ by more than the relative tolerance.
+
+For full details of RangeShifter, please see:
+Bocedi G., Palmer S.C.F., Peer G., Heikkinen R.K., Matsinos Y.G., Watts K.
+and Travis J.M.J. (2014). RangeShifter: a platform for modelling spatial
+eco-evolutionary dynamics and species responses to environmental changes.
+Methods in Ecology and Evolution, 5, 388-396. doi: 10.1111/2041-210X.12162
+
+------------------------------------------------------------------------------*/
+
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <map>
+#include <algorithm>
+
+using namespace std;
+
+// A tab-separated output file, as its column names and its rows of values
+struct outFile {
+	vector <string> cols;
+	vector <vector <double> > rows;
+};
+
+// A statistical test of one column in one year of the outputs
+struct compTest {
+	string what;
+	double stat;
+	double p;
+	double refMean, altMean;
+};
+
+static bool readOutput(const string name, outFile& f) {
+	ifstream in(name.c_str());
+	if (!in.is_open()) {
+		cout << "*** Unable to open " << name << endl;
+		return false;
+	}
+	string line, item;
+	getline(in, line);
+	stringstream hs(line);
+	while (getline(hs, item, '\t')) {
+		if (!item.empty() && item.back() == '\r') item.pop_back();
+		f.cols.push_back(item);
+	}
+	while (getline(in, line)) {
+		if (line.empty() || line == "\r") continue;
+		vector <double> row;
+		stringstream ls(line);
+		while (getline(ls, item, '\t')) row.push_back(atof(item.c_str()));
+		row.resize(f.cols.size(), 0.0);
+		f.rows.push_back(row);
+	}
+	return true;
+}
+
+static int colIndex(const outFile& f, const string name) {
+	for (int i = 0; i < (int)f.cols.size(); i++) if (f.cols[i] == name) return i;
+	return -1;
+}
+
+static double mean(const vector <double>& x) {
+	if (x.empty()) return 0.0;
+	double sum = 0.0;
+	for (double v : x) sum += v;
+	return sum / (double)x.size();
+}
+
+//---------------------------------------------------------------------------
+
+// Two-sample Kolmogorov-Smirnov test, with the asymptotic distribution of the statistic
+// (as in Press et al., Numerical Recipes); ties make it conservative for counts
+static double ksTest(vector <double> x, vector <double> y, double& d) {
+	sort(x.begin(), x.end()); sort(y.begin(), y.end());
+	size_t i = 0, j = 0;
+	double nx = (double)x.size(), ny = (double)y.size();
+	d = 0.0;
+	while (i < x.size() && j < y.size()) {
+		double v = min(x[i], y[j]);
+		while (i < x.size() && x[i] <= v) i++;
+		while (j < y.size() && y[j] <= v) j++;
+		d = max(d, fabs((double)i / nx - (double)j / ny));
+	}
+	double ne = sqrt(nx * ny / (nx + ny));
+	double lambda = (ne + 0.12 + 0.11 / ne) * d;
+	if (lambda < 0.2) return 1.0;
+	double p = 0.0, sign = 1.0;
+	for (int k = 1; k <= 100; k++) {
+		double term = sign * 2.0 * exp(-2.0 * k * k * lambda * lambda);
+		p += term;
+		if (fabs(term) < 1.0e-10) break;
+		sign = -sign;
+	}
+	return min(max(p, 0.0), 1.0);
+}
+
+// Upper regularised incomplete gamma function Q(a, x), by its series for x < a + 1
+// and otherwise its continued fraction
+static double gammaQ(const double a, const double x) {
+	if (x <= 0.0) return 1.0;
+	double lnpre = a * log(x) - x - lgamma(a);
+	if (x < a + 1.0) {
+		double ap = a, del = 1.0 / a, sum = del;
+		for (int n = 0; n < 1000 && fabs(del) > fabs(sum) * 1.0e-14; n++) {
+			ap += 1.0; del *= x / ap; sum += del;
+		}
+		return max(0.0, 1.0 - sum * exp(lnpre));
+	}
+	double b = x + 1.0 - a, c = 1.0e300, dd = 1.0 / b, h = dd;
+	for (int i = 1; i < 1000; i++) {
+		double an = -i * (i - a);
+		b += 2.0;
+		dd = an * dd + b; if (fabs(dd) < 1.0e-300) dd = 1.0e-300;
+		c = b + an / c; if (fabs(c) < 1.0e-300) c = 1.0e-300;
+		dd = 1.0 / dd;
+		double del = dd * c;
+		h *= del;
+		if (fabs(del - 1.0) < 1.0e-14) break;
+	}
+	return exp(lnpre) * h;
+}
+
+// Chi-squared test of homogeneity of the no. of replicates in which each patch (or cell)
+// is occupied, between two runs of the same no. of replicates
+static double chiSqTest(const vector <double>& x, const vector <double>& y, const int reps,
+	double& chisq)
+{
+	chisq = 0.0;
+	int df = 0; // 1 for the 2x2 table of each patch (or cell) which varies
+	for (size_t i = 0; i < x.size(); i++) {
+		double occ = x[i] + y[i];
+		if (occ == 0.0 || occ == 2.0 * reps) continue; // no variation
+		double expOcc = occ / 2.0, expEmpty = reps - expOcc;
+		chisq += ((x[i] - expOcc) * (x[i] - expOcc) + (y[i] - expOcc) * (y[i] - expOcc)) / expOcc
+			+ ((x[i] - expOcc) * (x[i] - expOcc) + (y[i] - expOcc) * (y[i] - expOcc)) / expEmpty;
+		df++;
+	}
+	if (df < 1) return 1.0;
+	return gammaQ(df / 2.0, chisq / 2.0);
+}
+
+//---------------------------------------------------------------------------
+
+// Columns which identify a record, rather than being outputs of the model
+static bool idColumn(const string col) {
+	return col == "Rep" || col == "Year" || col == "RepSeason" || col == "PatchID"
+		|| col == "X" || col == "Y" || col == "x" || col == "y" || col == "Ncells"
+		|| col == "Species";
+}
+
+// Compare each output column in each year and season of a range or population file,
+// pooling the values of all replicates (and patches or cells)
+static void ksTests(const outFile& ref, const outFile& alt, vector <compTest>& tests) {
+	int iyear = colIndex(ref, "Year"), iseason = colIndex(ref, "RepSeason");
+	map <pair <int, int>, pair <vector <int>, vector <int> > > years; // rows of each year
+	for (int r = 0; r < (int)ref.rows.size(); r++)
+		years[make_pair((int)ref.rows[r][iyear], iseason < 0 ? 0 : (int)ref.rows[r][iseason])].first.push_back(r);
+	for (int r = 0; r < (int)alt.rows.size(); r++)
+		years[make_pair((int)alt.rows[r][iyear], iseason < 0 ? 0 : (int)alt.rows[r][iseason])].second.push_back(r);
+	for (auto& yr : years) {
+		for (int c = 0; c < (int)ref.cols.size(); c++) {
+			if (idColumn(ref.cols[c])) continue;
+			vector <double> x, y;
+			for (int r : yr.second.first) x.push_back(ref.rows[r][c]);
+			for (int r : yr.second.second) y.push_back(alt.rows[r][c]);
+			compTest t;
+			t.what = ref.cols[c] + " in year " + to_string(yr.first.first)
+				+ (iseason < 0 ? "" : " season " + to_string(yr.first.second));
+			t.refMean = mean(x); t.altMean = mean(y);
+			if (x.empty() || y.empty()) { // a year reached by one run only
+				t.stat = 1.0; t.p = 0.0;
+			}
+			else t.p = ksTest(x, y, t.stat);
+			tests.push_back(t);
+		}
+	}
+}
+
+// Compare the occupancy of patches (or cells) in each year
+static void occupancyTests(const outFile& ref, const outFile& alt, const int reps,
+	vector <compTest>& tests)
+{
+	int nid = colIndex(ref, "PatchID") >= 0 ? 1 : 2;
+	map <pair <int, int>, pair <int, int> > locns; // rows of each patch or cell
+	for (int r = 0; r < (int)ref.rows.size(); r++)
+		locns[make_pair((int)ref.rows[r][0], nid > 1 ? (int)ref.rows[r][1] : 0)].first = r + 1;
+	for (int r = 0; r < (int)alt.rows.size(); r++)
+		locns[make_pair((int)alt.rows[r][0], nid > 1 ? (int)alt.rows[r][1] : 0)].second = r + 1;
+	for (int c = nid; c < (int)ref.cols.size(); c++) {
+		vector <double> x, y;
+		for (auto& loc : locns) { // counts of occupied replicates (0 if not written)
+			x.push_back(loc.second.first > 0 ? floor(ref.rows[loc.second.first - 1][c] * reps + 0.5) : 0.0);
+			y.push_back(loc.second.second > 0 ? floor(alt.rows[loc.second.second - 1][c] * reps + 0.5) : 0.0);
+		}
+		compTest t;
+		t.what = "occupancy " + ref.cols[c];
+		t.refMean = mean(x) / reps; t.altMean = mean(y) / reps;
+		t.p = chiSqTest(x, y, reps, t.stat);
+		tests.push_back(t);
+	}
+}
+
+// Compare the mean occupancy of suitable habitat in each year, by its standard errors
+static void occSuitTests(const outFile& ref, const outFile& alt, vector <compTest>& tests) {
+	for (int r = 0; r < (int)ref.rows.size() && r < (int)alt.rows.size(); r++) {
+		compTest t;
+		t.what = "Mean_OccupSuit in year " + to_string((int)ref.rows[r][0]);
+		t.refMean = ref.rows[r][1]; t.altMean = alt.rows[r][1];
+		double se = sqrt(ref.rows[r][2] * ref.rows[r][2] + alt.rows[r][2] * alt.rows[r][2]);
+		if (se > 0.0) {
+			t.stat = fabs(t.refMean - t.altMean) / se;
+			t.p = erfc(t.stat / sqrt(2.0));
+		}
+		else {
+			t.stat = 0.0;
+			t.p = t.refMean == t.altMean ? 1.0 : 0.0;
+		}
+		tests.push_back(t);
+	}
+	if (ref.rows.size() != alt.rows.size()) {
+		compTest t;
+		t.what = "no. of years"; t.stat = 0.0; t.p = 0.0;
+		t.refMean = (double)ref.rows.size(); t.altMean = (double)alt.rows.size();
+		tests.push_back(t);
+	}
+}
+
+// Compare two output files statistically; a test fails if it is significant at the given
+// level, with a Bonferroni correction for the no. of tests of the file, and its means
+// differ by more than the given tolerance (relative to the larger)
+static bool compareStats(const string refname, const string altname, const int reps,
+	const double alpha, const double tol)
+{
+	outFile ref, alt;
+	if (!readOutput(refname, ref) || !readOutput(altname, alt)) return false;
+	if (ref.cols != alt.cols) {
+		cout << altname << " has different columns from " << refname << endl;
+		return false;
+	}
+	vector <compTest> tests;
+	if (refname.find("_Occupancy_Stats") != string::npos) occSuitTests(ref, alt, tests);
+	else if (refname.find("_Occupancy") != string::npos) {
+		if (reps < 2) {
+			cout << "*** The no. of replicates (-reps) is required to compare " << refname << endl;
+			return false;
+		}
+		occupancyTests(ref, alt, reps, tests);
+	}
+	else {
+		if (colIndex(ref, "Year") < 0) {
+			cout << "*** Unable to compare " << refname << ", which has no Year column" << endl;
+			return false;
+		}
+		ksTests(ref, alt, tests);
+	}
+
+	double level = tests.empty() ? alpha : alpha / (double)tests.size();
+	double minp = 1.0;
+	int nfailed = 0;
+	for (compTest& t : tests) {
+		minp = min(minp, t.p);
+		double scale = max(fabs(t.refMean), fabs(t.altMean));
+		double reldiff = scale > 0.0 ? fabs(t.refMean - t.altMean) / scale : 0.0;
+		if (t.p < level && reldiff > tol) {
+			if (nfailed == 0) cout << altname << " differs from " << refname << ":" << endl;
+			cout << "  " << t.what << ": mean " << t.refMean << " vs " << t.altMean
+				<< ", statistic " << t.stat << ", p = " << t.p << endl;
+			nfailed++;
+		}
+	}
+	cout << altname << ": " << tests.size() << " tests, min. p = " << minp
+		<< (nfailed > 0 ? ", " + to_string(nfailed) + " failed" : ", equivalent") << endl;
+	return nfailed == 0;
+}
+
+// Compare two output files line by line, for a bit-exact match
+static bool compareExact(const string refname, const string altname) {
+	ifstream ref(refname.c_str()), alt(altname.c_str());
+	if (!ref.is_open() || !alt.is_open()) {
+		cout << "*** Unable to open " << (ref.is_open() ? altname : refname) << endl;
+		return false;
+	}
+	string refline, altline;
+	for (int line = 1; ; line++) {
+		bool moreref = (bool)getline(ref, refline), morealt = (bool)getline(alt, altline);
+		if (!moreref && !morealt) break;
+		if (moreref != morealt || refline != altline) {
+			cout << altname << " differs from " << refname << " at line " << line << ":" << endl
+				<< "< " << (moreref ? refline : "(end of file)") << endl
+				<< "> " << (morealt ? altline : "(end of file)") << endl;
+			return false;
+		}
+	}
+	cout << altname << ": identical" << endl;
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	bool stats = false;
+	int reps = 0;
+	double alpha = 0.01, tol = 0.05;
+	vector <string> files;
+	for (int i = 1; i < argc; i++) {
+		string arg = argv[i];
+		if (arg == "-stats") stats = true;
+		else if (arg == "-reps" && i + 1 < argc) reps = atoi(argv[++i]);
+		else if (arg == "-alpha" && i + 1 < argc) alpha = atof(argv[++i]);
+		else if (arg == "-tol" && i + 1 < argc) tol = atof(argv[++i]);
+		else files.push_back(arg);
+	}
+	if (files.empty() || files.size() % 2 != 0 || alpha <= 0.0 || alpha >= 1.0 || tol < 0.0) {
+		cout << "Usage: RangeShifter_compare [-stats [-reps n] [-alpha 0.01] [-tol 0.05]]"
+			<< " reference.txt alternative.txt [...]" << endl;
+		return 1;
+	}
+	int ndiffer = 0;
+	for (size_t i = 0; i < files.size(); i += 2) {
+		bool same = stats ? compareStats(files[i], files[i + 1], reps, alpha, tol)
+			: compareExact(files[i], files[i + 1]);
+		if (!same) ndiffer++;
+	}
+	return ndiffer > 0 ? 1 : 0;
+}
@@ -0,0 +1,102 @@
+/*----------------------------------------------------------------------------
+ *	
+ *	Copyright (C) 2020 Greta Bocedi, Stephen C.F. Palmer, Justin M.J. Travis, Anne-Kathleen Malchow, Damaris Zurell 
+ *	
+ *	This file is part of RangeShifter.
+ *	
+ *	RangeShifter is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *	
+ *	RangeShifter is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *	GNU General Public License for more details.
+ *	
+ *	You should have received a copy of the GNU General Public License
+ *	along with RangeShifter. If not, see <https://www.gnu.org/licenses/>.
+ *	
+ --------------------------------------------------------------------------*/
+ 
+/*------------------------------------------------------------------------------
+
+RangeShifter v2.0 Convert
+
+Entry level function for the RangeShifter_convert tool, which converts binary
+columnar output files (.rsb) and packed allele matrices (.rsg), see
+RScore/OutputTable.h, to the tab-separated text files which RangeShifter would
+otherwise have written. A packed allele matrix is written in the layout of the
+genetics cross table.
+
+Usage: RangeShifter_convert file.rsb|file.rsg [...]
+
+Each file is written as file.txt in the same folder.
+
+For full details of RangeShifter, please see:
+Bocedi G., Palmer S.C.F., Peer G., Heikkinen R.K., Matsinos Y.G., Watts K.
+and Travis J.M.J. (2014). RangeShifter: a platform for modelling spatial
+eco-evolutionary dynamics and species responses to environmental changes.
+Methods in Ecology and Evolution, 5, 388-396. doi: 10.1111/2041-210X.12162
+
+------------------------------------------------------------------------------*/
+
+#include <string>
+#include <iostream>
+#include <fstream>
+
+using namespace std;
+
+#include "../RScore/OutputTable.h"
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2) {
+		cout << "Usage: RangeShifter_convert file.rsb|file.rsg [...]" << endl;
+		return 1;
+	}
+	int nerrors = 0;
+	inTable table;
+	inGenMatrix matrix;
+	for (int i = 1; i < argc; i++) {
+		string name = argv[i];
+		string outname = name;
+		string ext;
+		if (outname.size() > 4) ext = outname.substr(outname.size() - 4);
+		if (ext == ".rsb" || ext == ".rsg")
+			outname = outname.substr(0, outname.size() - 4);
+		outname += ".txt";
+		if (ext == ".rsg") {
+			if (!matrix.open(name)) {
+				cout << "*** Unable to read " << name << " as a RangeShifter allele matrix" << endl;
+				nerrors++; continue;
+			}
+			ofstream out(outname.c_str());
+			if (!out.is_open()) {
+				cout << "*** Unable to open " << outname << endl;
+				matrix.close(); nerrors++; continue;
+			}
+			matrix.writeHeader(out);
+			while (matrix.readBlock()) matrix.writeBlock(out);
+			out.close();
+			matrix.close();
+			cout << name << " -> " << outname << endl;
+			continue;
+		}
+		if (!table.open(name)) {
+			cout << "*** Unable to read " << name << " as a RangeShifter binary file" << endl;
+			nerrors++; continue;
+		}
+		ofstream out(outname.c_str());
+		if (!out.is_open()) {
+			cout << "*** Unable to open " << outname << endl;
+			table.close(); nerrors++; continue;
+		}
+		table.writeHeader(out);
+		while (table.readBlock()) table.writeBlock(out);
+		out.close();
+		table.close();
+		cout << name << " -> " << outname << endl;
+	}
+	return nerrors > 0 ? 1 : 0;
+}
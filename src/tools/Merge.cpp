@@ -0,0 +1,185 @@
+/*----------------------------------------------------------------------------
+ *	
+ *	Copyright (C) 2020 Greta Bocedi, Stephen C.F. Palmer, Justin M.J. Travis, Anne-Kathleen Malchow, Damaris Zurell 
+ *	
+ *	This file is part of RangeShifter.
+ *	
+ *	RangeShifter is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *	
+ *	RangeShifter is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *	GNU General Public License for more details.
+ *	
+ *	You should have received a copy of the GNU General Public License
+ *	along with RangeShifter. If not, see <https://www.gnu.org/licenses/>.
+ *	
+ --------------------------------------------------------------------------*/
+ 
+/*------------------------------------------------------------------------------
+
+RangeShifter v2.0 Merge
+
+Entry level function for the RangeShifter_merge tool, which reassembles output
+files written as a shard per replicate (see RScore/OutputWriter.h) into the single
+files which RangeShifter would otherwise have written, as listed in the index file
+of each simulation (..._Shards.txt). Text files (.txt) are merged keeping only the
+header of the first shard, and binary columnar files (.rsb) keeping only the schema
+of the first shard and the end of the last. Compressed shards must be decompressed
+before merging. The shards are not deleted.
+
+Usage: RangeShifter_merge index.txt [...]
+
+Each file is written in the folder of the index.
+
+For full details of RangeShifter, please see:
+Bocedi G., Palmer S.C.F., Peer G., Heikkinen R.K., Matsinos Y.G., Watts K.
+and Travis J.M.J. (2014). RangeShifter: a platform for modelling spatial
+eco-evolutionary dynamics and species responses to environmental changes.
+Methods in Ecology and Evolution, 5, 388-396. doi: 10.1111/2041-210X.12162
+
+------------------------------------------------------------------------------*/
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <vector>
+
+using namespace std;
+
+#include "../RScore/OutputTable.h"
+
+#define MERGEBUFSIZE 4194304
+
+// Return the size of the schema of a binary table file, or 0 if it is not one
+static long schemaSize(std::FILE* f) {
+	char magic[8];
+	unsigned int bom, ncols;
+	unsigned short len;
+	char type;
+	if (std::fread(magic, 1, 8, f) != 8 || memcmp(magic, OUTTABLEMAGIC, 8) != 0) return 0;
+	if (std::fread(&bom, sizeof(bom), 1, f) != 1 || bom != 0x01020304) return 0;
+	if (std::fread(&ncols, sizeof(ncols), 1, f) != 1) return 0;
+	for (unsigned int i = 0; i < ncols; i++) {
+		if (std::fread(&type, 1, 1, f) != 1 || std::fread(&len, sizeof(len), 1, f) != 1) return 0;
+		if (std::fseek(f, len, SEEK_CUR) != 0) return 0;
+	}
+	return std::ftell(f);
+}
+
+// Copy bytes from the current position of a file up to a given end (or to its end if < 0)
+static bool copyData(std::FILE* in, std::FILE* out, long end, vector <char>& buf) {
+	long pos = std::ftell(in);
+	while (end < 0 || pos < end) {
+		size_t n = buf.size();
+		if (end >= 0 && (long)n > end - pos) n = (size_t)(end - pos);
+		size_t nread = std::fread(buf.data(), 1, n, in);
+		if (nread == 0) return end < 0 && !std::ferror(in);
+		if (std::fwrite(buf.data(), 1, nread, out) != nread) return false;
+		pos += (long)nread;
+	}
+	return true;
+}
+
+// Append a shard to the merged file, excluding its header unless it is the first shard,
+// and for a binary table, its end unless it is the last
+static bool appendShard(const string name, std::FILE* out, bool first, bool last,
+	vector <char>& buf)
+{
+	std::FILE* in = std::fopen(name.c_str(), "rb");
+	if (in == 0) {
+		cout << "*** Unable to open " << name << endl;
+		return false;
+	}
+	bool ok = true;
+	string ext;
+	if (name.size() > 4) ext = name.substr(name.size() - 4);
+	if (ext == ".rsb") {
+		long start = schemaSize(in);
+		std::fseek(in, 0, SEEK_END);
+		long end = std::ftell(in) - (long)sizeof(unsigned int);
+		if (start == 0 || end < start) {
+			cout << "*** Unable to read " << name << " as a RangeShifter binary file" << endl;
+			ok = false;
+		}
+		else {
+			std::fseek(in, first ? 0 : start, SEEK_SET);
+			ok = copyData(in, out, last ? -1 : end, buf);
+		}
+	}
+	else {
+		if (!first) { // skip the header line
+			int c;
+			while ((c = std::fgetc(in)) != EOF && c != '\n') { }
+		}
+		ok = copyData(in, out, -1, buf);
+	}
+	std::fclose(in);
+	return ok;
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2) {
+		cout << "Usage: RangeShifter_merge index.txt [...]" << endl;
+		return 1;
+	}
+	int nerrors = 0;
+	vector <char> buf(MERGEBUFSIZE);
+	for (int i = 1; i < argc; i++) {
+		string index = argv[i];
+		string dir;
+		size_t ix = index.find_last_of("/\\");
+		if (ix != string::npos) dir = index.substr(0, ix + 1);
+		ifstream in(index.c_str());
+		string header;
+		getline(in, header);
+		if (!in.is_open() || header != "Rep\tShard\tFile") {
+			cout << "*** Unable to read " << index << " as an index of RangeShifter output shards" << endl;
+			nerrors++; continue;
+		}
+		// list the shards of each file in order of replicate
+		vector <string> files;
+		vector <vector <string> > shards;
+		int rep;
+		string shard, file;
+		while (in >> rep >> shard >> file) {
+			int f = 0;
+			while (f < (int)files.size() && files[f] != file) f++;
+			if (f == (int)files.size()) { files.push_back(file); shards.push_back(vector <string>()); }
+			shards[f].push_back(shard);
+		}
+		in.close();
+
+		for (int f = 0; f < (int)files.size(); f++) {
+			string ext;
+			if (files[f].size() > 4) ext = files[f].substr(files[f].size() - 4);
+			if (ext != ".txt" && ext != ".rsb") {
+				cout << "*** Unable to merge compressed file " << files[f] << endl;
+				nerrors++; continue;
+			}
+			string outname = dir + files[f];
+			std::FILE* out = std::fopen(outname.c_str(), "wb");
+			if (out == 0) {
+				cout << "*** Unable to open " << outname << endl;
+				nerrors++; continue;
+			}
+			bool ok = true;
+			int nshards = (int)shards[f].size();
+			for (int s = 0; s < nshards && ok; s++)
+				ok = appendShard(dir + shards[f][s], out, s == 0, s == nshards - 1, buf);
+			if (std::fclose(out) != 0) ok = false;
+			if (ok) cout << nshards << " shards -> " << outname << endl;
+			else {
+				cout << "*** Unable to merge " << outname << endl;
+				nerrors++;
+			}
+		}
+	}
+	return nerrors > 0 ? 1 : 0;
+}
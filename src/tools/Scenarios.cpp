@@ -0,0 +1,553 @@
+/*----------------------------------------------------------------------------
+ *	
+ *	Copyright (C) 2020 Greta Bocedi, Stephen C.F. Palmer, Justin M.J. Travis, Anne-Kathleen Malchow, Damaris Zurell 
+ *	
+ *	This file is part of RangeShifter.
+ *	
+ *	RangeShifter is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *	
+ *	RangeShifter is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *	GNU General Public License for more details.
+ *	
+ *	You should have received a copy of the GNU General Public License
+ *	along with RangeShifter. If not, see <https://www.gnu.org/licenses/>.
+ *	
+ --------------------------------------------------------------------------*/
+ 
+/*------------------------------------------------------------------------------
+
+RangeShifter v2.0 Scenarios
+
+Entry level function for the RangeShifter_scenarios tool, which generates batch
+project folders of benchmark scenarios of increasing size, and runs them to give
+scaling curves of throughput and memory.
+
+Usage: RangeShifter_scenarios generate folder [-sizes 4,5,6] [-models cell,patch]
+         [-transfer kernel,sms,crw] [-genetics 0,1] [-reps 1] [-years 10]
+       RangeShifter_scenarios run folder RangeShifter_executable
+
+generate writes a project folder for each combination of landscape size (approx.
+10^4 to 10^8 cells, as fractal landscapes of 30% suitable habitat), cell- or
+patch-based model, transfer method and absence or presence of genetics (an
+evolving emigration probability), listed in Scenarios.txt. A cell-based
+landscape is generated by RangeShifter itself as an artificial landscape; for a
+patch-based model, the habitat and patch rasters of each size are generated once,
+by the same fractal generator, in the Landscapes folder. run executes each
+scenario listed, and writes Scenarios_results.txt, giving for each its wall and
+model time (s), peak resident memory (MB), and individual-years and
+individual-steps (movement steps, or dispersal kernel moves) per second of model
+time. Each scenario asks for a pre-flight estimate, so one which would not fit
+in memory is not run.
+
+For full details of RangeShifter, please see:
+Bocedi G., Palmer S.C.F., Peer G., Heikkinen R.K., Matsinos Y.G., Watts K.
+and Travis J.M.J. (2014). RangeShifter: a platform for modelling spatial
+eco-evolutionary dynamics and species responses to environmental changes.
+Methods in Ecology and Evolution, 5, 388-396. doi: 10.1111/2041-210X.12162
+
+------------------------------------------------------------------------------*/
+
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
+#include <sys/stat.h>
+
+#if LINUX_CLUSTER
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#else
+#include <direct.h>
+#endif
+
+using namespace std;
+
+#include "../RScore/RSrandom.h"
+#include "../RScore/FractalGenerator.h"
+
+// Globals required by RScore (see Main.cpp)
+RSrandom *pRandom;          // pointer to random number routines
+#if RSDEBUG
+ofstream DEBUGLOG;
+#endif
+
+//---------------------------------------------------------------------------
+
+const int scenResol = 100;		// landscape resolution (m), so that a cell is 1 ha
+const float scenK = 2.0;			// carrying capacity of suitable habitat (inds./ha)
+const float scenPsuit = 0.3f;	// proportion of suitable habitat
+const float scenHurst = 0.5f;	// Hurst exponent of fractal landscapes
+const char* transferNames[3] = { "kernel", "sms", "crw" };
+
+struct scenario {
+	int size;					// landscape size class: approx. 10^size cells
+	bool patchModel;
+	short transfer;		// 0 = kernel, 1 = SMS, 2 = CRW
+	bool genetics;		// emigration probability evolves (individual variability)?
+	int dimX, dimY;
+	string name;
+};
+
+// Dimensions of the fractal landscape of a size class, which must be a power of 2 plus 1
+// with Y >= X, chosen as the closest (on a log scale) to 10^size cells
+static void landDims(const int size, int& dimX, int& dimY) {
+	switch (size) {
+	case 4: dimX = 65; dimY = 129; break;
+	case 5: dimX = 257; dimY = 513; break;
+	case 6: dimX = 1025; dimY = 1025; break;
+	case 7: dimX = 2049; dimY = 4097; break;
+	default: dimX = 8193; dimY = 16385; break;
+	}
+}
+
+static string scenarioName(const scenario& s) {
+	return "L" + to_string(s.size) + (s.patchModel ? "_patch_" : "_cell_")
+		+ transferNames[s.transfer] + (s.genetics ? "_gen" : "_nogen");
+}
+
+static bool makeDir(const string dir) {
+#if LINUX_CLUSTER
+	if (mkdir(dir.c_str(), 0755) == 0) return true;
+#else
+	if (_mkdir(dir.c_str()) == 0) return true;
+#endif
+	struct stat st;
+	return stat(dir.c_str(), &st) == 0 && (st.st_mode & S_IFDIR);
+}
+
+static bool fileExists(const string name) {
+	struct stat st;
+	return stat(name.c_str(), &st) == 0;
+}
+
+// Parse a comma-separated list of integers or names
+static vector <string> splitList(const string list) {
+	vector <string> items;
+	stringstream ss(list);
+	string item;
+	while (getline(ss, item, ',')) if (!item.empty()) items.push_back(item);
+	return items;
+}
+
+//---------------------------------------------------------------------------
+
+// Write the habitat (1 = matrix, 2 = habitat) and patch rasters of a fractal landscape
+// generated as by Landscape::generatePatches(), in which each patch is a connected
+// (4-neighbour) group of habitat cells
+static bool writeLandscape(const string dir, const int size) {
+	int dimX, dimY;
+	landDims(size, dimX, dimY);
+	string habfile = dir + "L" + to_string(size) + "_hab.txt";
+	string pchfile = dir + "L" + to_string(size) + "_patch.txt";
+	if (fileExists(habfile) && fileExists(pchfile)) return true;
+
+	cout << "Generating landscape of " << (long long)dimX * dimY << " cells ..." << endl;
+	long long ncells = (long long)dimX * dimY;
+	vector <char> hab(ncells, 0); // indexed [y * dimX + x], with y = 0 at the bottom
+	{
+		// as in generatePatches(), X and Y of the fractal are transposed
+		vector<land>& frac = fractal_landscape(dimY, dimX, scenHurst, 1.0 - scenPsuit, 100.0, 1.0);
+		for (vector<land>::iterator iter = frac.begin(); iter != frac.end(); iter++) {
+			if (iter->avail != 0)
+				hab[(long long)iter->x_coord * dimX + iter->y_coord] = 1;
+		}
+		frac.clear(); frac.shrink_to_fit();
+	}
+
+	// label patches by union-find over the habitat cells
+	vector <int> parent(ncells, -1);
+	auto root = [&parent](long long i) {
+		while (parent[i] != i) { parent[i] = parent[parent[i]]; i = parent[i]; }
+		return i;
+	};
+	for (long long i = 0; i < ncells; i++) {
+		if (!hab[i]) continue;
+		parent[i] = (int)i;
+		int x = (int)(i % dimX);
+		if (x > 0 && hab[i - 1]) parent[root(i - 1)] = (int)root(i);
+		if (i >= dimX && hab[i - dimX]) parent[root(i - dimX)] = (int)root(i);
+	}
+	vector <int> patchnum(ncells, 0);
+	int npatches = 0;
+	for (long long i = 0; i < ncells; i++) {
+		if (!hab[i]) continue;
+		long long r = root(i);
+		if (patchnum[r] == 0) patchnum[r] = ++npatches;
+		patchnum[i] = patchnum[r];
+	}
+	parent.clear(); parent.shrink_to_fit();
+
+	ofstream hout(habfile.c_str()), pout(pchfile.c_str());
+	string header = "ncols " + to_string(dimX) + "\nnrows " + to_string(dimY)
+		+ "\nxllcorner 0\nyllcorner 0\ncellsize " + to_string(scenResol) + "\nNODATA_value -9\n";
+	hout << header; pout << header;
+	for (int y = dimY - 1; y >= 0; y--) {
+		for (int x = 0; x < dimX; x++) {
+			long long i = (long long)y * dimX + x;
+			char sep = x < dimX - 1 ? ' ' : '\n';
+			hout << (hab[i] ? 2 : 1) << sep;
+			pout << patchnum[i] << sep;
+		}
+	}
+	hout.close(); pout.close();
+	if (!hout || !pout) {
+		cout << "*** Unable to write " << habfile << " or " << pchfile << endl;
+		return false;
+	}
+	cout << "... " << npatches << " patches" << endl;
+	return true;
+}
+
+//---------------------------------------------------------------------------
+
+// Write the input files of a scenario, as a batch of a single simulation
+static bool writeScenario(const string root, const scenario& s, const int reps, const int years) {
+	string dir = root + s.name + "/";
+	string indir = dir + "Inputs/";
+	if (!makeDir(dir) || !makeDir(indir) || !makeDir(dir + "Outputs/")
+		|| !makeDir(dir + "Output_Maps/")) {
+		cout << "*** Unable to create " << dir << endl;
+		return false;
+	}
+	int nhab = s.patchModel ? 2 : 1; // as entered in the Control file
+
+	ofstream ctrl((indir + "CONTROL.txt").c_str());
+	ctrl << "BatchNum\t1" << endl
+		<< "PatchModel\t" << s.patchModel << endl
+		<< "Resolution\t" << scenResol << endl
+		<< "LandType\t" << (s.patchModel ? 0 : 9) << endl
+		<< "MaxHabitats\t" << nhab << endl
+		<< "SpeciesDist\t0" << endl
+		<< "DistResolution\t" << scenResol << endl
+		<< "Reproduction\t0" << endl
+		<< "RepSeasons\t1" << endl
+		<< "StageStruct\t0" << endl
+		<< "Stages\t2" << endl
+		<< "Transfer\t" << s.transfer << endl
+		<< "ParameterFile\tParameterFile.txt" << endl
+		<< "LandFile\tLandFile.txt" << endl
+		<< "StageStructFile\tNULL" << endl
+		<< "EmigrationFile\tEmigrationFile.txt" << endl
+		<< "TransferFile\tTransferFile.txt" << endl
+		<< "SettlementFile\tSettlementFile.txt" << endl
+		<< "GeneticsFile\t" << (s.genetics ? "GeneticsFile.txt" : "NULL") << endl
+		<< "InitialisationFile\tInitialisationFile.txt" << endl
+		<< "Profile\t1" << endl
+		<< "Preflight\t1" << endl
+		<< endl << "Benchmark scenario " << s.name << " generated by RangeShifter_scenarios" << endl;
+
+	ofstream par((indir + "ParameterFile.txt").c_str());
+	par << "Simulation\tReplicates\tYears\tAbsorbing\tGradient\tGradSteep\tOptimum\tf\tLocalExtOpt"
+		<< "\tShifting\tShiftRate\tShiftStart\tShiftEnd\tEnvStoch\tEnvStochType\tac\tstd"
+		<< "\tminR\tmaxR\tminK\tmaxK\tLocalExt\tLocalExtProb\tPropMales\tHarem\tbc\tRmax";
+	for (int i = 0; i < nhab; i++) par << "\tK" << i + 1;
+	par << "\tOutStartPop\tOutStartInd\tOutStartGenetic\tOutStartTraitCell\tOutStartTraitRow"
+		<< "\tOutStartConn\tOutIntRange\tOutIntOcc\tOutIntPop\tOutIntInd\tOutIntGenetic"
+		<< "\tOutGenType\tOutGenCrossTab\tOutIntTraitCell\tOutIntTraitRow\tOutIntConn"
+		<< "\tSaveMaps\tMapsInterval\tSMSHeatMap\tDrawLoadedSp" << endl;
+	par << "1\t" << reps << "\t" << years << "\t0\t0\t-9\t-9\t-9\t-9\t0\t-9\t-9\t-9\t0\t0\t0\t0"
+		<< "\t-9\t-9\t-9\t-9\t0\t0\t0.5\t1\t1\t2";
+	if (s.patchModel) par << "\t0";
+	par << "\t" << scenK;
+	par << "\t0\t0\t0\t0\t0\t0\t1\t0\t0\t0\t0\t0\t0\t0\t0\t0\t0\t0\t0\t0" << endl;
+
+	ofstream land((indir + "LandFile.txt").c_str());
+	if (s.patchModel) {
+		string lname = "../../Landscapes/L" + to_string(s.size);
+		land << "LandNum\tNhabitats\tLandscapeFile\tPatchFile\tCostMapFile\tDynLandFile\tSpDistFile"
+			<< endl << "1\t2\t" << lname << "_hab.txt\t" << lname << "_patch.txt\tNULL\tNULL\tNULL" << endl;
+	}
+	else {
+		// generated by the model itself, by FractalGenerator and Landscape::generatePatches()
+		land << "LandNum\tFractal\tType\tXdim\tYdim\tMinHab\tMaxHab\tPsuit\tH" << endl
+			<< "1\t1\t0\t" << s.dimX << "\t" << s.dimY << "\t-9\t-9\t" << scenPsuit << "\t"
+			<< scenHurst << endl;
+	}
+
+	ofstream emig((indir + "EmigrationFile.txt").c_str());
+	emig << "Simulation\tDensDep\tUseFullKern\tStageDep\tSexDep\tIndVar\tEmigStage\tStage\tSex"
+		<< "\tEP\tD0\talpha\tbeta\tEPMean\tEPSD\tD0Mean\tD0SD\talphaMean\talphaSD\tbetaMean\tbetaSD"
+		<< "\tEPScale\tD0Scale\talphaScale\tbetaScale" << endl;
+	if (s.genetics)
+		emig << "1\t0\t0\t0\t0\t1\t-9\t0\t0\t-9\t-9\t-9\t-9\t0.2\t0.1\t-9\t-9\t-9\t-9\t-9\t-9"
+			<< "\t0.1\t-9\t-9\t-9" << endl;
+	else
+		emig << "1\t0\t0\t0\t0\t0\t-9\t0\t0\t0.2\t-9\t-9\t-9\t-9\t-9\t-9\t-9\t-9\t-9\t-9\t-9"
+			<< "\t-9\t-9\t-9\t-9" << endl;
+
+	ofstream trfr((indir + "TransferFile.txt").c_str());
+	switch (s.transfer) {
+	case 0:
+		trfr << "Simulation\tStageDep\tSexDep\tKernelType\tDistMort\tIndVar\tStage\tSex"
+			<< "\tmeanDistI\tmeanDistII\tProbKernelI\tDistIMean\tDistISD\tDistIIMean\tDistIISD"
+			<< "\tProbKernelIMean\tProbKernelISD\tDistIScale\tDistIIScale\tProbKernelIScale"
+			<< "\tMortProb\tSlope\tInflPoint" << endl;
+		trfr << "1\t0\t0\t0\t0\t0\t0\t0\t500\t-9\t-9\t-9\t-9\t-9\t-9\t-9\t-9\t-9\t-9\t-9"
+			<< "\t0.1\t-9\t-9" << endl;
+		break;
+	case 1:
+		trfr << "Simulation\tIndVar\tPR\tPRMethod\tDP\tMemSize\tGB\tGoalType\tAlphaDB\tBetaDB"
+			<< "\tDPMean\tDPSD\tGBMean\tGBSD\tAlphaDBMean\tAlphaDBSD\tBetaDBMean\tBetaDBSD"
+			<< "\tDPScale\tGBScale\tAlphaDBScale\tBetaDBScale\tStraightenPath\tSMtype\tSMconst";
+		if (s.patchModel) trfr << "\tMortHab1\tMortHab2\tCostHab1\tCostHab2" << endl;
+		else trfr << "\tMortHabitat\tMortMatrix\tCostHabitat\tCostMatrix" << endl;
+		trfr << "1\t0\t2\t1\t5\t5\t1\t0\t-9\t-9\t-9\t-9\t-9\t-9\t-9\t-9\t-9\t-9\t-9\t-9\t-9\t-9"
+			<< "\t1\t0\t0.01\t-9\t-9";
+		if (s.patchModel) trfr << "\t10\t1" << endl; // matrix is habitat 1
+		else trfr << "\t1\t10" << endl;
+		break;
+	case 2:
+		trfr << "Simulation\tIndVar\tSL\tRho\tStepLMean\tStepLSD\tRhoMean\tRhoSD\tStepLScale"
+			<< "\tRhoScale\tStraightenPath\tSMtype\tSMconst";
+		if (s.patchModel) trfr << "\tMortHab1\tMortHab2";
+		trfr << endl << "1\t0\t" << scenResol << "\t0.7\t-9\t-9\t-9\t-9\t-9\t-9\t1\t0\t0.01";
+		if (s.patchModel) trfr << "\t-9\t-9";
+		trfr << endl;
+		break;
+	}
+
+	ofstream sett((indir + "SettlementFile.txt").c_str());
+	if (s.transfer == 0) {
+		sett << "Simulation\tStageDep\tSexDep\tStage\tSex\tSettleType\tFindMate" << endl
+			<< "1\t0\t0\t0\t0\t0\t0" << endl;
+	}
+	else {
+		sett << "Simulation\tStageDep\tSexDep\tStage\tSex\tDensDep\tIndVar\tFindMate\tMinSteps"
+			<< "\tMaxSteps\tMaxStepsYear\tS0\tAlphaS\tBetaS\tS0Mean\tS0SD\tAlphaSMean\tAlphaSSD"
+			<< "\tBetaSMean\tBetaSSD\tS0Scale\tAlphaSScale\tBetaSScale" << endl
+			<< "1\t0\t0\t0\t0\t0\t0\t0\t0\t1000\t1000\t-9\t-9\t-9\t-9\t-9\t-9\t-9\t-9\t-9\t-9\t-9\t-9"
+			<< endl;
+	}
+
+	if (s.genetics) {
+		ofstream gen((indir + "GeneticsFile.txt").c_str());
+		gen << "Simulation\tArchitecture\tNLoci\tArchFile\tProbMutn\tProbCross\tAlleleSD\tMutationSD"
+			<< endl << "1\t0\t10\tNULL\t0.001\t0.1\t0.1\t0.1" << endl;
+	}
+
+	ofstream init((indir + "InitialisationFile.txt").c_str());
+	init << "Simulation\tSeedType\tFreeType\tSpType\tInitDens\t"
+		<< (s.patchModel ? "IndsHa" : "IndsCell")
+		<< "\tminX\tmaxX\tminY\tmaxY\tNCells\tNSpCells\tInitFreezeYear\tRestrictRows"
+		<< "\tRestrictFreq\tFinalFreezeYear\tInitIndsFile" << endl;
+	init << "1\t0\t1\t-9\t1\t-9\t0\t" << s.dimX - 1 << "\t0\t" << s.dimY - 1
+		<< "\t-9\t-9\t0\t0\t0\t0\tNULL" << endl;
+
+	if (!ctrl || !par || !land || !emig || !trfr || !sett || !init) {
+		cout << "*** Unable to write the input files of " << dir << endl;
+		return false;
+	}
+	return true;
+}
+
+static int generate(const string root, const vector <string> sizes, const vector <string> models,
+	const vector <string> transfers, const vector <string> genetics, const int reps, const int years)
+{
+	if (!makeDir(root)) {
+		cout << "*** Unable to create " << root << endl;
+		return 1;
+	}
+	ofstream list((root + "Scenarios.txt").c_str());
+	int nscen = 0;
+	for (int i = 0; i < (int)sizes.size(); i++) {
+		scenario s;
+		s.size = atoi(sizes[i].c_str());
+		if (s.size < 4 || s.size > 8) {
+			cout << "*** Landscape size must be between 4 and 8 (10^4 to 10^8 cells)" << endl;
+			return 1;
+		}
+		landDims(s.size, s.dimX, s.dimY);
+		for (int m = 0; m < (int)models.size(); m++) {
+			if (models[m] != "cell" && models[m] != "patch") {
+				cout << "*** Unknown model " << models[m] << endl;
+				return 1;
+			}
+			s.patchModel = models[m] == "patch";
+			if (s.patchModel) {
+				if (!makeDir(root + "Landscapes/")) return 1;
+				if (!writeLandscape(root + "Landscapes/", s.size)) return 1;
+			}
+			for (int t = 0; t < (int)transfers.size(); t++) {
+				s.transfer = -1;
+				for (short j = 0; j < 3; j++) if (transfers[t] == transferNames[j]) s.transfer = j;
+				if (s.transfer < 0) {
+					cout << "*** Unknown transfer method " << transfers[t] << endl;
+					return 1;
+				}
+				for (int g = 0; g < (int)genetics.size(); g++) {
+					s.genetics = genetics[g] == "1";
+					s.name = scenarioName(s);
+					if (!writeScenario(root, s, reps, years)) return 1;
+					list << s.name << "\t" << (long long)s.dimX * s.dimY << endl;
+					nscen++;
+				}
+			}
+		}
+	}
+	cout << nscen << " scenarios written to " << root << endl;
+	return 0;
+}
+
+//---------------------------------------------------------------------------
+
+// Sum the given columns of a tab-separated output file over all its rows
+static bool sumColumns(const string fname, const vector <string> cols, vector <double>& sums) {
+	ifstream in(fname.c_str());
+	if (!in.is_open()) return false;
+	string line, item;
+	getline(in, line);
+	vector <int> ix(cols.size(), -1);
+	stringstream hs(line);
+	for (int i = 0; getline(hs, item, '\t'); i++) {
+		for (int j = 0; j < (int)cols.size(); j++) if (item == cols[j]) ix[j] = i;
+	}
+	sums.assign(cols.size(), 0.0);
+	while (getline(in, line)) {
+		stringstream ls(line);
+		for (int i = 0; getline(ls, item, '\t'); i++) {
+			for (int j = 0; j < (int)cols.size(); j++) if (ix[j] == i) sums[j] += atof(item.c_str());
+		}
+	}
+	return true;
+}
+
+// Run RangeShifter on a scenario, returning its exit status, wall time and peak RSS (KB)
+static int runScenario(const string exe, const string dir, double& secs, long& maxrss) {
+	string logname = dir + "Outputs/Run_log.txt";
+	chrono::steady_clock::time_point t0;
+	maxrss = -1;
+	int status = -1;
+#if LINUX_CLUSTER
+	t0 = chrono::steady_clock::now();
+	pid_t pid = fork();
+	if (pid == 0) {
+		int fd = open(logname.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if (fd >= 0) { dup2(fd, 1); dup2(fd, 2); close(fd); }
+		execl(exe.c_str(), exe.c_str(), dir.c_str(), (char*)0);
+		_exit(127);
+	}
+	if (pid > 0) {
+		int wstatus;
+		struct rusage ru;
+		if (wait4(pid, &wstatus, 0, &ru) == pid) {
+			maxrss = ru.ru_maxrss;
+			status = WIFEXITED(wstatus) ? WEXITSTATUS(wstatus) : -1;
+		}
+	}
+#else
+	t0 = chrono::steady_clock::now();
+	string cmd = "\"\"" + exe + "\" \"" + dir + "\" > \"" + logname + "\" 2>&1\"";
+	status = system(cmd.c_str());
+#endif
+	secs = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+	return status;
+}
+
+static int run(const string root, const string exe) {
+	ifstream list((root + "Scenarios.txt").c_str());
+	if (!list.is_open()) {
+		cout << "*** Unable to open " << root << "Scenarios.txt" << endl;
+		return 1;
+	}
+	string rname = root + "Scenarios_results.txt";
+	ofstream res(rname.c_str());
+	res << "Scenario\tCells\tStatus\tWallTime\tModelTime\tPeakRSS_MB\tIndYears\tIndSteps"
+		<< "\tIndYearsPerSec\tIndStepsPerSec" << endl;
+	string name;
+	long long cells;
+	int nfailed = 0;
+	while (list >> name >> cells) {
+		string dir = root + name + "/";
+		string out = dir + "Outputs/Batch1_Sim1_Land1_";
+		remove((out + "Range.txt").c_str());
+		remove((out + "Profile.txt").c_str());
+		cout << name << " ..." << flush;
+		double secs;
+		long maxrss;
+		int status = runScenario(exe, dir, secs, maxrss);
+
+		// individual-years from the range file, and model time and individual-steps
+		// (movement steps, or kernel moves) from the profile
+		vector <double> range, prof;
+		bool ok = status == 0
+			&& sumColumns(out + "Range.txt", vector <string>{ "NInds" }, range)
+			&& sumColumns(out + "Profile.txt",
+				vector <string>{ "Time", "MoveSteps", "KernelDraws" }, prof);
+		res << name << "\t" << cells;
+		if (ok) {
+			double steps = prof[1] + prof[2];
+			double modeltime = prof[0] > 0.0 ? prof[0] : secs;
+			res << "\tok\t" << secs << "\t" << modeltime << "\t" << maxrss / 1024.0
+				<< "\t" << range[0] << "\t" << steps
+				<< "\t" << range[0] / modeltime << "\t" << steps / modeltime << endl;
+			cout << " " << secs << " s" << endl;
+		}
+		else {
+			// e.g. refused by the pre-flight estimate as too large for this node
+			res << "\tnot_run\t" << secs << "\t-9\t" << (maxrss < 0 ? -9 : maxrss / 1024.0)
+				<< "\t-9\t-9\t-9\t-9" << endl;
+			cout << " not run - see " << dir << "Outputs/Run_log.txt" << endl;
+			nfailed++;
+		}
+	}
+	cout << "Results written to " << rname << endl;
+	return nfailed > 0 ? 2 : 0;
+}
+
+//---------------------------------------------------------------------------
+
+static void usage(void) {
+	cout << "Usage: RangeShifter_scenarios generate folder [-sizes 4,5,6] [-models cell,patch]"
+		<< " [-transfer kernel,sms,crw] [-genetics 0,1] [-reps 1] [-years 10]" << endl
+		<< "       RangeShifter_scenarios run folder RangeShifter_executable" << endl;
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 3) { usage(); return 1; }
+	string mode = argv[1];
+	string root = argv[2];
+	if (root.back() != '/' && root.back() != '\\') root += "/";
+
+	if (mode == "run") {
+		if (argc != 4) { usage(); return 1; }
+		return run(root, argv[3]);
+	}
+	if (mode != "generate") { usage(); return 1; }
+
+	vector <string> sizes = splitList("4,5,6");
+	vector <string> models = splitList("cell,patch");
+	vector <string> transfers = splitList("kernel,sms,crw");
+	vector <string> genetics = splitList("0,1");
+	int reps = 1, years = 10;
+	for (int i = 3; i < argc; i++) {
+		string arg = argv[i];
+		if (i + 1 >= argc) { usage(); return 1; }
+		if (arg == "-sizes") sizes = splitList(argv[++i]);
+		else if (arg == "-models") models = splitList(argv[++i]);
+		else if (arg == "-transfer") transfers = splitList(argv[++i]);
+		else if (arg == "-genetics") genetics = splitList(argv[++i]);
+		else if (arg == "-reps") reps = atoi(argv[++i]);
+		else if (arg == "-years") years = atoi(argv[++i]);
+		else { usage(); return 1; }
+	}
+	if (reps < 1 || years < 1) { usage(); return 1; }
+
+	pRandom = new RSrandom();
+	int result = generate(root, sizes, models, transfers, genetics, reps, years);
+	delete pRandom;
+	return result;
+}